@@ -0,0 +1,121 @@
+#pragma once
+
+// Minimal microbenchmark harness: iteration counts are calibrated so each sample runs for at least
+// minSampleMs, and the median of several samples is reported to filter out scheduling noise.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "json_writer.h"
+
+namespace Bench {
+
+// Keeps the compiler from discarding a computed value
+template <typename T> inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Options {
+    std::string filter; // Only run benchmarks whose name contains this
+    uint32_t samples = 7;
+    double minSampleMs = 20.0;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0; // Per sample
+    uint32_t samples = 0;
+    double nsPerOpMedian = 0.0;
+    double nsPerOpMin = 0.0;
+    double nsPerOpMax = 0.0;
+    double itemsPerOp = 1.0;
+};
+
+class Harness {
+  public:
+    explicit Harness(const Options& options) : options_(options) {
+    }
+
+    bool isSelected(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    // Runs fn() repeatedly; itemsPerOp is used for throughput (e.g. vertices per call)
+    template <typename F> void run(const std::string& name, F&& fn, double itemsPerOp = 1.0) {
+        if (!isSelected(name)) {
+            return;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto timeIterations = [&fn](uint64_t iterations) {
+            const auto start = Clock::now();
+            for (uint64_t i = 0; i < iterations; i++) {
+                fn();
+            }
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        };
+
+        // Warm up and calibrate
+        uint64_t iterations = 1;
+        double elapsedNs = timeIterations(iterations);
+        while (elapsedNs < options_.minSampleMs * 1.0e6 && iterations < (1ull << 40)) {
+            iterations *= 2;
+            elapsedNs = timeIterations(iterations);
+        }
+
+        std::vector<double> nsPerOp;
+        for (uint32_t sample = 0; sample < options_.samples; sample++) {
+            nsPerOp.push_back(timeIterations(iterations) / static_cast<double>(iterations));
+        }
+        std::sort(nsPerOp.begin(), nsPerOp.end());
+
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        result.samples = options_.samples;
+        result.nsPerOpMedian = nsPerOp[nsPerOp.size() / 2];
+        result.nsPerOpMin = nsPerOp.front();
+        result.nsPerOpMax = nsPerOp.back();
+        result.itemsPerOp = itemsPerOp;
+        results_.push_back(result);
+
+        std::printf("%-40s %14.1f ns/op %12llu iterations\n", name.c_str(), result.nsPerOpMedian,
+                    static_cast<unsigned long long>(iterations));
+        std::fflush(stdout);
+    }
+
+    const std::vector<Result>& getResults() const {
+        return results_;
+    }
+
+    void writeJson(JsonWriter& json) const {
+        json.key("results").beginArray();
+        for (const auto& result : results_) {
+            json.beginObject();
+            json.field("name", result.name);
+            json.field("iterations", result.iterations);
+            json.field("samples", result.samples);
+            json.field("nsPerOpMedian", result.nsPerOpMedian);
+            json.field("nsPerOpMin", result.nsPerOpMin);
+            json.field("nsPerOpMax", result.nsPerOpMax);
+            json.field("itemsPerSecond", result.itemsPerOp * 1.0e9 / std::max(result.nsPerOpMedian, 1e-9));
+            json.endObject();
+        }
+        json.endArray();
+    }
+
+  private:
+    Options options_;
+    std::vector<Result> results_;
+};
+
+} // namespace Bench
@@ -0,0 +1,361 @@
+// Microbenchmarks for the CPU hot paths of Test-LLGL.
+// Results are printed as a table and written as JSON (--output) so runs can be compared across builds.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+#include <LLGL/Utils/VertexFormat.h>
+
+#include <assimp/mesh.h>
+
+#include "imgui.h"
+
+#include "bench_harness.h"
+#include "imgui_impl_llgl.h"
+#include "json_writer.h"
+#include "math_types.h"
+#include "model_loader.h"
+#include "occlusion_culler.h"
+#include "primitives.h"
+#include "shader_compiler.h"
+#include "shader_translation.h"
+#include "stress_scene.h"
+
+#ifndef TEST_LLGL_SHADER_DIR
+#define TEST_LLGL_SHADER_DIR "shader"
+#endif
+
+// Used by shader_translation.cpp
+LLGL::RenderSystemPtr llgl_renderer;
+
+// The one loader internal the benchmarks reach into; friend of Model
+struct ModelBenchAccess {
+    static Mesh processMesh(Model& model, aiMesh* mesh) {
+        return model.processMesh(mesh, nullptr);
+    }
+};
+
+namespace {
+
+struct BenchArgs {
+    Bench::Options harness;
+    std::string outputPath = "microbench.json";
+};
+
+bool parseArgs(int argc, char* argv[], BenchArgs& args) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--filter") == 0 && next) {
+            args.harness.filter = argv[++i];
+        } else if (std::strcmp(arg, "--output") == 0 && next) {
+            args.outputPath = argv[++i];
+        } else if (std::strcmp(arg, "--samples") == 0 && next) {
+            args.harness.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--min-time-ms") == 0 && next) {
+            args.harness.minSampleMs = std::atof(argv[++i]);
+        } else {
+            std::printf("Usage: %s [--filter <substring>] [--output <file.json>] [--samples <N>] "
+                        "[--min-time-ms <ms>]\n",
+                        argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Assimp mesh shaped like a tessellated grid, as produced by the importer
+void fillSyntheticMesh(aiMesh& mesh, uint32_t gridSize) {
+    const uint32_t vertexCount = (gridSize + 1) * (gridSize + 1);
+    mesh.mNumVertices = vertexCount;
+    mesh.mVertices = new aiVector3D[vertexCount];
+    mesh.mNormals = new aiVector3D[vertexCount];
+    mesh.mTextureCoords[0] = new aiVector3D[vertexCount];
+    mesh.mNumUVComponents[0] = 2;
+
+    for (uint32_t y = 0; y <= gridSize; y++) {
+        for (uint32_t x = 0; x <= gridSize; x++) {
+            const uint32_t i = y * (gridSize + 1) + x;
+            const float u = static_cast<float>(x) / static_cast<float>(gridSize);
+            const float v = static_cast<float>(y) / static_cast<float>(gridSize);
+            mesh.mVertices[i] = aiVector3D(u - 0.5f, std::sin(u * 6.0f) * 0.1f, v - 0.5f);
+            mesh.mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+            mesh.mTextureCoords[0][i] = aiVector3D(u, v, 0.0f);
+        }
+    }
+
+    mesh.mNumFaces = gridSize * gridSize * 2;
+    mesh.mFaces = new aiFace[mesh.mNumFaces];
+    uint32_t face = 0;
+    for (uint32_t y = 0; y < gridSize; y++) {
+        for (uint32_t x = 0; x < gridSize; x++) {
+            const uint32_t i = y * (gridSize + 1) + x;
+            const uint32_t below = i + gridSize + 1;
+            const uint32_t quad[2][3] = { { i, below, i + 1 }, { i + 1, below, below + 1 } };
+            for (const auto& triangle : quad) {
+                aiFace& f = mesh.mFaces[face++];
+                f.mNumIndices = 3;
+                f.mIndices = new unsigned int[3]{ triangle[0], triangle[1], triangle[2] };
+            }
+        }
+    }
+}
+
+void benchMath(Bench::Harness& harness) {
+    Math::Mat4 a = Math::Mat4::rotateY(0.3f) * Math::Mat4::translate({ 1.0f, 2.0f, 3.0f });
+    Math::Mat4 b = Math::Mat4::rotateX(0.2f);
+    harness.run("math/mat4_multiply", [&]() {
+        a = a * b;
+        Bench::doNotOptimize(a);
+    });
+
+    float angle = 0.0f;
+    harness.run("math/look_at", [&]() {
+        angle += 0.001f;
+        Math::Mat4 view = Math::Mat4::lookAt({ std::sin(angle) * 5.0f, 1.0f, std::cos(angle) * 5.0f },
+                                             { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+        Bench::doNotOptimize(view);
+    });
+
+    float aspect = 1.0f;
+    harness.run("math/perspective", [&]() {
+        aspect += 1e-6f;
+        Math::Mat4 projection = Math::Mat4::perspective(3.14159f / 4.0f, aspect, 0.1f, 1000.0f);
+        Bench::doNotOptimize(projection);
+    });
+}
+
+void benchModel(Bench::Harness& harness) {
+    for (uint32_t gridSize : { 16u, 256u }) {
+        aiMesh mesh;
+        fillSyntheticMesh(mesh, gridSize);
+        Model model;
+        harness.run(
+            "model/process_mesh_" + std::to_string(mesh.mNumVertices) + "v",
+            [&]() {
+                Mesh result = ModelBenchAccess::processMesh(model, &mesh);
+                Bench::doNotOptimize(result);
+            },
+            mesh.mNumVertices);
+    }
+
+    Model model;
+    model.getMeshes().push_back(Primitives::createSphere(1.0f, 256, 128));
+    model.getMeshes().push_back(Primitives::createCube(2.0f));
+    size_t vertexCount = 0;
+    for (const auto& mesh : model.getMeshes()) {
+        vertexCount += mesh.vertices.size();
+    }
+    harness.run(
+        "model/calculate_bounds_" + std::to_string(vertexCount) + "v",
+        [&]() {
+            model.calculateBounds();
+            Bench::doNotOptimize(model.getBounds());
+        },
+        static_cast<double>(vertexCount));
+}
+
+void benchPrimitives(Bench::Harness& harness) {
+    harness.run("primitives/cube", []() {
+        Mesh mesh = Primitives::createCube();
+        Bench::doNotOptimize(mesh);
+    });
+    harness.run("primitives/sphere_32x16", []() {
+        Mesh mesh = Primitives::createSphere();
+        Bench::doNotOptimize(mesh);
+    });
+    harness.run("primitives/sphere_256x128", []() {
+        Mesh mesh = Primitives::createSphere(0.5f, 256, 128);
+        Bench::doNotOptimize(mesh);
+    });
+    harness.run("primitives/plane_64", []() {
+        Mesh mesh = Primitives::createPlane(1.0f, 1.0f, 64);
+        Bench::doNotOptimize(mesh);
+    });
+    harness.run("primitives/cylinder_64", []() {
+        Mesh mesh = Primitives::createCylinder(0.5f, 1.0f, 64);
+        Bench::doNotOptimize(mesh);
+    });
+    harness.run("primitives/cone_64", []() {
+        Mesh mesh = Primitives::createCone(0.5f, 1.0f, 64);
+        Bench::doNotOptimize(mesh);
+    });
+    harness.run("primitives/default_model", []() {
+        Model model = Primitives::createDefaultModel();
+        Bench::doNotOptimize(model);
+    });
+}
+
+void benchShaderTranslation(Bench::Harness& harness) {
+    if (!llgl_renderer) {
+        std::printf("Skipping shader benchmarks: no LLGL renderer\n");
+        return;
+    }
+
+    const std::string vertSource = readFile(std::string(TEST_LLGL_SHADER_DIR) + "/model.vert");
+    const std::string fragSource = readFile(std::string(TEST_LLGL_SHADER_DIR) + "/model.frag");
+    if (vertSource.empty() || fragSource.empty()) {
+        std::printf("Skipping shader benchmarks: model shaders not found in %s\n", TEST_LLGL_SHADER_DIR);
+        return;
+    }
+
+    // Renderers report the language family next to its versions, shipped_shader_targets() lists both
+    for (const auto& target : shipped_shader_targets()) {
+        harness.run("shader/translate_model_" + target.name, [&]() {
+            LLGL::ShaderDescriptor vertDesc, fragDesc;
+            LLGL::VertexFormat vertexFormat = createModelVertexFormat();
+            std::variant<std::string, std::vector<uint32_t>> vertShader, fragShader;
+            generate_shader_from_string(vertDesc, fragDesc, target.languages, vertexFormat, vertSource, fragSource,
+                                        vertShader, fragShader);
+            Bench::doNotOptimize(vertShader);
+            Bench::doNotOptimize(fragShader);
+        });
+    }
+
+    // glslang alone, per optimization level (the optimized levels generate the module twice, see ShaderCompiler)
+    for (SpirvOptimization level :
+         { SpirvOptimization::None, SpirvOptimization::Size, SpirvOptimization::Performance }) {
+        harness.run(std::string("shader/spirv_model_frag_") + spirv_optimization_name(level), [&]() {
+            std::vector<uint32_t> spirv =
+                ShaderCompiler::instance().compileToSpirv(EShLangFragment, fragSource, "", level);
+            Bench::doNotOptimize(spirv);
+        });
+    }
+
+    // All of the above at once: one SPIR-V compile, then every stage and target in parallel
+    const LLGL::VertexFormat modelFormat = createModelVertexFormat();
+    harness.run("shader/translate_model_all_targets", [&]() {
+        ShaderTranslationReport report =
+            translate_shader_targets(shipped_shader_targets(), modelFormat, vertSource, fragSource);
+        Bench::doNotOptimize(report);
+    });
+}
+
+void benchImGuiGather(Bench::Harness& harness) {
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    // A busy but representative UI: the demo window plus a long text-heavy window
+    ImGui::NewFrame();
+    ImGui::SetNextWindowSize(ImVec2(600.0f, 900.0f));
+    ImGui::ShowDemoWindow();
+    ImGui::SetNextWindowPos(ImVec2(700.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(800.0f, 1000.0f));
+    ImGui::Begin("Stress");
+    for (int i = 0; i < 400; i++) {
+        ImGui::Text("Line %d: the quick brown fox jumps over the lazy dog", i);
+    }
+    ImGui::End();
+    ImGui::Render();
+
+    const ImDrawData* drawData = ImGui::GetDrawData();
+    std::vector<ImDrawVert> vertices(drawData->TotalVtxCount);
+    std::vector<ImDrawIdx> indices(drawData->TotalIdxCount);
+    harness.run(
+        "imgui/gather_" + std::to_string(drawData->TotalVtxCount) + "v",
+        [&]() {
+            ImGui_ImplLLGL_GatherDrawData(drawData, vertices.data(), indices.data());
+            Bench::doNotOptimize(vertices.data());
+        },
+        drawData->TotalVtxCount);
+
+    ImGui::DestroyContext();
+}
+
+void benchCulling(Bench::Harness& harness) {
+    // CPU side of a stress scene only, no buffers are created
+    StressSceneDesc desc;
+    desc.objectCount = 100000;
+    desc.layout = StressLayout::City;
+    StressScene scene;
+    scene.generate(desc);
+
+    const Math::AABB& bounds = scene.getBounds();
+    const Math::Vec3 eye = bounds.center() + Math::Vec3(0.3f, 0.25f, 1.0f).normalized() * bounds.radius() * 1.2f;
+    const Math::Mat4 viewProjection = Math::Mat4::perspective(3.14159f / 4.0f, 16.0f / 9.0f, 0.1f, 1000.0f) *
+                                      Math::Mat4::lookAt(eye, bounds.center(), { 0.0f, 1.0f, 0.0f });
+
+    std::vector<uint32_t> visibleObjects;
+    for (size_t threadCount : { size_t(1), size_t(0) }) {
+        OcclusionCuller culler;
+        culler.init(OcclusionCuller::DEFAULT_WIDTH, OcclusionCuller::DEFAULT_HEIGHT, threadCount);
+        harness.run(
+            threadCount == 1 ? "cull/city_100k_1_thread" : "cull/city_100k_all_threads",
+            [&]() {
+                CullStats stats = culler.cull(scene, viewProjection, eye, visibleObjects);
+                Bench::doNotOptimize(stats);
+            },
+            desc.objectCount);
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (!parseArgs(argc, argv, args)) {
+        return 1;
+    }
+
+    // The shader translator queries rendering caps; Null is enough for that
+    llgl_renderer = LLGL::RenderSystem::Load("Null");
+
+    Bench::Harness harness(args.harness);
+    benchMath(harness);
+    benchModel(harness);
+    benchPrimitives(harness);
+    benchShaderTranslation(harness);
+    benchImGuiGather(harness);
+    benchCulling(harness);
+
+    JsonWriter json;
+    json.beginObject();
+    json.field("suite", "Test-LLGL-Bench");
+#if defined(__clang__)
+    json.field("compiler", "clang " __clang_version__);
+#elif defined(__GNUC__)
+    json.field("compiler", "gcc " __VERSION__);
+#elif defined(_MSC_VER)
+    json.field("compiler", "msvc " + std::to_string(_MSC_VER));
+#endif
+#ifdef NDEBUG
+    json.field("optimized", true);
+#else
+    json.field("optimized", false);
+#endif
+    json.field("samples", args.harness.samples);
+    json.field("minSampleMs", args.harness.minSampleMs);
+    harness.writeJson(json);
+    json.endObject();
+
+    if (llgl_renderer) {
+        LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+    }
+
+    if (!json.writeToFile(args.outputPath)) {
+        std::fprintf(stderr, "Failed to write %s\n", args.outputPath.c_str());
+        return 1;
+    }
+    std::printf("Wrote %zu results to %s\n", harness.getResults().size(), args.outputPath.c_str());
+    return 0;
+}
@@ -0,0 +1,6 @@
+// GLSL shader version 4.50 (for Vulkan)
+#version 450 core
+
+// Depth-only pass: color writes are masked off, the rasterizer writes depth
+void main() {
+}
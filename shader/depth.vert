@@ -0,0 +1,24 @@
+// GLSL shader version 4.50 (for Vulkan)
+#version 450 core
+
+// Position-only stream of the depth pre-pass
+layout(location = 0) in vec3 position;
+
+// Uniform buffer for transformation matrices
+layout(std140, binding = 0) uniform Matrices {
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+};
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+// Same expression and invariance as model.vert, so the main pass passes LessEqual exactly
+invariant gl_Position;
+
+void main() {
+    vec4 worldPos = model * vec4(position, 1.0);
+    gl_Position = projection * view * worldPos;
+}
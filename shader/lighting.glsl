@@ -0,0 +1,8 @@
+// Shared directional light, included by the lit fragment shaders
+const vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
+const vec3 lightColor = vec3(1.0, 1.0, 1.0);
+
+// Lambert term of the light for an interpolated normal
+float diffuseTerm(vec3 normal) {
+    return max(dot(normalize(normal), lightDir), 0.0);
+}
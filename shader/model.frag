@@ -1,8 +1,13 @@
 // GLSL shader version 4.50 (for Vulkan)
 #version 450 core
 
+// Permutation defines (see shader_variants.h):
+//   HAS_TEXTURE - modulate the lighting with the diffuse texture instead of a constant base color
+
+#ifdef HAS_TEXTURE
 layout(binding = 1) uniform texture2D colorMap;
 layout(binding = 2) uniform sampler samplerState;
+#endif
 
 // Fragment input from the vertex shader
 layout(location = 0) in vec3 fragNormal;
@@ -13,21 +18,29 @@ layout(location = 2) in vec3 fragPosition;
 layout(location = 0) out vec4 outColor;
 
 // Simple directional light
-const vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
-const vec3 lightColor = vec3(1.0, 1.0, 1.0);
+#include "lighting.glsl"
+
+#ifdef HAS_TEXTURE
 const vec3 ambientColor = vec3(0.2, 0.2, 0.2);
+#else
+const vec3 ambientColor = vec3(0.3, 0.3, 0.3);
+const vec3 baseColor = vec3(0.8, 0.8, 0.8);
+#endif
 
 void main() {
-    vec3 normal = normalize(fragNormal);
-
     // Diffuse lighting
-    float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
+    vec3 diffuse = diffuseTerm(fragNormal) * lightColor;
 
+#ifdef HAS_TEXTURE
     // Sample texture
     vec4 texColor = texture(sampler2D(colorMap, samplerState), fragTexCoord);
 
     // Combine lighting with texture
     vec3 result = (ambientColor + diffuse) * texColor.rgb;
     outColor = vec4(result, texColor.a);
+#else
+    // Combine lighting with base color
+    vec3 result = (ambientColor + diffuse) * baseColor;
+    outColor = vec4(result, 1.0);
+#endif
 }
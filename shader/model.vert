@@ -22,6 +22,9 @@ out gl_PerVertex {
     vec4 gl_Position;
 };
 
+// Must match depth.vert bit for bit for the depth pre-pass
+invariant gl_Position;
+
 // Vertex shader main function
 void main() {
     vec4 worldPos = model * vec4(position, 1.0);
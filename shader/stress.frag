@@ -0,0 +1,25 @@
+// GLSL shader version 4.50 (for Vulkan)
+#version 450 core
+
+layout(binding = 1) uniform texture2D colorMap;
+layout(binding = 2) uniform sampler samplerState;
+
+// Fragment input from the vertex shader
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) in vec4 fragColor;
+
+// Fragment output color
+layout(location = 0) out vec4 outColor;
+
+// Simple directional light
+#include "lighting.glsl"
+
+const vec3 ambientColor = vec3(0.25, 0.25, 0.25);
+
+void main() {
+    float diff = diffuseTerm(fragNormal);
+
+    vec4 texColor = texture(sampler2D(colorMap, samplerState), fragTexCoord);
+    outColor = vec4((ambientColor + diff) * texColor.rgb * fragColor.rgb, 1.0);
+}
@@ -0,0 +1,45 @@
+// GLSL shader version 4.50 (for Vulkan)
+#version 450 core
+
+// Vertex attributes (slot 0)
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoord;
+
+// Per-instance attributes (slot 1): model matrix columns and tint color
+layout(location = 3) in vec4 instanceModel0;
+layout(location = 4) in vec4 instanceModel1;
+layout(location = 5) in vec4 instanceModel2;
+layout(location = 6) in vec4 instanceModel3;
+layout(location = 7) in vec4 instanceColor;
+
+// Uniform buffer for transformation matrices (model is unused, objects come from the instance stream)
+layout(std140, binding = 0) uniform Matrices {
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+};
+
+// Vertex output to the fragment shader
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec4 fragColor;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    mat4 instanceModel = mat4(instanceModel0, instanceModel1, instanceModel2, instanceModel3);
+    vec4 worldPos = instanceModel * vec4(position, 1.0);
+    gl_Position = projection * view * worldPos;
+
+    // The City layout scales non-uniformly, which skews normals under the plain upper 3x3. Its cofactor
+    // matrix is the inverse transpose times the determinant, so it gives the right direction (renormalized
+    // by the fragment shader) without inverting a matrix per vertex.
+    mat3 linear = mat3(instanceModel);
+    mat3 normalMatrix = mat3(cross(linear[1], linear[2]), cross(linear[2], linear[0]), cross(linear[0], linear[1]));
+    fragNormal = normalMatrix * normal;
+    fragTexCoord = texCoord;
+    fragColor = instanceColor;
+}
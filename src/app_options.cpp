@@ -0,0 +1,275 @@
+#include "app_options.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <LLGL/LLGL.h>
+
+#include "logger.h"
+#include "shader_compiler.h"
+
+namespace {
+
+bool parseUInt(const char* text, uint32_t& value) {
+    char* end = nullptr;
+    unsigned long parsed = std::strtoul(text, &end, 10);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    value = static_cast<uint32_t>(parsed);
+    return true;
+}
+
+bool parseResolution(const char* text, uint32_t& width, uint32_t& height) {
+    unsigned int w = 0, h = 0;
+    if (std::sscanf(text, "%ux%u", &w, &h) != 2 || w == 0 || h == 0) {
+        return false;
+    }
+    width = w;
+    height = h;
+    return true;
+}
+
+// Comma-separated counts with optional k/m suffixes, e.g. "1k,10k,1m"
+bool parseCountList(const char* text, std::vector<uint32_t>& counts) {
+    counts.clear();
+    const char* cursor = text;
+    while (*cursor != '\0') {
+        char* end = nullptr;
+        unsigned long value = std::strtoul(cursor, &end, 10);
+        if (end == cursor) {
+            return false;
+        }
+        if (*end == 'k' || *end == 'K') {
+            value *= 1000;
+            end++;
+        } else if (*end == 'm' || *end == 'M') {
+            value *= 1000000;
+            end++;
+        }
+        if (value == 0 || (*end != ',' && *end != '\0')) {
+            return false;
+        }
+        counts.push_back(static_cast<uint32_t>(value));
+        cursor = (*end == ',') ? end + 1 : end;
+    }
+    return !counts.empty();
+}
+
+} // anonymous namespace
+
+bool parse_app_options(int argc, char* argv[], AppOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        auto requireValue = [&](const char* name) {
+            if (next == nullptr) {
+                LLGL::Log::Errorf("Missing value for %s\n", name);
+                return false;
+            }
+            i++;
+            return true;
+        };
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            return false;
+        } else if (std::strcmp(arg, "--headless") == 0) {
+            options.headless = true;
+        } else if (std::strcmp(arg, "--readback") == 0) {
+            options.readbackEveryFrame = true;
+        } else if (std::strcmp(arg, "--depth-prepass") == 0) {
+            options.depthPrepass = true;
+        } else if (std::strcmp(arg, "--renderer") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.rendererModule = next;
+        } else if (std::strcmp(arg, "--size") == 0) {
+            if (!requireValue(arg) || !parseResolution(next, options.width, options.height)) {
+                LLGL::Log::Errorf("Invalid resolution, expected <width>x<height>\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--frames") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.frameCount) || options.frameCount == 0) {
+                LLGL::Log::Errorf("Invalid frame count\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--output") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.outputPath = next;
+        } else if (std::strcmp(arg, "--batch") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.batchInput = next;
+            options.headless = true;
+        } else if (std::strcmp(arg, "--output-dir") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.outputDir = next;
+        } else if (std::strcmp(arg, "--views") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.viewCount) || options.viewCount == 0) {
+                LLGL::Log::Errorf("Invalid view count\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--jobs") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.jobCount)) {
+                LLGL::Log::Errorf("Invalid job count\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--benchmark") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.benchmarkPath = next;
+            options.headless = true;
+        } else if (std::strcmp(arg, "--report") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.reportPath = next;
+        } else if (std::strcmp(arg, "--warmup") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.warmupFrames)) {
+                LLGL::Log::Errorf("Invalid warm-up frame count\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--record-path") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.recordPath = next;
+        } else if (std::strcmp(arg, "--stress") == 0) {
+            if (!requireValue(arg) || !parseCountList(next, options.stressCounts)) {
+                LLGL::Log::Errorf("Invalid object counts, expected e.g. 1k,10k,100k\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--stress-variety") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.stressVariety) || options.stressVariety == 0) {
+                LLGL::Log::Errorf("Invalid mesh variety\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--stress-materials") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.stressMaterials) || options.stressMaterials == 0) {
+                LLGL::Log::Errorf("Invalid material count\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--stress-layout") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.stressLayout = next;
+        } else if (std::strcmp(arg, "--stress-seed") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.stressSeed)) {
+                LLGL::Log::Errorf("Invalid seed\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--stress-submit") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.stressSubmit = next;
+        } else if (std::strcmp(arg, "--stress-cull") == 0) {
+            options.stressCulling = true;
+        } else if (std::strcmp(arg, "--cache-dir") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.cacheDir = next;
+        } else if (std::strcmp(arg, "--no-pipeline-cache") == 0) {
+            options.pipelineCache = false;
+        } else if (std::strcmp(arg, "--no-shader-cache") == 0) {
+            options.shaderCache = false;
+        } else if (std::strcmp(arg, "--sync-pipelines") == 0) {
+            options.asyncPipelines = false;
+        } else if (std::strcmp(arg, "--spirv-opt") == 0) {
+            SpirvOptimization level = SpirvOptimization::None;
+            if (!requireValue(arg) || !parse_spirv_optimization(next, level)) {
+                LLGL::Log::Errorf("Invalid SPIR-V optimization, expected none, size or performance\n");
+                return false;
+            }
+            options.spirvOptimization = next;
+        } else if (std::strcmp(arg, "--precompile-shaders") == 0) {
+            options.precompileShaders = true;
+        } else if (std::strcmp(arg, "--no-shader-reload") == 0) {
+            options.shaderHotReload = false;
+        } else if (std::strcmp(arg, "--log") == 0) {
+            LogFilter filter;
+            if (!requireValue(arg) || !parse_log_filter(next, filter)) {
+                LLGL::Log::Errorf("Invalid log filter, expected e.g. warning,shader=debug,model=off\n");
+                return false;
+            }
+            options.logFilter = next;
+        } else if (std::strcmp(arg, "--dump-shaders") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.shaderDumpDir = next;
+        } else if (std::strcmp(arg, "--trace") == 0) {
+            if (!requireValue(arg)) {
+                return false;
+            }
+            options.tracePath = next;
+        } else if (std::strcmp(arg, "--trace-frames") == 0) {
+            if (!requireValue(arg) || !parseUInt(next, options.traceFrames)) {
+                LLGL::Log::Errorf("Invalid trace frame count\n");
+                return false;
+            }
+        } else if (arg[0] == '-' && arg[1] == '-') {
+            LLGL::Log::Errorf("Unknown option: %s\n", arg);
+            return false;
+        } else {
+            options.modelPath = arg;
+        }
+    }
+    return true;
+}
+
+void print_app_usage(const char* executable) {
+    LLGL::Log::Printf("Usage: %s [options] [model_path]\n"
+                      "  --headless            Render offscreen without creating a window\n"
+                      "  --renderer <module>   LLGL module to load (OpenGL, Vulkan, Null, ...)\n"
+                      "                        Headless mode defaults to Null\n"
+                      "  --size <W>x<H>        Framebuffer resolution (default 800x600)\n"
+                      "  --frames <N>          Number of headless frames to render (default 1)\n"
+                      "  --output <file.png>   Write the last headless frame to a PNG file\n"
+                      "  --readback            Read every headless frame back to system memory\n"
+                      "  --depth-prepass       Lay down depth from position-only streams before shading\n"
+                      "  --batch <dir|list>    Render thumbnails for a directory or list file of models\n"
+                      "  --output-dir <dir>    Thumbnail and manifest directory (default thumbnails)\n"
+                      "  --views <N>           Thumbnails per model, evenly spaced around it (default 1)\n"
+                      "  --jobs <N>            Model loading threads (default: hardware threads)\n"
+                      "  --benchmark <file>    Replay a camera path file offscreen, or \"orbit\" for a full turn\n"
+                      "                        --frames overrides the path length\n"
+                      "  --report <file.json>  Benchmark/stress/precompile report (default benchmark.json, ...)\n"
+                      "  --warmup <N>          Unmeasured benchmark frames before the replay (default 10)\n"
+                      "  --record-path <file>  Record the viewer camera into a path file for --benchmark\n"
+                      "  --stress <N[,N...]>   Synthetic scene of N objects (k/m suffixes allowed); with\n"
+                      "                        --headless, measures every count and writes a report\n"
+                      "  --stress-variety <N>  Distinct primitive meshes (default 4)\n"
+                      "  --stress-materials <N> Distinct material textures (default 8)\n"
+                      "  --stress-layout <grid|random|city> Object placement (default grid)\n"
+                      "  --stress-seed <N>     Generator seed (default 1)\n"
+                      "  --stress-submit <draws|instanced> One draw per object or per state run\n"
+                      "  --stress-cull         CPU occlusion culling of the stress scene (toggle in the viewer)\n"
+                      "  --cache-dir <dir>     Directory of the on-disk caches (default .cache)\n"
+                      "  --no-pipeline-cache   Don't load or save the pipeline cache\n"
+                      "  --no-shader-cache     Always run glslang and SPIRV-Cross, don't use the shader cache\n"
+                      "  --sync-pipelines      Viewer: create all pipelines before the first frame, no pre-warm\n"
+                      "  --spirv-opt <level>   SPIR-V optimization: none, size or performance (default: build\n"
+                      "                        setting); shaders can override it with a spirv-opt: comment\n"
+                      "  --precompile-shaders  Translate all shaders for every backend into the shader cache\n"
+                      "                        and report the latency per shader (default precompile.json)\n"
+                      "  --no-shader-reload    Viewer: don't watch shader/ for changes\n"
+                      "  --log <filter>        Log thresholds: a level (debug, info, warning, error, off) and/or\n"
+                      "                        <category>=<level> for app, render, model, shader, pipeline,\n"
+                      "                        cache, e.g. warning,shader=debug (default info)\n"
+                      "  --dump-shaders <dir>  Write every translated shader to <dir>; shader=debug logs them\n"
+                      "  --trace <file.json>   Write a Chrome trace of the CPU profiler on exit\n"
+                      "  --trace-frames <N>    Frames kept in the trace besides startup (default 120)\n",
+                      executable);
+}
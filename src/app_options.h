@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Command line options shared by the interactive viewer and the headless modes
+struct AppOptions {
+    std::string modelPath = "../model.obj";
+
+    // Headless rendering (no SDL window, no swap chain)
+    bool headless = false;
+    std::string rendererModule; // Empty: OpenGL for the viewer, Null when headless
+    uint32_t width = 800;
+    uint32_t height = 600;
+    uint32_t frameCount = 0; // 0: not set, each mode picks its default
+    std::string outputPath; // PNG file for the last headless frame
+    bool readbackEveryFrame = false;
+    bool depthPrepass = false; // Depth-only pass before shading (toggle in the viewer)
+
+    // Batch thumbnail rendering (implies headless)
+    std::string batchInput; // Directory of models or text file with one model path per line
+    std::string outputDir = "thumbnails";
+    uint32_t viewCount = 1;
+    uint32_t jobCount = 0; // Loader threads, 0 = hardware concurrency
+
+    // Camera-path replay benchmark (implies headless)
+    std::string benchmarkPath; // CameraPath file or "orbit"
+    std::string reportPath; // Empty: benchmark.json / stress.json
+    uint32_t warmupFrames = 10;
+    std::string recordPath; // Viewer: write the camera path of the session to this file
+
+    // Synthetic stress scene: headless runs measure every count, the viewer shows the first one
+    std::vector<uint32_t> stressCounts;
+    uint32_t stressVariety = 4;
+    uint32_t stressMaterials = 8;
+    std::string stressLayout = "grid"; // grid, random or city
+    uint32_t stressSeed = 1;
+    std::string stressSubmit = "draws"; // draws or instanced
+    bool stressCulling = false;         // CPU occlusion culling before recording draws
+
+    // On-disk caches
+    std::string cacheDir = ".cache";
+    bool pipelineCache = true;
+    bool shaderCache = true; // Translated shaders, keyed by a hash of everything that affects them
+    bool asyncPipelines = true; // Viewer: compile in the background and pre-warm from the last session
+    std::string spirvOptimization; // none, size or performance; empty: TEST_LLGL_SPIRV_OPTIMIZATION
+    bool precompileShaders = false; // Translate every shader for every backend into the shader cache, then exit
+    bool shaderHotReload = true; // Viewer: rebuild the affected pipelines when a file in shader/ changes
+
+    // Logging
+    std::string logFilter;     // Per-category thresholds, e.g. "warning,shader=debug"; empty: info everywhere
+    std::string shaderDumpDir; // Write every translated shader to this directory (off by default)
+
+    // CPU profiler trace (needs TEST_LLGL_ENABLE_PROFILER)
+    std::string tracePath;
+    uint32_t traceFrames = 120; // Frames kept in the trace besides startup, 0 = startup only
+};
+
+// Parses argv into options. Returns false if the arguments are invalid or help was requested.
+bool parse_app_options(int argc, char* argv[], AppOptions& options);
+void print_app_usage(const char* executable);
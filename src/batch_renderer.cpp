@@ -0,0 +1,310 @@
+#include "batch_renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+#include <assimp/Importer.hpp>
+
+#include "camera.h"
+#include "headless.h"
+#include "json_writer.h"
+#include "logger.h"
+#include "model_loader.h"
+#include "model_renderer.h"
+#include "offscreen_target.h"
+#include "pipeline_cache.h"
+#include "profiler.h"
+#include "shader_cache.h"
+#include "thread_pool.h"
+
+extern LLGL::RenderSystemPtr llgl_renderer;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Result of the CPU-side import done on a worker thread
+struct ImportedModel {
+    std::string path;
+    Model model;
+    bool loaded = false;
+    double importMs = 0.0;
+};
+
+struct ThumbnailImage {
+    std::string path;
+    std::future<bool> written;
+};
+
+struct BatchEntry {
+    std::string path;
+    bool loaded = false;
+    size_t meshCount = 0;
+    size_t vertexCount = 0;
+    size_t triangleCount = 0;
+    double importMs = 0.0;
+    double uploadMs = 0.0;
+    double renderMs = 0.0;
+    std::vector<ThumbnailImage> images;
+};
+
+std::vector<std::string> collectModelPaths(const std::string& input) {
+    std::vector<std::string> paths;
+    std::filesystem::path inputPath(input);
+
+    if (std::filesystem::is_directory(inputPath)) {
+        Assimp::Importer importer;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(inputPath)) {
+            if (entry.is_regular_file() && importer.IsExtensionSupported(entry.path().extension().string())) {
+                paths.push_back(entry.path().string());
+            }
+        }
+        // Directory iteration order is unspecified, keep the output reproducible
+        std::sort(paths.begin(), paths.end());
+    } else {
+        std::ifstream listFile(inputPath);
+        std::string line;
+        while (std::getline(listFile, line)) {
+            if (!line.empty() && line[0] != '#') {
+                paths.push_back(line);
+            }
+        }
+    }
+    return paths;
+}
+
+ImportedModel importModel(const std::string& path) {
+    PROFILE_SCOPE("importModel");
+    ImportedModel result;
+    result.path = path;
+
+    auto start = Clock::now();
+    result.loaded = result.model.import(path);
+    result.importMs = millisecondsSince(start);
+
+    return result;
+}
+
+void writeManifest(const std::string& path, const std::vector<BatchEntry>& entries, const AppOptions& options,
+                   double totalSeconds) {
+    const auto& info = llgl_renderer->GetRendererInfo();
+    size_t loadedCount = std::count_if(entries.begin(), entries.end(), [](const BatchEntry& e) { return e.loaded; });
+
+    JsonWriter json;
+    json.beginObject();
+    json.field("renderer", info.rendererName);
+    json.field("device", info.deviceName);
+    json.field("width", options.width);
+    json.field("height", options.height);
+    json.field("viewsPerModel", options.viewCount);
+    json.field("models", entries.size());
+    json.field("modelsLoaded", loadedCount);
+    json.field("totalSeconds", totalSeconds);
+    json.field("modelsPerSecond", totalSeconds > 0.0 ? entries.size() / totalSeconds : 0.0);
+
+    json.key("entries").beginArray();
+    for (const auto& entry : entries) {
+        json.beginObject();
+        json.field("path", entry.path);
+        json.field("loaded", entry.loaded);
+        json.field("meshes", entry.meshCount);
+        json.field("vertices", entry.vertexCount);
+        json.field("triangles", entry.triangleCount);
+        json.field("importMs", entry.importMs);
+        json.field("uploadMs", entry.uploadMs);
+        json.field("renderMs", entry.renderMs);
+        json.key("images").beginArray();
+        for (const auto& image : entry.images) {
+            json.value(image.path);
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+
+    if (!json.writeToFile(path)) {
+        log_error(LogCategory::App, "Failed to write manifest: %s\n", path.c_str());
+    }
+}
+
+} // anonymous namespace
+
+int run_batch(const AppOptions& options) {
+    std::vector<std::string> modelPaths = collectModelPaths(options.batchInput);
+    if (modelPaths.empty()) {
+        log_error(LogCategory::App, "No models found in %s\n", options.batchInput.c_str());
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+
+    llgl_renderer = load_headless_renderer(options.rendererModule);
+    if (!llgl_renderer) {
+        return 1;
+    }
+    if (options.pipelineCache) {
+        load_pipeline_cache(llgl_renderer, options.cacheDir);
+    }
+    if (options.shaderCache) {
+        init_shader_cache(options.cacheDir);
+    }
+
+    OffscreenTarget target;
+    if (!target.create(llgl_renderer, { options.width, options.height })) {
+        // Whatever create() got to before failing
+        target.release(llgl_renderer);
+        LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+        return 1;
+    }
+
+    // All models share the same vertex layout, so the pipelines are created once for the whole batch
+    ModelRenderer modelRenderer;
+    modelRenderer.init(llgl_renderer, target.getRenderPass(), createModelVertexFormat());
+
+    auto cmdBuffer = llgl_renderer->CreateCommandBuffer(LLGL::CommandBufferFlags::ImmediateSubmit);
+    const float aspect = static_cast<float>(options.width) / static_cast<float>(options.height);
+    const float fovY = 3.14159f / 4.0f;
+
+    ThreadPool pool(options.jobCount);
+    log_info(LogCategory::App, "Batch: %zu models, %zu loader threads\n", modelPaths.size(), pool.getThreadCount());
+
+    // Bound the number of decoded models waiting in memory
+    const size_t maxInFlight = pool.getThreadCount() + 2;
+    std::deque<std::future<ImportedModel>> pending;
+    size_t nextToSubmit = 0;
+
+    std::vector<BatchEntry> entries;
+    entries.reserve(modelPaths.size());
+    std::vector<uint8_t> pixels;
+
+    const auto batchStart = Clock::now();
+
+    for (size_t index = 0; index < modelPaths.size(); index++) {
+        // One trace frame per model
+        PROFILE_FRAME_MARK();
+
+        while (nextToSubmit < modelPaths.size() && pending.size() < maxInFlight) {
+            const std::string& path = modelPaths[nextToSubmit++];
+            pending.push_back(pool.submit([path]() { return importModel(path); }));
+        }
+
+        ImportedModel imported;
+        {
+            PROFILE_SCOPE("WaitForImport");
+            imported = pending.front().get();
+        }
+        pending.pop_front();
+
+        BatchEntry entry;
+        entry.path = imported.path;
+        entry.loaded = imported.loaded;
+        entry.importMs = imported.importMs;
+
+        if (!imported.loaded) {
+            entries.push_back(std::move(entry));
+            continue;
+        }
+
+        Model& model = imported.model;
+        for (const auto& mesh : model.getMeshes()) {
+            entry.vertexCount += mesh.vertices.size();
+            entry.triangleCount += mesh.indices.size() / 3;
+        }
+        entry.meshCount = model.getMeshes().size();
+
+        auto uploadStart = Clock::now();
+        model.createTextures(llgl_renderer);
+        model.createBuffers(llgl_renderer);
+        entry.uploadMs = millisecondsSince(uploadStart);
+        modelRenderer.prepare(llgl_renderer, model);
+
+        // Fit the whole bounding sphere into the vertical field of view
+        OrbitCamera camera;
+        const float radius = std::max(model.getRadius(), 1e-3f);
+        camera.setTarget(model.getCenter(), radius / std::sin(fovY * 0.5f) * 1.05f);
+        camera.setPitch(0.35f);
+
+        const std::string stem = std::filesystem::path(imported.path).stem().string();
+
+        auto renderStart = Clock::now();
+        for (uint32_t view = 0; view < options.viewCount; view++) {
+            camera.setYaw(2.0f * Math::PI * static_cast<float>(view) / static_cast<float>(options.viewCount));
+            modelRenderer.updateMatrices(llgl_renderer,
+                                         compute_model_matrices(camera, model.getCenter(), 0.0f, 0.0f, aspect));
+
+            cmdBuffer->Begin();
+            {
+                cmdBuffer->SetViewport(target.getResolution());
+                cmdBuffer->BeginRenderPass(*target.getRenderTarget());
+                {
+                    cmdBuffer->Clear(LLGL::ClearFlags::ColorDepth, LLGL::ClearValue{ 0.1f, 0.1f, 0.15f, 1.0f });
+                    modelRenderer.render(*cmdBuffer, model);
+                }
+                cmdBuffer->EndRenderPass();
+            }
+            cmdBuffer->End();
+
+            {
+                PROFILE_SCOPE("ReadPixels");
+                target.readPixels(llgl_renderer, pixels);
+            }
+
+            // PNG encoding is CPU work as well, hand it to the pool together with the pixels
+            char fileName[64];
+            std::snprintf(fileName, sizeof(fileName), "%04zu_v%u.png", index, view);
+            ThumbnailImage image;
+            image.path = (std::filesystem::path(options.outputDir) / (stem + "_" + fileName)).string();
+            LLGL::Extent2D resolution = target.getResolution();
+            image.written = pool.submit([path = image.path, resolution, imagePixels = std::move(pixels)]() {
+                PROFILE_SCOPE("WritePNG");
+                return OffscreenTarget::writePNG(path, resolution, imagePixels);
+            });
+            pixels = {};
+            entry.images.push_back(std::move(image));
+        }
+        entry.renderMs = millisecondsSince(renderStart);
+
+        model.release(llgl_renderer);
+        entries.push_back(std::move(entry));
+    }
+
+    // Wait for the remaining image writes
+    bool allWritten = true;
+    for (auto& entry : entries) {
+        for (auto& image : entry.images) {
+            allWritten = image.written.get() && allWritten;
+        }
+    }
+
+    const double totalSeconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+    log_info(LogCategory::App, "Batch finished: %zu models in %.3f s (%.2f models/s)\n", entries.size(), totalSeconds,
+             totalSeconds > 0.0 ? entries.size() / totalSeconds : 0.0);
+
+    writeManifest((std::filesystem::path(options.outputDir) / "manifest.json").string(), entries, options,
+                  totalSeconds);
+
+    // Cleanup
+    llgl_renderer->Release(*cmdBuffer);
+    modelRenderer.release(llgl_renderer);
+    target.release(llgl_renderer);
+    log_shader_cache_stats();
+    save_pipeline_cache(llgl_renderer);
+    LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+
+    return allWritten ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "app_options.h"
+
+// Renders framed thumbnails for every model of options.batchInput into options.outputDir.
+// Models are imported and decoded on worker threads while a single device renders,
+// and a manifest.json with per-model timings is written next to the images.
+int run_batch(const AppOptions& options);
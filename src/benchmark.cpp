@@ -0,0 +1,299 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+#include "camera.h"
+#include "camera_path.h"
+#include "gpu_timer.h"
+#include "headless.h"
+#include "json_writer.h"
+#include "logger.h"
+#include "model_loader.h"
+#include "model_renderer.h"
+#include "offscreen_target.h"
+#include "primitives.h"
+#include "pipeline_cache.h"
+#include "pipeline_registry.h"
+#include "profiler.h"
+#include "sample_stats.h"
+#include "shader_cache.h"
+
+extern LLGL::RenderSystemPtr llgl_renderer;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t DEFAULT_ORBIT_FRAMES = 600;
+
+double millisecondsBetween(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// CPU phases of a benchmark frame
+enum Phase { PHASE_UPDATE, PHASE_RECORD, PHASE_WAIT, PHASE_READBACK, PHASE_COUNT };
+constexpr std::array<const char*, PHASE_COUNT> PHASE_NAMES = { "update", "record", "wait", "readback" };
+
+} // anonymous namespace
+
+int run_benchmark(const AppOptions& options) {
+    llgl_renderer = load_headless_renderer(options.rendererModule);
+    if (!llgl_renderer) {
+        return 1;
+    }
+    if (options.pipelineCache) {
+        load_pipeline_cache(llgl_renderer, options.cacheDir);
+    }
+    if (options.shaderCache) {
+        init_shader_cache(options.cacheDir);
+    }
+
+    // Load 3D model
+    const auto loadStart = Clock::now();
+    Model model;
+    bool modelLoaded = model.load(options.modelPath, llgl_renderer);
+    if (!modelLoaded) {
+        log_error(LogCategory::App, "Failed to load model: %s\n", options.modelPath.c_str());
+        log_info(LogCategory::App, "Creating a default cube...\n");
+
+        model = Primitives::createDefaultModel();
+        model.calculateBounds();
+    }
+    model.createBuffers(llgl_renderer);
+    const double loadMs = millisecondsBetween(loadStart, Clock::now());
+
+    OffscreenTarget target;
+    if (!target.create(llgl_renderer, { options.width, options.height })) {
+        // Whatever create() got to before failing
+        target.release(llgl_renderer);
+        model.release(llgl_renderer);
+        LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+        return 1;
+    }
+
+    const auto initStart = Clock::now();
+    ModelRenderer modelRenderer;
+    modelRenderer.init(llgl_renderer, target.getRenderPass(), model.getVertexFormat());
+    modelRenderer.prepare(llgl_renderer, model);
+    modelRenderer.setDepthPrepass(llgl_renderer, model, options.depthPrepass);
+    const double pipelineInitMs = millisecondsBetween(initStart, Clock::now());
+
+    GpuTimer gpuTimer;
+    gpuTimer.init(llgl_renderer, { "Scene", "Depth pre-pass" });
+
+    // Camera path
+    CameraPath path;
+    if (options.benchmarkPath == "orbit") {
+        const uint32_t orbitFrames = options.frameCount > 0 ? options.frameCount : DEFAULT_ORBIT_FRAMES;
+        path = CameraPath::makeOrbit(orbitFrames, model.getRadius() * 2.5f);
+    } else if (!path.load(options.benchmarkPath)) {
+        gpuTimer.release(llgl_renderer);
+        modelRenderer.release(llgl_renderer);
+        target.release(llgl_renderer);
+        model.release(llgl_renderer);
+        LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+        return 1;
+    }
+    const uint32_t frameCount = options.frameCount > 0 ? options.frameCount : path.getFrameCount();
+
+    OrbitCamera camera;
+    camera.setTarget(model.getCenter(), model.getRadius() * 2.5f);
+    float rotationY = 0.0f;
+    float rotationX = 0.0f;
+
+    const float aspect = static_cast<float>(options.width) / static_cast<float>(options.height);
+    auto cmdBuffer = llgl_renderer->CreateCommandBuffer(LLGL::CommandBufferFlags::ImmediateSubmit);
+    LLGL::CommandQueue* queue = llgl_renderer->GetCommandQueue();
+
+    std::vector<double> frameMs;
+    std::array<std::vector<double>, PHASE_COUNT> phaseMs;
+    frameMs.reserve(frameCount);
+    for (auto& samples : phaseMs) {
+        samples.reserve(frameCount);
+    }
+    DrawStats drawTotals;
+    std::vector<uint8_t> pixels;
+
+    log_info(LogCategory::App, "Benchmark: %u frames (+%u warm-up) at %u x %u\n", frameCount, options.warmupFrames,
+             options.width, options.height);
+    const auto benchmarkStart = Clock::now();
+
+    // Warm-up frames replay the first key and are not measured
+    for (uint32_t i = 0; i < options.warmupFrames + frameCount; i++) {
+        PROFILE_FRAME_MARK();
+        PROFILE_SCOPE("Frame");
+        const bool measured = i >= options.warmupFrames;
+        const uint32_t frame = measured ? i - options.warmupFrames : 0;
+
+        const auto frameStart = Clock::now();
+        path.apply(frame, camera, rotationY, rotationX);
+        modelRenderer.updateMatrices(llgl_renderer,
+                                     compute_model_matrices(camera, model.getCenter(), rotationY, rotationX, aspect));
+        const auto updateEnd = Clock::now();
+
+        DrawStats prepassStats, stats;
+        gpuTimer.beginFrame(*queue);
+        cmdBuffer->Begin();
+        {
+            cmdBuffer->SetViewport(target.getResolution());
+
+            cmdBuffer->BeginRenderPass(*target.getRenderTarget());
+            {
+                cmdBuffer->Clear(LLGL::ClearFlags::ColorDepth, LLGL::ClearValue{ 0.1f, 0.1f, 0.15f, 1.0f });
+                if (options.depthPrepass) {
+                    gpuTimer.beginSection(*cmdBuffer, 1);
+                    prepassStats = modelRenderer.renderDepthPrepass(*cmdBuffer, model);
+                    gpuTimer.endSection(*cmdBuffer, 1);
+                }
+                gpuTimer.beginSection(*cmdBuffer, 0);
+                stats = modelRenderer.render(*cmdBuffer, model);
+                gpuTimer.endSection(*cmdBuffer, 0);
+            }
+            cmdBuffer->EndRenderPass();
+        }
+        cmdBuffer->End();
+        const auto recordEnd = Clock::now();
+
+        // Keep the CPU from running ahead so every frame time includes its GPU work
+        queue->WaitIdle();
+        const auto waitEnd = Clock::now();
+
+        if (options.readbackEveryFrame) {
+            target.readPixels(llgl_renderer, pixels);
+        }
+        const auto frameEnd = Clock::now();
+
+        if (measured) {
+            frameMs.push_back(millisecondsBetween(frameStart, frameEnd));
+            phaseMs[PHASE_UPDATE].push_back(millisecondsBetween(frameStart, updateEnd));
+            phaseMs[PHASE_RECORD].push_back(millisecondsBetween(updateEnd, recordEnd));
+            phaseMs[PHASE_WAIT].push_back(millisecondsBetween(recordEnd, waitEnd));
+            phaseMs[PHASE_READBACK].push_back(millisecondsBetween(waitEnd, frameEnd));
+
+            drawTotals.drawCalls += prepassStats.drawCalls + stats.drawCalls;
+            drawTotals.triangles += prepassStats.triangles + stats.triangles;
+            drawTotals.pipelineBinds += prepassStats.pipelineBinds + stats.pipelineBinds;
+            drawTotals.resourceBinds += prepassStats.resourceBinds + stats.resourceBinds;
+        }
+    }
+
+    const double totalSeconds = std::chrono::duration<double>(Clock::now() - benchmarkStart).count();
+    const SampleSummary frameSummary = summarize_samples(frameMs);
+    log_info(LogCategory::App, "Frame time: p50 %.3f ms, p95 %.3f ms, p99 %.3f ms (mean %.3f ms)\n", frameSummary.p50,
+             frameSummary.p95, frameSummary.p99, frameSummary.mean);
+
+    // Report
+    const auto& info = llgl_renderer->GetRendererInfo();
+    const double frames = static_cast<double>(std::max(frameCount, 1u));
+
+    JsonWriter json;
+    json.beginObject();
+    json.field("renderer", info.rendererName);
+    json.field("device", info.deviceName);
+    json.field("model", options.modelPath);
+    json.field("modelLoaded", modelLoaded);
+    json.field("cameraPath", options.benchmarkPath);
+    json.field("width", options.width);
+    json.field("height", options.height);
+    json.field("frames", frameCount);
+    json.field("warmupFrames", options.warmupFrames);
+    json.field("readbackEveryFrame", options.readbackEveryFrame);
+    json.field("depthPrepass", options.depthPrepass);
+    json.field("totalSeconds", totalSeconds);
+
+    json.key("startupMs").beginObject();
+    json.field("modelLoad", loadMs);
+    json.field("pipelineInit", pipelineInitMs);
+    json.endObject();
+
+    // Compare a first run (cold) with a second one (warm) to see what the pipeline cache saves
+    const PipelineCacheStats cacheStats = pipeline_cache_stats();
+    json.key("pipelineCache").beginObject();
+    json.field("state", !cacheStats.enabled ? "disabled" : (cacheStats.warm ? "warm" : "cold"));
+    json.field("loadedBytes", cacheStats.loadedBytes);
+    json.field("pipelines", cacheStats.pipelines);
+    json.field("creationMs", cacheStats.creationMs);
+    json.endObject();
+
+    const PipelineRegistryStats registryStats = pipeline_registry_stats();
+    json.key("pipelineRegistry").beginObject();
+    json.field("requests", registryStats.requests);
+    json.field("hits", registryStats.hits);
+    json.field("unique", registryStats.unique);
+    json.field("layoutHits", registryStats.layoutHits);
+    json.field("translationMs", registryStats.translationMs);
+    json.endObject();
+
+    const ShaderCacheStats shaderStats = shader_cache_stats();
+    json.key("shaderCache").beginObject();
+    json.field("enabled", shaderStats.enabled);
+    json.field("hits", shaderStats.hits);
+    json.field("misses", shaderStats.misses);
+    json.field("savedMs", shaderStats.savedMs);
+    json.field("translationMs", shaderStats.translationMs);
+    json.field("reflectionHits", shaderStats.reflectionHits);
+    json.field("reflectionMisses", shaderStats.reflectionMisses);
+    json.endObject();
+
+    write_summary(json, "frameTimeMs", frameSummary);
+
+    json.key("phasesMs").beginObject();
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        write_summary(json, PHASE_NAMES[phase], summarize_samples(phaseMs[phase]));
+    }
+    json.endObject();
+
+    json.key("drawsPerFrame").beginObject();
+    json.field("drawCalls", drawTotals.drawCalls / frames);
+    json.field("triangles", static_cast<double>(drawTotals.triangles) / frames);
+    json.field("pipelineBinds", drawTotals.pipelineBinds / frames);
+    json.field("resourceBinds", drawTotals.resourceBinds / frames);
+    json.endObject();
+
+    json.key("gpu").beginObject();
+    json.field("timerQueries", gpuTimer.hasTimerQueries());
+    json.field("resolvedFrames", gpuTimer.getResolvedFrames());
+    json.field("droppedFrames", gpuTimer.getDroppedFrames());
+    if (gpuTimer.hasTimerQueries() && gpuTimer.getResolvedFrames() > 0) {
+        json.field("scenePassMs", static_cast<double>(gpuTimer.getAverageMs(0)));
+        if (options.depthPrepass) {
+            json.field("depthPrepassMs", static_cast<double>(gpuTimer.getAverageMs(1)));
+        }
+    }
+    if (gpuTimer.hasPipelineStatistics() && gpuTimer.getResolvedFrames() > 0) {
+        const auto& statistics = gpuTimer.getSections()[0].statistics;
+        // Scene pass only: compare runs with and without --depth-prepass for the overdraw saved
+        json.field("fragmentShaderInvocations", statistics.fragmentShaderInvocations);
+        json.field("fragmentsPerPixel", static_cast<double>(statistics.fragmentShaderInvocations) /
+                                            (static_cast<double>(options.width) * options.height));
+    }
+    json.endObject();
+
+    json.endObject();
+
+    const std::string reportPath = options.reportPath.empty() ? "benchmark.json" : options.reportPath;
+    int result = 0;
+    if (json.writeToFile(reportPath)) {
+        log_info(LogCategory::App, "Wrote %s\n", reportPath.c_str());
+    } else {
+        log_error(LogCategory::App, "Failed to write benchmark report: %s\n", reportPath.c_str());
+        result = 1;
+    }
+
+    // Cleanup
+    llgl_renderer->Release(*cmdBuffer);
+    gpuTimer.release(llgl_renderer);
+    modelRenderer.release(llgl_renderer);
+    target.release(llgl_renderer);
+    model.release(llgl_renderer);
+    log_shader_cache_stats();
+    save_pipeline_cache(llgl_renderer);
+    LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+
+    return result;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "app_options.h"
+
+// Replays options.benchmarkPath (a CameraPath file or "orbit") offscreen and writes frame-time
+// percentiles, CPU time per phase and draw statistics to options.reportPath (default benchmark.json).
+int run_benchmark(const AppOptions& options);
@@ -0,0 +1,141 @@
+#include "camera_path.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "logger.h"
+
+namespace {
+
+bool sameState(const CameraKey& a, const CameraKey& b) {
+    return a.yaw == b.yaw && a.pitch == b.pitch && a.distance == b.distance && a.rotationY == b.rotationY &&
+           a.rotationX == b.rotationX;
+}
+
+float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+} // anonymous namespace
+
+bool CameraPath::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        log_error(LogCategory::App, "Failed to open camera path: %s\n", path.c_str());
+        return false;
+    }
+
+    keys_.clear();
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream stream(line);
+        CameraKey key;
+        if (!(stream >> key.frame >> key.yaw >> key.pitch >> key.distance >> key.rotationY >> key.rotationX)) {
+            log_error(LogCategory::App, "%s:%u: expected <frame> <yaw> <pitch> <distance> <rotationY> <rotationX>\n",
+                      path.c_str(), lineNumber);
+            return false;
+        }
+        if (!keys_.empty() && key.frame <= keys_.back().frame) {
+            log_error(LogCategory::App, "%s:%u: key frames must be increasing\n", path.c_str(), lineNumber);
+            return false;
+        }
+        keys_.push_back(key);
+    }
+
+    if (keys_.empty()) {
+        log_error(LogCategory::App, "Camera path has no keys: %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CameraPath::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        log_error(LogCategory::App, "Failed to write camera path: %s\n", path.c_str());
+        return false;
+    }
+
+    file << "# frame yaw pitch distance rotationY rotationX\n";
+    auto writeKey = [&file](const CameraKey& key) {
+        char line[160];
+        std::snprintf(line, sizeof(line), "%u %.9g %.9g %.9g %.9g %.9g\n", key.frame, key.yaw, key.pitch,
+                      key.distance, key.rotationY, key.rotationX);
+        file << line;
+    };
+    for (const auto& key : keys_) {
+        writeKey(key);
+    }
+    // Close a trailing stationary stretch so the path keeps its full length
+    if (hasPendingKey_) {
+        writeKey(pendingKey_);
+    }
+    return static_cast<bool>(file);
+}
+
+CameraPath CameraPath::makeOrbit(uint32_t frameCount, float distance) {
+    CameraPath path;
+    const uint32_t lastFrame = std::max(frameCount, 2u) - 1;
+    path.keys_.push_back({ 0, 0.0f, 0.3f, distance, 0.0f, 0.0f });
+    path.keys_.push_back({ lastFrame, 2.0f * Math::PI, 0.3f, distance, 0.0f, 0.0f });
+    return path;
+}
+
+void CameraPath::record(uint32_t frame, const OrbitCamera& camera, float rotationY, float rotationX) {
+    CameraKey key{ frame, camera.getYaw(), camera.getPitch(), camera.getDistance(), rotationY, rotationX };
+
+    if (!keys_.empty() && sameState(key, keys_.back())) {
+        // Still stationary, remember where the stretch ends
+        pendingKey_ = key;
+        hasPendingKey_ = true;
+        return;
+    }
+    if (hasPendingKey_) {
+        keys_.push_back(pendingKey_);
+        hasPendingKey_ = false;
+    }
+    keys_.push_back(key);
+}
+
+CameraKey CameraPath::sample(uint32_t frame) const {
+    if (keys_.empty()) {
+        return CameraKey{ frame };
+    }
+    if (frame <= keys_.front().frame) {
+        return keys_.front();
+    }
+    if (frame >= keys_.back().frame) {
+        return keys_.back();
+    }
+
+    auto next = std::upper_bound(keys_.begin(), keys_.end(), frame,
+                                 [](uint32_t f, const CameraKey& key) { return f < key.frame; });
+    const CameraKey& b = *next;
+    const CameraKey& a = *(next - 1);
+    const float t = static_cast<float>(frame - a.frame) / static_cast<float>(b.frame - a.frame);
+
+    CameraKey key;
+    key.frame = frame;
+    key.yaw = lerp(a.yaw, b.yaw, t);
+    key.pitch = lerp(a.pitch, b.pitch, t);
+    key.distance = lerp(a.distance, b.distance, t);
+    key.rotationY = lerp(a.rotationY, b.rotationY, t);
+    key.rotationX = lerp(a.rotationX, b.rotationX, t);
+    return key;
+}
+
+void CameraPath::apply(uint32_t frame, OrbitCamera& camera, float& rotationY, float& rotationX) const {
+    const CameraKey key = sample(frame);
+    camera.setYaw(key.yaw);
+    camera.setPitch(key.pitch);
+    camera.setDistance(key.distance);
+    rotationY = key.rotationY;
+    rotationX = key.rotationX;
+}
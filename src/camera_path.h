@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "camera.h"
+
+// Camera and model rotation state at a given frame
+struct CameraKey {
+    uint32_t frame = 0;
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    float distance = 1.0f;
+    float rotationY = 0.0f;
+    float rotationX = 0.0f;
+};
+
+// Keyframed camera path for deterministic replays.
+//
+// Text format, one key per line (lines starting with # are ignored):
+//   <frame> <yaw> <pitch> <distance> <rotationY> <rotationX>
+// Values between keys are linearly interpolated, frames past the last key hold it.
+class CameraPath {
+  public:
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Full turn around the model at `distance`, used when no path file is given
+    static CameraPath makeOrbit(uint32_t frameCount, float distance);
+
+    // Appends the state of `frame`. Stationary stretches are stored as their two end keys only.
+    void record(uint32_t frame, const OrbitCamera& camera, float rotationY, float rotationX);
+
+    CameraKey sample(uint32_t frame) const;
+    void apply(uint32_t frame, OrbitCamera& camera, float& rotationY, float& rotationX) const;
+
+    // Number of frames covered by the keys
+    uint32_t getFrameCount() const {
+        return keys_.empty() ? 0 : keys_.back().frame + 1;
+    }
+    const std::vector<CameraKey>& getKeys() const {
+        return keys_;
+    }
+
+  private:
+    std::vector<CameraKey> keys_;
+    CameraKey pendingKey_;
+    bool hasPendingKey_ = false;
+};
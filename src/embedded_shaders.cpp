@@ -0,0 +1,62 @@
+#include "embedded_shaders.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+std::atomic<uint32_t> g_hits{ 0 };
+
+ShaderCode toShaderCode(bool spirv, const unsigned char* data, size_t size) {
+    if (spirv) {
+        std::vector<uint32_t> words(size / sizeof(uint32_t));
+        std::memcpy(words.data(), data, words.size() * sizeof(uint32_t));
+        return words;
+    }
+    return std::string(reinterpret_cast<const char*>(data), size);
+}
+
+} // anonymous namespace
+
+#ifndef TEST_LLGL_EMBEDDED_SHADERS
+std::span<const EmbeddedShaderSource> embedded_shader_sources() {
+    return {};
+}
+
+std::span<const EmbeddedShaderBlob> embedded_shader_blobs() {
+    return {};
+}
+#endif
+
+bool read_embedded_shader_sources(const std::string& name, std::string& vertShaderSource,
+                                  std::string& fragShaderSource) {
+    for (const auto& source : embedded_shader_sources()) {
+        if (name == source.name) {
+            vertShaderSource.assign(reinterpret_cast<const char*>(source.vert), source.vertSize);
+            fragShaderSource.assign(reinterpret_cast<const char*>(source.frag), source.fragSize);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool read_embedded_shaders(uint64_t key, uint32_t target, ShaderCode& vertShader, ShaderCode& fragShader) {
+    const auto blobs = embedded_shader_blobs();
+    auto it = std::lower_bound(blobs.begin(), blobs.end(), key,
+                               [](const EmbeddedShaderBlob& blob, uint64_t value) { return blob.key < value; });
+    for (; it != blobs.end() && it->key == key; ++it) {
+        if (it->target == target) {
+            vertShader = toShaderCode(it->spirv, it->vert, it->vertSize);
+            fragShader = toShaderCode(it->spirv, it->frag, it->fragSize);
+            g_hits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t embedded_shader_hits() {
+    return g_hits.load();
+}
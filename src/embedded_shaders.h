@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "shader_cache.h"
+
+// Shaders translated at build time by Test-LLGL-ShaderEmbed (TEST_LLGL_EMBED_SHADERS) and compiled into the
+// executable. Without the generated data both tables are empty and everything is translated at runtime.
+
+// Sources of one shader/ pair, so that the executable doesn't depend on the working directory
+struct EmbeddedShaderSource {
+    const char* name;
+    const unsigned char* vert;
+    size_t vertSize;
+    const unsigned char* frag;
+    size_t fragSize;
+};
+
+// One translation, stored under the same key and target id as the shader cache (sorted by key)
+struct EmbeddedShaderBlob {
+    uint64_t key;
+    uint32_t target;
+    bool spirv; // SPIR-V words, otherwise source text
+    const unsigned char* vert;
+    size_t vertSize;
+    const unsigned char* frag;
+    size_t fragSize;
+};
+
+// Defined by the generated embedded_shaders_data.cpp
+std::span<const EmbeddedShaderSource> embedded_shader_sources();
+std::span<const EmbeddedShaderBlob> embedded_shader_blobs();
+
+// Copies the sources of shader/<name>.vert/.frag; returns false if they weren't embedded
+bool read_embedded_shader_sources(const std::string& name, std::string& vertShaderSource,
+                                  std::string& fragShaderSource);
+
+// Like read_cached_shaders, for the translations embedded at build time. Any change to the sources or the
+// translation settings changes the key, so edited shaders fall back to runtime translation.
+bool read_embedded_shaders(uint64_t key, uint32_t target, ShaderCode& vertShader, ShaderCode& fragShader);
+
+// Number of read_embedded_shaders hits so far
+uint32_t embedded_shader_hits();
@@ -0,0 +1,71 @@
+#include "file_watcher.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(const std::string& directory) {
+    stop();
+#ifdef __linux__
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        log_error(LogCategory::App, "inotify_init1 failed (errno %d)\n", errno);
+        return false;
+    }
+    if (inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        log_error(LogCategory::App, "Failed to watch %s (errno %d)\n", directory.c_str(), errno);
+        stop();
+        return false;
+    }
+    return true;
+#else
+    (void)directory;
+    return false;
+#endif
+}
+
+void FileWatcher::stop() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+#endif
+    fd_ = -1;
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> changed;
+#ifdef __linux__
+    if (fd_ < 0) {
+        return changed;
+    }
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t size = read(fd_, buffer, sizeof(buffer));
+        if (size <= 0) {
+            break; // EAGAIN: no more events
+        }
+        for (ssize_t offset = 0; offset < size;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                const std::string name = event->name;
+                if (std::find(changed.begin(), changed.end(), name) == changed.end()) {
+                    changed.push_back(name);
+                }
+            }
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+#endif
+    return changed;
+}
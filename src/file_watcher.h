@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Non-blocking change notifications for the files of one directory (not its subdirectories). Uses inotify on
+// Linux; on other platforms start() fails and the watcher stays inactive.
+class FileWatcher {
+  public:
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool start(const std::string& directory);
+    void stop();
+    bool isActive() const {
+        return fd_ >= 0;
+    }
+
+    // Names of the files written or moved into the directory since the last call, each once. Editors that
+    // save through a temporary file report the final name as well.
+    std::vector<std::string> poll();
+
+  private:
+    int fd_ = -1;
+};
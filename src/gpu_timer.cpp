@@ -0,0 +1,143 @@
+#include "gpu_timer.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+void GpuTimer::init(LLGL::RenderSystemPtr& renderer, const std::vector<std::string>& sectionNames) {
+    sections_.clear();
+    for (const auto& name : sectionNames) {
+        Section section;
+        section.name = name;
+        sections_.push_back(std::move(section));
+    }
+
+    const auto& features = renderer->GetRenderingCaps().features;
+    const uint32_t queryCount = FRAME_LATENCY * static_cast<uint32_t>(sections_.size());
+
+    if (features.hasTimerQueries) {
+        LLGL::QueryHeapDescriptor heapDesc;
+        heapDesc.debugName = "GpuTimer.TimeElapsed";
+        heapDesc.type = LLGL::QueryType::TimeElapsed;
+        heapDesc.numQueries = queryCount;
+        timerHeap_ = renderer->CreateQueryHeap(heapDesc);
+    }
+    if (features.hasPipelineStatistics) {
+        LLGL::QueryHeapDescriptor heapDesc;
+        heapDesc.debugName = "GpuTimer.PipelineStatistics";
+        heapDesc.type = LLGL::QueryType::PipelineStatistics;
+        heapDesc.numQueries = queryCount;
+        statisticsHeap_ = renderer->CreateQueryHeap(heapDesc);
+    }
+
+    if (!timerHeap_) {
+        log_warning(LogCategory::Render, "GPU timer queries are not supported by %s, pass timings disabled\n",
+                    renderer->GetRendererInfo().rendererName.c_str());
+    }
+}
+
+void GpuTimer::release(LLGL::RenderSystemPtr& renderer) {
+    if (timerHeap_) {
+        renderer->Release(*timerHeap_);
+        timerHeap_ = nullptr;
+    }
+    if (statisticsHeap_) {
+        renderer->Release(*statisticsHeap_);
+        statisticsHeap_ = nullptr;
+    }
+}
+
+void GpuTimer::beginFrame(LLGL::CommandQueue& queue) {
+    if (!timerHeap_ && !statisticsHeap_) {
+        return;
+    }
+
+    currentSlice_ = static_cast<uint32_t>(frame_ % FRAME_LATENCY);
+    if (frame_ >= FRAME_LATENCY) {
+        resolveSlice(queue, currentSlice_);
+    }
+    recordedSections_[currentSlice_] = 0;
+    frame_++;
+}
+
+void GpuTimer::beginSection(LLGL::CommandBuffer& cmdBuffer, uint32_t section) {
+    if (timerHeap_) {
+        cmdBuffer.BeginQuery(*timerHeap_, queryIndex(currentSlice_, section));
+    }
+    if (statisticsHeap_) {
+        cmdBuffer.BeginQuery(*statisticsHeap_, queryIndex(currentSlice_, section));
+    }
+}
+
+void GpuTimer::endSection(LLGL::CommandBuffer& cmdBuffer, uint32_t section) {
+    if (statisticsHeap_) {
+        cmdBuffer.EndQuery(*statisticsHeap_, queryIndex(currentSlice_, section));
+    }
+    if (timerHeap_) {
+        cmdBuffer.EndQuery(*timerHeap_, queryIndex(currentSlice_, section));
+    }
+    recordedSections_[currentSlice_] |= (1u << section);
+}
+
+float GpuTimer::getAverageMs(uint32_t section) const {
+    const Section& timed = sections_[section];
+    if (timed.resolvedFrames == 0) {
+        return 0.0f;
+    }
+    const size_t count = std::min<uint64_t>(timed.resolvedFrames, HISTORY_SIZE);
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        sum += timed.historyMs[(timed.historyOffset + HISTORY_SIZE - 1 - i) % HISTORY_SIZE];
+    }
+    return sum / static_cast<float>(count);
+}
+
+void GpuTimer::resolveSlice(LLGL::CommandQueue& queue, uint32_t slice) {
+    const uint32_t recorded = recordedSections_[slice];
+    if (recorded == 0) {
+        return;
+    }
+
+    // Poll each recorded query once; a query that is not ready means the GPU is more than
+    // FRAME_LATENCY frames behind, in which case the frame is dropped rather than waited for.
+    // Nothing is stored until every query has its result, so a slice is never half-resolved.
+    std::vector<float> elapsedMs(sections_.size(), 0.0f);
+    std::vector<LLGL::QueryPipelineStatistics> statistics(sections_.size());
+    for (uint32_t section = 0; section < sections_.size(); section++) {
+        if ((recorded & (1u << section)) == 0) {
+            continue;
+        }
+        const uint32_t query = queryIndex(slice, section);
+        if (timerHeap_) {
+            uint64_t elapsedNs = 0;
+            if (!queue.QueryResult(*timerHeap_, query, 1, &elapsedNs, sizeof(elapsedNs))) {
+                droppedFrames_++;
+                return;
+            }
+            elapsedMs[section] = static_cast<float>(static_cast<double>(elapsedNs) / 1.0e6);
+        }
+        if (statisticsHeap_ &&
+            !queue.QueryResult(*statisticsHeap_, query, 1, &statistics[section], sizeof(statistics[section]))) {
+            droppedFrames_++;
+            return;
+        }
+    }
+
+    // Sections the frame didn't record (e.g. the pre-pass while it is off) keep their history
+    for (uint32_t section = 0; section < sections_.size(); section++) {
+        if ((recorded & (1u << section)) == 0) {
+            continue;
+        }
+        Section& timed = sections_[section];
+        if (statisticsHeap_) {
+            timed.statistics = statistics[section];
+        }
+        if (timerHeap_) {
+            timed.lastMs = elapsedMs[section];
+            timed.historyMs[timed.historyOffset] = elapsedMs[section];
+            timed.historyOffset = (timed.historyOffset + 1) % HISTORY_SIZE;
+        }
+        timed.resolvedFrames++;
+    }
+    resolvedFrames_++;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+// Per-pass GPU timing with timer and pipeline-statistics queries.
+//
+// Every frame records into its own slice of the query heaps. A slice is read back when it comes
+// around again FRAME_LATENCY frames later, so reading results never stalls the CPU; a slice with any
+// result still not available by then is dropped as a whole. Sections only get history entries for the
+// frames that recorded them. On backends without query support all calls are no-ops.
+class GpuTimer {
+  public:
+    static constexpr uint32_t FRAME_LATENCY = 4;
+    static constexpr uint32_t HISTORY_SIZE = 120;
+
+    struct Section {
+        std::string name;
+        std::vector<float> historyMs = std::vector<float>(HISTORY_SIZE, 0.0f);
+        uint32_t historyOffset = 0; // Ring offset of the oldest entry (for ImGui::PlotLines)
+        uint64_t resolvedFrames = 0;
+        float lastMs = 0.0f;
+        LLGL::QueryPipelineStatistics statistics = {};
+    };
+
+    void init(LLGL::RenderSystemPtr& renderer, const std::vector<std::string>& sectionNames);
+    void release(LLGL::RenderSystemPtr& renderer);
+
+    // Collects the oldest slice and starts recording into it, call once per frame before any section
+    void beginFrame(LLGL::CommandQueue& queue);
+
+    void beginSection(LLGL::CommandBuffer& cmdBuffer, uint32_t section);
+    void endSection(LLGL::CommandBuffer& cmdBuffer, uint32_t section);
+
+    bool hasTimerQueries() const {
+        return timerHeap_ != nullptr;
+    }
+    bool hasPipelineStatistics() const {
+        return statisticsHeap_ != nullptr;
+    }
+
+    const std::vector<Section>& getSections() const {
+        return sections_;
+    }
+    float getAverageMs(uint32_t section) const;
+    uint64_t getResolvedFrames() const {
+        return resolvedFrames_;
+    }
+    uint64_t getDroppedFrames() const {
+        return droppedFrames_;
+    }
+
+  private:
+    void resolveSlice(LLGL::CommandQueue& queue, uint32_t slice);
+    uint32_t queryIndex(uint32_t slice, uint32_t section) const {
+        return slice * static_cast<uint32_t>(sections_.size()) + section;
+    }
+
+    std::vector<Section> sections_;
+    LLGL::QueryHeap* timerHeap_ = nullptr;
+    LLGL::QueryHeap* statisticsHeap_ = nullptr;
+
+    uint64_t frame_ = 0;
+    uint32_t currentSlice_ = 0;
+    // Bit per section that was recorded in each slice
+    std::vector<uint32_t> recordedSections_ = std::vector<uint32_t>(FRAME_LATENCY, 0);
+    bool hasResults_ = false;
+
+    uint64_t resolvedFrames_ = 0;
+    uint64_t droppedFrames_ = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// 64-bit FNV-1a, used for cache keys and file versioning (not cryptographic)
+constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+inline uint64_t hash_bytes(const void* data, size_t size, uint64_t hash = HASH_SEED) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+inline uint64_t hash_string(const std::string& text, uint64_t hash = HASH_SEED) {
+    // Length first so that ("ab", "c") and ("a", "bc") differ when strings are chained
+    const uint64_t size = text.size();
+    return hash_bytes(text.data(), text.size(), hash_bytes(&size, sizeof(size), hash));
+}
+
+template <typename T> inline uint64_t hash_value(const T& value, uint64_t hash = HASH_SEED) {
+    return hash_bytes(&value, sizeof(T), hash);
+}
+
+inline std::string hash_to_hex(uint64_t hash) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
@@ -0,0 +1,162 @@
+#include "headless.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+#include "camera.h"
+#include "gpu_timer.h"
+#include "logger.h"
+#include "model_loader.h"
+#include "model_renderer.h"
+#include "offscreen_target.h"
+#include "primitives.h"
+#include "pipeline_cache.h"
+#include "profiler.h"
+#include "shader_cache.h"
+
+extern LLGL::RenderSystemPtr llgl_renderer;
+
+LLGL::RenderSystemPtr load_headless_renderer(const std::string& moduleName) {
+    const std::string moduleToLoad = moduleName.empty() ? "Null" : moduleName;
+    LLGL::RenderSystemDescriptor desc = { moduleToLoad.c_str() };
+    LLGL::Report report;
+    LLGL::RenderSystemPtr renderer = LLGL::RenderSystem::Load(desc, &report);
+
+    if (!renderer && moduleToLoad != "Null") {
+        log_error(LogCategory::App, "Failed to load \"%s\" module. Falling back to \"Null\" device.\n",
+                  moduleToLoad.c_str());
+        log_error(LogCategory::App, "Reason for failure: %s", report.HasErrors() ? report.GetText() : "Unknown\n");
+        renderer = LLGL::RenderSystem::Load("Null");
+    }
+    if (!renderer) {
+        log_error(LogCategory::App, "Failed to load \"Null\" module. Exiting.\n");
+    }
+    return renderer;
+}
+
+int run_headless(const AppOptions& options) {
+    llgl_renderer = load_headless_renderer(options.rendererModule);
+    if (!llgl_renderer) {
+        return 1;
+    }
+    if (options.pipelineCache) {
+        load_pipeline_cache(llgl_renderer, options.cacheDir);
+    }
+    if (options.shaderCache) {
+        init_shader_cache(options.cacheDir);
+    }
+
+    const auto& info = llgl_renderer->GetRendererInfo();
+    log_info(LogCategory::App, "Renderer:             %s (headless)\n"
+                               "Device:               %s\n"
+                               "Resolution:           %u x %u\n",
+             info.rendererName.c_str(), info.deviceName.c_str(), options.width, options.height);
+
+    // Load 3D model
+    Model model;
+    if (!model.load(options.modelPath, llgl_renderer)) {
+        log_error(LogCategory::App, "Failed to load model: %s\n", options.modelPath.c_str());
+        log_info(LogCategory::App, "Creating a default cube...\n");
+
+        model = Primitives::createDefaultModel();
+        model.calculateBounds();
+    }
+    model.createBuffers(llgl_renderer);
+
+    OffscreenTarget target;
+    if (!target.create(llgl_renderer, { options.width, options.height })) {
+        // Whatever create() got to before failing
+        target.release(llgl_renderer);
+        model.release(llgl_renderer);
+        LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+        return 1;
+    }
+
+    ModelRenderer modelRenderer;
+    modelRenderer.init(llgl_renderer, target.getRenderPass(), model.getVertexFormat());
+    modelRenderer.prepare(llgl_renderer, model);
+    modelRenderer.setDepthPrepass(llgl_renderer, model, options.depthPrepass);
+
+    OrbitCamera camera;
+    camera.setTarget(model.getCenter(), model.getRadius() * 2.5f);
+
+    const float aspect = static_cast<float>(options.width) / static_cast<float>(options.height);
+    auto cmdBuffer = llgl_renderer->CreateCommandBuffer(LLGL::CommandBufferFlags::ImmediateSubmit);
+
+    GpuTimer gpuTimer;
+    gpuTimer.init(llgl_renderer, { "Scene" });
+
+    std::vector<uint8_t> pixels;
+    const auto startTime = std::chrono::steady_clock::now();
+
+    const uint32_t frameCount = options.frameCount > 0 ? options.frameCount : 1;
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        PROFILE_FRAME_MARK();
+        PROFILE_SCOPE("Frame");
+
+        // Deterministic rotation so every run produces the same frames
+        float rotationY = 0.01f * static_cast<float>(frame);
+        modelRenderer.updateMatrices(llgl_renderer,
+                                     compute_model_matrices(camera, model.getCenter(), rotationY, 0.0f, aspect));
+
+        gpuTimer.beginFrame(*llgl_renderer->GetCommandQueue());
+        cmdBuffer->Begin();
+        {
+            cmdBuffer->SetViewport(target.getResolution());
+
+            cmdBuffer->BeginRenderPass(*target.getRenderTarget());
+            {
+                cmdBuffer->Clear(LLGL::ClearFlags::ColorDepth, LLGL::ClearValue{ 0.1f, 0.1f, 0.15f, 1.0f });
+                gpuTimer.beginSection(*cmdBuffer, 0);
+                modelRenderer.renderDepthPrepass(*cmdBuffer, model);
+                modelRenderer.render(*cmdBuffer, model);
+                gpuTimer.endSection(*cmdBuffer, 0);
+            }
+            cmdBuffer->EndRenderPass();
+        }
+        cmdBuffer->End();
+
+        if (options.readbackEveryFrame || frame + 1 == frameCount) {
+            PROFILE_SCOPE("ReadPixels");
+            target.readPixels(llgl_renderer, pixels);
+        }
+    }
+
+    llgl_renderer->GetCommandQueue()->WaitIdle();
+
+    const double elapsedSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    log_info(LogCategory::App, "Rendered %u frames in %.3f s (%.1f frames/s)\n", frameCount, elapsedSeconds,
+             elapsedSeconds > 0.0 ? frameCount / elapsedSeconds : 0.0);
+    if (gpuTimer.getResolvedFrames() > 0) {
+        log_info(LogCategory::App, "GPU scene pass: %.3f ms average over the last %llu frames (%llu results dropped)\n",
+                 gpuTimer.getAverageMs(0),
+                 static_cast<unsigned long long>(std::min<uint64_t>(gpuTimer.getResolvedFrames(),
+                                                                    GpuTimer::HISTORY_SIZE)),
+                 static_cast<unsigned long long>(gpuTimer.getDroppedFrames()));
+    }
+
+    int result = 0;
+    if (!options.outputPath.empty()) {
+        if (OffscreenTarget::writePNG(options.outputPath, target.getResolution(), pixels)) {
+            log_info(LogCategory::App, "Wrote %s\n", options.outputPath.c_str());
+        } else {
+            result = 1;
+        }
+    }
+
+    // Cleanup
+    llgl_renderer->Release(*cmdBuffer);
+    gpuTimer.release(llgl_renderer);
+    modelRenderer.release(llgl_renderer);
+    target.release(llgl_renderer);
+    model.release(llgl_renderer);
+    log_shader_cache_stats();
+    save_pipeline_cache(llgl_renderer);
+    LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+
+    return result;
+}
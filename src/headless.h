@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+#include <LLGL/LLGL.h>
+
+#include "app_options.h"
+
+// Loads an LLGL render system without any window or surface, falling back to the Null device
+LLGL::RenderSystemPtr load_headless_renderer(const std::string& moduleName);
+
+// Renders the model into an offscreen target (no SDL window, no swap chain, no vsync)
+int run_headless(const AppOptions& options);
@@ -9,32 +9,74 @@
 #include <LLGL/LLGL.h>
 #include <LLGL/Utils/VertexFormat.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <vector>
 #include <variant>
 
+#include "logger.h"
+#include "shader_reflection.h"
 #include "shader_translation.h"
 
+// Geometry of one frame in flight. The buffers are written again only after the fence submitted behind the
+// frame has signaled, so the CPU never overwrites data the GPU may still read.
+struct ImGui_ImplLLGL_FrameResources {
+    LLGL::Buffer* VertexBuffer = nullptr;
+    LLGL::Buffer* IndexBuffer = nullptr;
+    int VertexBufferSize = 0;
+    int IndexBufferSize = 0;
+    int VertexLowWaterFrames = 0; // Consecutive uses of this slot at or below a quarter of the capacity
+    int IndexLowWaterFrames = 0;
+    LLGL::Fence* Fence = nullptr;
+    bool FenceSubmitted = false;
+};
+
+// Vertex/index buffer pairs cycled through, one per frame
+static constexpr int FRAMES_IN_FLIGHT = 3;
+
+// Draw being accumulated from adjacent commands with the same texture and clip rect and contiguous indices
+struct ImGui_ImplLLGL_PendingDraw {
+    LLGL::Texture* Texture = nullptr;
+    LLGL::Scissor Scissor;
+    int VertexOffset = 0;
+    unsigned int FirstIndex = 0;
+    unsigned int IndexCount = 0; // 0: nothing pending
+};
+
 // LLGL backend data
 struct ImGui_ImplLLGL_Data {
     LLGL::RenderSystem* RenderSystem = nullptr;
     LLGL::SwapChain* SwapChain = nullptr;
     LLGL::CommandBuffer* CommandBuffer = nullptr;
+    LLGL::PipelineCache* PipelineCache = nullptr;
+    int ShrinkAfterFrames = 0;
 
     LLGL::PipelineState* Pipeline = nullptr;
     LLGL::PipelineLayout* PipelineLayout = nullptr;
     LLGL::Shader* VertexShader = nullptr;
     LLGL::Shader* FragmentShader = nullptr;
 
-    LLGL::Buffer* VertexBuffer = nullptr;
-    LLGL::Buffer* IndexBuffer = nullptr;
+    ImGui_ImplLLGL_FrameResources Frames[FRAMES_IN_FLIGHT];
+    int CurrentFrame = -1; // Slot of the last RenderDrawData, -1 before the first
     LLGL::Buffer* ConstantBuffer = nullptr;
-    int VertexBufferSize = 0;
-    int IndexBufferSize = 0;
+
+    // Staging copies for backends that can't map the geometry buffers; they keep their capacity across frames
+    std::vector<ImDrawVert> VertexStaging;
+    std::vector<ImDrawIdx> IndexStaging;
 
     LLGL::Texture* FontTexture = nullptr;
     LLGL::Sampler* FontSampler = nullptr;
 
+    // State last set on the command buffer, to skip redundant binds. Forgotten by SetupRenderState and after
+    // user callbacks, which may change it behind the backend's back.
+    LLGL::Texture* BoundTexture = nullptr;
+    bool SamplerBound = false;
+    bool ScissorBound = false;
+    LLGL::Scissor BoundScissor;
+
+    ImGui_ImplLLGL_Stats Stats;
+
     // Keep shader data alive (required for some backends)
     std::variant<std::string, std::vector<uint32_t>> VertexShaderData;
     std::variant<std::string, std::vector<uint32_t>> FragmentShaderData;
@@ -45,9 +87,9 @@ struct ImGui_ImplLLGL_VertexConstantBuffer {
     float MVP[4][4];
 };
 
-// Buffer growth margins to avoid frequent reallocations
-static constexpr int VERTEX_BUFFER_GROW_MARGIN = 5000;
-static constexpr int INDEX_BUFFER_GROW_MARGIN = 10000;
+// Initial geometry buffer capacities in elements. Capacities double from here and never shrink below them.
+static constexpr int VERTEX_BUFFER_MIN_CAPACITY = 8192;
+static constexpr int INDEX_BUFFER_MIN_CAPACITY = 16384;
 
 // Backend data stored in io.BackendRendererUserData
 static ImGui_ImplLLGL_Data* ImGui_ImplLLGL_GetBackendData() {
@@ -86,16 +128,22 @@ static const char* g_FragmentShaderGLSL = R"(
 layout(location = 0) in vec2 vUV;
 layout(location = 1) in vec4 vColor;
 
-layout(binding = 1) uniform sampler2D colorMap;
+layout(binding = 1) uniform texture2D colorMap;
+layout(binding = 2) uniform sampler samplerState;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vColor * texture(colorMap, vUV);
+    outColor = vColor * texture(sampler2D(colorMap, samplerState), vUV);
 }
 )";
 
-static LLGL::VertexFormat ImGui_ImplLLGL_GetVertexFormat() {
+void ImGui_ImplLLGL_GetShaderSources(const char** vertex_shader, const char** fragment_shader) {
+    *vertex_shader = g_VertexShaderGLSL;
+    *fragment_shader = g_FragmentShaderGLSL;
+}
+
+LLGL::VertexFormat ImGui_ImplLLGL_GetVertexFormat() {
     LLGL::VertexFormat vertexFormat;
     vertexFormat.AppendAttribute({ "aPos", LLGL::Format::RG32Float });
     vertexFormat.AppendAttribute({ "aUV", LLGL::Format::RG32Float });
@@ -130,24 +178,24 @@ static bool ImGui_ImplLLGL_CreateShaders() {
     // Create shaders
     bd->VertexShader = rs->CreateShader(vertShaderDesc);
     if (bd->VertexShader == nullptr) {
-        LLGL::Log::Errorf("ImGui LLGL: Failed to create vertex shader\n");
+        log_error(LogCategory::Render, "ImGui LLGL: Failed to create vertex shader\n");
         return false;
     }
     if (const LLGL::Report* report = bd->VertexShader->GetReport()) {
         if (report->HasErrors()) {
-            LLGL::Log::Errorf("ImGui LLGL: Vertex shader error: %s\n", report->GetText());
+            log_error(LogCategory::Render, "ImGui LLGL: Vertex shader error: %s\n", report->GetText());
             return false;
         }
     }
 
     bd->FragmentShader = rs->CreateShader(fragShaderDesc);
     if (bd->FragmentShader == nullptr) {
-        LLGL::Log::Errorf("ImGui LLGL: Failed to create fragment shader\n");
+        log_error(LogCategory::Render, "ImGui LLGL: Failed to create fragment shader\n");
         return false;
     }
     if (const LLGL::Report* report = bd->FragmentShader->GetReport()) {
         if (report->HasErrors()) {
-            LLGL::Log::Errorf("ImGui LLGL: Fragment shader error: %s\n", report->GetText());
+            log_error(LogCategory::Render, "ImGui LLGL: Fragment shader error: %s\n", report->GetText());
             return false;
         }
     }
@@ -168,21 +216,10 @@ bool ImGui_ImplLLGL_CreateDeviceObjects() {
         return false;
     }
 
-    // Create pipeline layout (same naming convention as main.cpp)
-    LLGL::PipelineLayoutDescriptor layoutDesc;
-    {
-        layoutDesc.bindings = {
-            LLGL::BindingDescriptor{ "Matrices", LLGL::ResourceType::Buffer, LLGL::BindFlags::ConstantBuffer,
-                                     LLGL::StageFlags::VertexStage, 0 },
-            LLGL::BindingDescriptor{ "colorMap", LLGL::ResourceType::Texture, LLGL::BindFlags::Sampled,
-                                     LLGL::StageFlags::FragmentStage, 1 },
-            LLGL::BindingDescriptor{ "samplerState", LLGL::ResourceType::Sampler, 0, LLGL::StageFlags::FragmentStage,
-                                     2 },
-        };
-        layoutDesc.combinedTextureSamplers = { LLGL::CombinedTextureSamplerDescriptor{ "colorMap", "colorMap",
-                                                                                       "samplerState", 3 } };
-    }
-    bd->PipelineLayout = rs->CreatePipelineLayout(layoutDesc);
+    // Create pipeline layout from the reflection of the shaders (Matrices, colorMap, samplerState)
+    const std::shared_ptr<const ShaderReflection> reflection =
+        reflect_shader_sources(g_VertexShaderGLSL, g_FragmentShaderGLSL);
+    bd->PipelineLayout = rs->CreatePipelineLayout(make_pipeline_layout_desc(*reflection));
 
     // Setup vertex format
     LLGL::VertexFormat vertexFormat = ImGui_ImplLLGL_GetVertexFormat();
@@ -210,15 +247,15 @@ bool ImGui_ImplLLGL_CreateDeviceObjects() {
     pipelineDesc.depth.testEnabled = false;
     pipelineDesc.depth.writeEnabled = false;
 
-    bd->Pipeline = rs->CreatePipelineState(pipelineDesc);
+    bd->Pipeline = rs->CreatePipelineState(pipelineDesc, bd->PipelineCache);
     if (bd->Pipeline == nullptr) {
-        LLGL::Log::Errorf("ImGui LLGL: Failed to create pipeline\n");
+        log_error(LogCategory::Render, "ImGui LLGL: Failed to create pipeline\n");
         return false;
     }
 
     if (const LLGL::Report* report = bd->Pipeline->GetReport()) {
         if (report->HasErrors()) {
-            LLGL::Log::Errorf("ImGui LLGL: Pipeline error: %s\n", report->GetText());
+            log_error(LogCategory::Render, "ImGui LLGL: Pipeline error: %s\n", report->GetText());
             return false;
         }
     }
@@ -269,12 +306,19 @@ void ImGui_ImplLLGL_DestroyDeviceObjects() {
     if (bd->FragmentShader) {
         rs->Release(*bd->FragmentShader);
     }
-    if (bd->VertexBuffer) {
-        rs->Release(*bd->VertexBuffer);
-    }
-    if (bd->IndexBuffer) {
-        rs->Release(*bd->IndexBuffer);
+    for (ImGui_ImplLLGL_FrameResources& frame : bd->Frames) {
+        if (frame.VertexBuffer) {
+            rs->Release(*frame.VertexBuffer);
+        }
+        if (frame.IndexBuffer) {
+            rs->Release(*frame.IndexBuffer);
+        }
+        if (frame.Fence) {
+            rs->Release(*frame.Fence);
+        }
+        frame = ImGui_ImplLLGL_FrameResources();
     }
+    bd->CurrentFrame = -1;
     if (bd->ConstantBuffer) {
         rs->Release(*bd->ConstantBuffer);
     }
@@ -286,12 +330,8 @@ void ImGui_ImplLLGL_DestroyDeviceObjects() {
     bd->PipelineLayout = nullptr;
     bd->VertexShader = nullptr;
     bd->FragmentShader = nullptr;
-    bd->VertexBuffer = nullptr;
-    bd->IndexBuffer = nullptr;
     bd->ConstantBuffer = nullptr;
     bd->FontSampler = nullptr;
-    bd->VertexBufferSize = 0;
-    bd->IndexBufferSize = 0;
 }
 
 bool ImGui_ImplLLGL_CreateFontsTexture() {
@@ -353,6 +393,8 @@ bool ImGui_ImplLLGL_Init(ImGui_ImplLLGL_InitInfo* info) {
     bd->RenderSystem = info->RenderSystem;
     bd->SwapChain = info->SwapChain;
     bd->CommandBuffer = info->CommandBuffer;
+    bd->PipelineCache = info->PipelineCache;
+    bd->ShrinkAfterFrames = info->ShrinkAfterFrames;
 
     return true;
 }
@@ -379,6 +421,46 @@ void ImGui_ImplLLGL_NewFrame() {
     }
 }
 
+ImGui_ImplLLGL_Stats ImGui_ImplLLGL_GetStats() {
+    ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
+    if (!bd) {
+        return ImGui_ImplLLGL_Stats();
+    }
+    ImGui_ImplLLGL_Stats stats = bd->Stats;
+    stats.FramesInFlight = FRAMES_IN_FLIGHT;
+    for (const ImGui_ImplLLGL_FrameResources& frame : bd->Frames) {
+        stats.BufferBytes += static_cast<uint64_t>(frame.VertexBufferSize) * sizeof(ImDrawVert) +
+                             static_cast<uint64_t>(frame.IndexBufferSize) * sizeof(ImDrawIdx);
+    }
+    return stats;
+}
+
+// Capacity a buffer of `capacity` elements should have for `required` ones. Growth doubles, so a steadily
+// growing UI reallocates a logarithmic number of times. With shrinking enabled, a buffer whose use stays at or
+// below a quarter for shrinkAfterFrames frames halves; the gap between the two thresholds keeps a UI that
+// hovers around one size from alternating.
+static int ImGui_ImplLLGL_BufferCapacity(int capacity, int required, int minimum, int shrinkAfterFrames,
+                                         int& lowWaterFrames) {
+    if (capacity < required || capacity < minimum) {
+        int grown = std::max(capacity, minimum);
+        while (grown < required) {
+            grown *= 2;
+        }
+        lowWaterFrames = 0;
+        return grown;
+    }
+    if (shrinkAfterFrames <= 0 || capacity <= minimum || required > capacity / 4) {
+        lowWaterFrames = 0;
+        return capacity;
+    }
+    // Every ring slot sees one frame in FRAMES_IN_FLIGHT
+    if (++lowWaterFrames * FRAMES_IN_FLIGHT < shrinkAfterFrames) {
+        return capacity;
+    }
+    lowWaterFrames = 0;
+    return std::max(capacity / 2, minimum);
+}
+
 static void ImGui_ImplLLGL_CreateOrResizeBuffer(LLGL::Buffer*& buffer, int& currentSize, int requiredSize,
                                                 size_t elementSize, long bindFlags,
                                                 LLGL::Format format = LLGL::Format::Undefined,
@@ -386,8 +468,14 @@ static void ImGui_ImplLLGL_CreateOrResizeBuffer(LLGL::Buffer*& buffer, int& curr
     ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
     LLGL::RenderSystem* rs = bd->RenderSystem;
 
+    // The slot's fence has signaled, so the GPU is done with the old buffer
     if (buffer) {
         rs->Release(*buffer);
+        if (requiredSize > currentSize) {
+            bd->Stats.BufferGrows++;
+        } else {
+            bd->Stats.BufferShrinks++;
+        }
     }
 
     currentSize = requiredSize;
@@ -409,6 +497,46 @@ static void ImGui_ImplLLGL_CreateOrResizeBuffer(LLGL::Buffer*& buffer, int& curr
     buffer = rs->CreateBuffer(bufDesc);
 }
 
+static void ImGui_ImplLLGL_InvalidateBoundState() {
+    ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
+    bd->BoundTexture = nullptr;
+    bd->SamplerBound = false;
+    bd->ScissorBound = false;
+}
+
+static bool ImGui_ImplLLGL_SameScissor(const LLGL::Scissor& a, const LLGL::Scissor& b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+// Issues the pending draw, binding only the state that differs from what is already set
+static void ImGui_ImplLLGL_FlushDraw(LLGL::CommandBuffer* cmd, ImGui_ImplLLGL_PendingDraw& draw) {
+    if (draw.IndexCount == 0) {
+        return;
+    }
+    ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
+    if (!bd->ScissorBound || !ImGui_ImplLLGL_SameScissor(bd->BoundScissor, draw.Scissor)) {
+        cmd->SetScissor(draw.Scissor);
+        bd->BoundScissor = draw.Scissor;
+        bd->ScissorBound = true;
+        bd->Stats.Binds++;
+    }
+    if (draw.Texture) {
+        if (bd->BoundTexture != draw.Texture) {
+            cmd->SetResource(1, *draw.Texture);
+            bd->BoundTexture = draw.Texture;
+            bd->Stats.Binds++;
+        }
+        if (!bd->SamplerBound) {
+            cmd->SetResource(2, *bd->FontSampler);
+            bd->SamplerBound = true;
+            bd->Stats.Binds++;
+        }
+    }
+    cmd->DrawIndexed(draw.IndexCount, draw.FirstIndex, draw.VertexOffset);
+    bd->Stats.DrawCalls++;
+    draw.IndexCount = 0;
+}
+
 static void ImGui_ImplLLGL_SetupRenderState(ImDrawData* draw_data, LLGL::CommandBuffer* cmd, int fb_width,
                                             int fb_height) {
     ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
@@ -445,11 +573,89 @@ static void ImGui_ImplLLGL_SetupRenderState(ImDrawData* draw_data, LLGL::Command
     cmd->SetPipelineState(*bd->Pipeline);
 
     // Bind buffers
-    cmd->SetVertexBuffer(*bd->VertexBuffer);
-    cmd->SetIndexBuffer(*bd->IndexBuffer);
+    const ImGui_ImplLLGL_FrameResources& frame = bd->Frames[bd->CurrentFrame];
+    cmd->SetVertexBuffer(*frame.VertexBuffer);
+    cmd->SetIndexBuffer(*frame.IndexBuffer);
 
     // Bind constant buffer
     cmd->SetResource(0, *bd->ConstantBuffer);
+
+    ImGui_ImplLLGL_InvalidateBoundState();
+}
+
+void ImGui_ImplLLGL_GatherDrawData(const ImDrawData* draw_data, ImDrawVert* vtx_dst, ImDrawIdx* idx_dst) {
+    for (int n = 0; n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* drawList = draw_data->CmdLists[n];
+        std::memcpy(vtx_dst, drawList->VtxBuffer.Data, drawList->VtxBuffer.Size * sizeof(ImDrawVert));
+        std::memcpy(idx_dst, drawList->IdxBuffer.Data, drawList->IdxBuffer.Size * sizeof(ImDrawIdx));
+        vtx_dst += drawList->VtxBuffer.Size;
+        idx_dst += drawList->IdxBuffer.Size;
+    }
+}
+
+// Moves on to the next ring slot. The previous frame has been submitted by now, so a fence submitted here
+// signals once the GPU is done with its buffers; the new slot's fence is waited for if it hasn't signaled yet.
+static ImGui_ImplLLGL_FrameResources& ImGui_ImplLLGL_BeginFrameResources() {
+    ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
+    LLGL::RenderSystem* rs = bd->RenderSystem;
+    LLGL::CommandQueue* queue = rs->GetCommandQueue();
+
+    if (bd->CurrentFrame >= 0) {
+        ImGui_ImplLLGL_FrameResources& previous = bd->Frames[bd->CurrentFrame];
+        if (previous.Fence == nullptr) {
+            previous.Fence = rs->CreateFence();
+        }
+        if (previous.Fence) {
+            queue->Submit(*previous.Fence);
+            previous.FenceSubmitted = true;
+        }
+    }
+
+    bd->CurrentFrame = (bd->CurrentFrame + 1) % FRAMES_IN_FLIGHT;
+    ImGui_ImplLLGL_FrameResources& frame = bd->Frames[bd->CurrentFrame];
+    if (frame.FenceSubmitted) {
+        if (!queue->WaitFence(*frame.Fence, 0)) {
+            const auto waitStart = std::chrono::steady_clock::now();
+            queue->WaitFence(*frame.Fence, ~0ull);
+            bd->Stats.FenceWaits++;
+            bd->Stats.FenceWaitMs +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+        }
+        frame.FenceSubmitted = false;
+    }
+    bd->Stats.Frames++;
+    return frame;
+}
+
+// Gathers the draw lists straight into the mapped vertex/index buffers: one copy and no allocations per frame.
+// The previous contents are discarded, so the driver doesn't have to preserve them while the GPU may still read.
+static void ImGui_ImplLLGL_UploadDrawData(const ImDrawData* draw_data, ImGui_ImplLLGL_FrameResources& frame) {
+    ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
+    LLGL::RenderSystem* rs = bd->RenderSystem;
+    if (draw_data->TotalVtxCount == 0 || draw_data->TotalIdxCount == 0) {
+        return;
+    }
+
+    const uint64_t vtxSize = static_cast<uint64_t>(draw_data->TotalVtxCount) * sizeof(ImDrawVert);
+    const uint64_t idxSize = static_cast<uint64_t>(draw_data->TotalIdxCount) * sizeof(ImDrawIdx);
+    void* vtxDst = rs->MapBuffer(*frame.VertexBuffer, LLGL::CPUAccess::WriteDiscard, 0, vtxSize);
+    void* idxDst = vtxDst ? rs->MapBuffer(*frame.IndexBuffer, LLGL::CPUAccess::WriteDiscard, 0, idxSize) : nullptr;
+    if (vtxDst && idxDst) {
+        ImGui_ImplLLGL_GatherDrawData(draw_data, static_cast<ImDrawVert*>(vtxDst), static_cast<ImDrawIdx*>(idxDst));
+        rs->UnmapBuffer(*frame.IndexBuffer);
+        rs->UnmapBuffer(*frame.VertexBuffer);
+        return;
+    }
+    if (vtxDst) {
+        rs->UnmapBuffer(*frame.VertexBuffer);
+    }
+
+    // Mapping not supported: gather into the staging copies and write them
+    bd->VertexStaging.resize(draw_data->TotalVtxCount);
+    bd->IndexStaging.resize(draw_data->TotalIdxCount);
+    ImGui_ImplLLGL_GatherDrawData(draw_data, bd->VertexStaging.data(), bd->IndexStaging.data());
+    rs->WriteBuffer(*frame.VertexBuffer, 0, bd->VertexStaging.data(), vtxSize);
+    rs->WriteBuffer(*frame.IndexBuffer, 0, bd->IndexStaging.data(), idxSize);
 }
 
 void ImGui_ImplLLGL_RenderDrawData(ImDrawData* draw_data) {
@@ -461,51 +667,46 @@ void ImGui_ImplLLGL_RenderDrawData(ImDrawData* draw_data) {
     }
 
     ImGui_ImplLLGL_Data* bd = ImGui_ImplLLGL_GetBackendData();
-    LLGL::RenderSystem* rs = bd->RenderSystem;
     LLGL::CommandBuffer* cmd = bd->CommandBuffer;
 
+    ImGui_ImplLLGL_FrameResources& frame = ImGui_ImplLLGL_BeginFrameResources();
+
     // Create or resize vertex/index buffers if needed
-    if (bd->VertexBuffer == nullptr || bd->VertexBufferSize < draw_data->TotalVtxCount) {
+    const int vtxCapacity =
+        ImGui_ImplLLGL_BufferCapacity(frame.VertexBufferSize, draw_data->TotalVtxCount, VERTEX_BUFFER_MIN_CAPACITY,
+                                      bd->ShrinkAfterFrames, frame.VertexLowWaterFrames);
+    if (frame.VertexBuffer == nullptr || frame.VertexBufferSize != vtxCapacity) {
         LLGL::VertexFormat vertexFormat = ImGui_ImplLLGL_GetVertexFormat();
-        ImGui_ImplLLGL_CreateOrResizeBuffer(bd->VertexBuffer, bd->VertexBufferSize,
-                                            draw_data->TotalVtxCount + VERTEX_BUFFER_GROW_MARGIN, sizeof(ImDrawVert),
-                                            LLGL::BindFlags::VertexBuffer, LLGL::Format::Undefined, &vertexFormat);
+        ImGui_ImplLLGL_CreateOrResizeBuffer(frame.VertexBuffer, frame.VertexBufferSize, vtxCapacity,
+                                            sizeof(ImDrawVert), LLGL::BindFlags::VertexBuffer,
+                                            LLGL::Format::Undefined, &vertexFormat);
     }
 
-    if (bd->IndexBuffer == nullptr || bd->IndexBufferSize < draw_data->TotalIdxCount) {
+    const int idxCapacity =
+        ImGui_ImplLLGL_BufferCapacity(frame.IndexBufferSize, draw_data->TotalIdxCount, INDEX_BUFFER_MIN_CAPACITY,
+                                      bd->ShrinkAfterFrames, frame.IndexLowWaterFrames);
+    if (frame.IndexBuffer == nullptr || frame.IndexBufferSize != idxCapacity) {
         LLGL::Format idxFormat = sizeof(ImDrawIdx) == 2 ? LLGL::Format::R16UInt : LLGL::Format::R32UInt;
-        ImGui_ImplLLGL_CreateOrResizeBuffer(bd->IndexBuffer, bd->IndexBufferSize,
-                                            draw_data->TotalIdxCount + INDEX_BUFFER_GROW_MARGIN, sizeof(ImDrawIdx),
-                                            LLGL::BindFlags::IndexBuffer, idxFormat);
+        ImGui_ImplLLGL_CreateOrResizeBuffer(frame.IndexBuffer, frame.IndexBufferSize, idxCapacity,
+                                            sizeof(ImDrawIdx), LLGL::BindFlags::IndexBuffer, idxFormat);
     }
 
     // Upload vertex/index data
-    {
-        std::vector<ImDrawVert> vtxData;
-        std::vector<ImDrawIdx> idxData;
-        vtxData.reserve(draw_data->TotalVtxCount);
-        idxData.reserve(draw_data->TotalIdxCount);
-
-        for (int n = 0; n < draw_data->CmdListsCount; n++) {
-            const ImDrawList* drawList = draw_data->CmdLists[n];
-            vtxData.insert(vtxData.end(), drawList->VtxBuffer.Data,
-                           drawList->VtxBuffer.Data + drawList->VtxBuffer.Size);
-            idxData.insert(idxData.end(), drawList->IdxBuffer.Data,
-                           drawList->IdxBuffer.Data + drawList->IdxBuffer.Size);
-        }
-
-        rs->WriteBuffer(*bd->VertexBuffer, 0, vtxData.data(), vtxData.size() * sizeof(ImDrawVert));
-        rs->WriteBuffer(*bd->IndexBuffer, 0, idxData.data(), idxData.size() * sizeof(ImDrawIdx));
-    }
+    ImGui_ImplLLGL_UploadDrawData(draw_data, frame);
 
     // Setup render state
     ImGui_ImplLLGL_SetupRenderState(draw_data, cmd, fb_width, fb_height);
+    bd->Stats.DrawCommands = 0;
+    bd->Stats.DrawCalls = 0;
+    bd->Stats.Binds = 0;
+    int bindsRequested = 0; // What binding everything for every command would take
 
     // Will project scissor/clipping rectangles into framebuffer space
     ImVec2 clip_off = draw_data->DisplayPos;
     ImVec2 clip_scale = draw_data->FramebufferScale;
 
     // Render command lists
+    ImGui_ImplLLGL_PendingDraw pending;
     int global_vtx_offset = 0;
     int global_idx_offset = 0;
     for (int n = 0; n < draw_data->CmdListsCount; n++) {
@@ -514,10 +715,12 @@ void ImGui_ImplLLGL_RenderDrawData(ImDrawData* draw_data) {
             const ImDrawCmd* pcmd = &drawList->CmdBuffer[cmd_i];
             if (pcmd->UserCallback != nullptr) {
                 // User callback, registered via ImDrawList::AddCallback()
+                ImGui_ImplLLGL_FlushDraw(cmd, pending);
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState) {
                     ImGui_ImplLLGL_SetupRenderState(draw_data, cmd, fb_width, fb_height);
                 } else {
                     pcmd->UserCallback(drawList, pcmd);
+                    ImGui_ImplLLGL_InvalidateBoundState();
                 }
             } else {
                 // Project scissor/clipping rectangles into framebuffer space
@@ -529,29 +732,37 @@ void ImGui_ImplLLGL_RenderDrawData(ImDrawData* draw_data) {
                     continue;
                 }
 
-                // Apply scissor
                 LLGL::Scissor scissor;
                 scissor.x = (int) clip_min.x;
                 scissor.y = (int) clip_min.y;
                 scissor.width = (int) (clip_max.x - clip_min.x);
                 scissor.height = (int) (clip_max.y - clip_min.y);
-                cmd->SetScissor(scissor);
-
-                // Bind texture
                 LLGL::Texture* texture = (LLGL::Texture*) pcmd->GetTexID();
-                if (texture) {
-                    cmd->SetResource(1, *texture);
-                    cmd->SetResource(2, *bd->FontSampler);
+                const int vertexOffset = global_vtx_offset + (int) pcmd->VtxOffset;
+                const unsigned int firstIndex = global_idx_offset + pcmd->IdxOffset;
+                bd->Stats.DrawCommands++;
+                bindsRequested += texture ? 3 : 1;
+
+                // Extend the pending draw when this command continues it with the same state
+                if (pending.IndexCount > 0 && pending.Texture == texture && pending.VertexOffset == vertexOffset &&
+                    pending.FirstIndex + pending.IndexCount == firstIndex &&
+                    ImGui_ImplLLGL_SameScissor(pending.Scissor, scissor)) {
+                    pending.IndexCount += pcmd->ElemCount;
+                    continue;
                 }
-
-                // Draw
-                cmd->DrawIndexed(pcmd->ElemCount, global_idx_offset + pcmd->IdxOffset,
-                                 global_vtx_offset + pcmd->VtxOffset);
+                ImGui_ImplLLGL_FlushDraw(cmd, pending);
+                pending.Texture = texture;
+                pending.Scissor = scissor;
+                pending.VertexOffset = vertexOffset;
+                pending.FirstIndex = firstIndex;
+                pending.IndexCount = pcmd->ElemCount;
             }
         }
         global_idx_offset += drawList->IdxBuffer.Size;
         global_vtx_offset += drawList->VtxBuffer.Size;
     }
+    ImGui_ImplLLGL_FlushDraw(cmd, pending);
+    bd->Stats.BindsAvoided = bindsRequested - bd->Stats.Binds;
 }
 
 #endif // #ifndef IMGUI_DISABLE
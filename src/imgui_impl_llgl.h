@@ -12,11 +12,31 @@
 #ifndef IMGUI_DISABLE
 
 #include <LLGL/LLGL.h>
+#include <LLGL/Utils/VertexFormat.h>
 
 struct ImGui_ImplLLGL_InitInfo {
     LLGL::RenderSystem* RenderSystem = nullptr;
     LLGL::SwapChain* SwapChain = nullptr;
     LLGL::CommandBuffer* CommandBuffer = nullptr;
+    LLGL::PipelineCache* PipelineCache = nullptr; // Optional, shared with the application's pipelines
+    int ShrinkAfterFrames = 0; // Halve geometry buffers used at most a quarter for this many frames; 0 = never
+};
+
+// Geometry upload statistics since Init
+struct ImGui_ImplLLGL_Stats {
+    int FramesInFlight = 0;     // Vertex/index buffer pairs in the ring
+    uint64_t Frames = 0;        // RenderDrawData calls
+    uint64_t FenceWaits = 0;    // Frames whose ring slot was still in use by the GPU
+    double FenceWaitMs = 0.0;   // CPU time blocked in those waits
+    uint64_t BufferGrows = 0;   // Geometry buffers recreated larger (first creations not counted)
+    uint64_t BufferShrinks = 0; // Geometry buffers recreated smaller after a low-water period
+    uint64_t BufferBytes = 0;   // Current capacity of the whole ring
+
+    // Last frame
+    int DrawCommands = 0; // ImDrawCmds drawn, after clipping
+    int DrawCalls = 0;    // DrawIndexed calls, adjacent commands with the same state merged
+    int Binds = 0;        // Scissor, texture and sampler binds issued
+    int BindsAvoided = 0; // Binds skipped because the state was already set or the command was merged
 };
 
 // Backend API
@@ -24,6 +44,15 @@ IMGUI_IMPL_API bool ImGui_ImplLLGL_Init(ImGui_ImplLLGL_InitInfo* info);
 IMGUI_IMPL_API void ImGui_ImplLLGL_Shutdown();
 IMGUI_IMPL_API void ImGui_ImplLLGL_NewFrame();
 IMGUI_IMPL_API void ImGui_ImplLLGL_RenderDrawData(ImDrawData* draw_data);
+IMGUI_IMPL_API ImGui_ImplLLGL_Stats ImGui_ImplLLGL_GetStats();
+
+// Copies the vertices/indices of all draw lists back to back into vtx_dst/idx_dst,
+// which must hold draw_data->TotalVtxCount/TotalIdxCount elements (RenderDrawData passes mapped buffer memory)
+IMGUI_IMPL_API void ImGui_ImplLLGL_GatherDrawData(const ImDrawData* draw_data, ImDrawVert* vtx_dst, ImDrawIdx* idx_dst);
+
+// GLSL 450 sources and vertex format of the backend's shaders, for build-time translation
+IMGUI_IMPL_API void ImGui_ImplLLGL_GetShaderSources(const char** vertex_shader, const char** fragment_shader);
+IMGUI_IMPL_API LLGL::VertexFormat ImGui_ImplLLGL_GetVertexFormat();
 
 // (Optional) Called by Init/NewFrame/Shutdown
 IMGUI_IMPL_API bool ImGui_ImplLLGL_CreateFontsTexture();
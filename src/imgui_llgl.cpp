@@ -11,6 +11,7 @@
 
 #include "sdl_llgl.h"
 #include "imgui_llgl.h"
+#include "pipeline_cache.h"
 
 void InitImGui(SDLSurface& wnd, LLGL::RenderSystemPtr& renderer, LLGL::SwapChain* swapChain,
                LLGL::CommandBuffer* cmdBuffer) {
@@ -55,6 +56,8 @@ void InitImGui(SDLSurface& wnd, LLGL::RenderSystemPtr& renderer, LLGL::SwapChain
     initInfo.RenderSystem = renderer.get();
     initInfo.SwapChain = swapChain;
     initInfo.CommandBuffer = cmdBuffer;
+    initInfo.PipelineCache = shared_pipeline_cache();
+    initInfo.ShrinkAfterFrames = 600; // About 10 s at 60 Hz
     ImGui_ImplLLGL_Init(&initInfo);
 }
 
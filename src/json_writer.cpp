@@ -0,0 +1,139 @@
+#include "json_writer.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+void JsonWriter::separate() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (!firstInScope_.empty()) {
+        if (!firstInScope_.back()) {
+            out_ += ',';
+        }
+        firstInScope_.back() = false;
+    }
+}
+
+void JsonWriter::writeEscaped(const std::string& text) {
+    out_ += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':
+                out_ += "\\\"";
+                break;
+            case '\\':
+                out_ += "\\\\";
+                break;
+            case '\n':
+                out_ += "\\n";
+                break;
+            case '\r':
+                out_ += "\\r";
+                break;
+            case '\t':
+                out_ += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                    out_ += escaped;
+                } else {
+                    out_ += c;
+                }
+                break;
+        }
+    }
+    out_ += '"';
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out_ += '{';
+    firstInScope_.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    firstInScope_.pop_back();
+    out_ += '}';
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out_ += '[';
+    firstInScope_.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    firstInScope_.pop_back();
+    out_ += ']';
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& name) {
+    separate();
+    writeEscaped(name);
+    out_ += ':';
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& text) {
+    separate();
+    writeEscaped(text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* text) {
+    return value(std::string(text ? text : ""));
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    separate();
+    if (!std::isfinite(number)) {
+        out_ += "null";
+        return *this;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", number);
+    out_ += buffer;
+    return *this;
+}
+
+JsonWriter& JsonWriter::valueInt(int64_t number) {
+    separate();
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%" PRId64, number);
+    out_ += buffer;
+    return *this;
+}
+
+JsonWriter& JsonWriter::valueUInt(uint64_t number) {
+    separate();
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%" PRIu64, number);
+    out_ += buffer;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out_ += flag ? "true" : "false";
+    return *this;
+}
+
+bool JsonWriter::writeToFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << out_ << '\n';
+    return file.good();
+}
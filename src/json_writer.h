@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Minimal streaming JSON writer for reports, manifests and traces
+class JsonWriter {
+  public:
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& value(const std::string& text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(double number);
+    JsonWriter& value(bool flag);
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    JsonWriter& value(T number) {
+        if constexpr (std::is_signed_v<T>) {
+            return valueInt(static_cast<int64_t>(number));
+        } else {
+            return valueUInt(static_cast<uint64_t>(number));
+        }
+    }
+
+    template <typename T> JsonWriter& field(const std::string& name, const T& fieldValue) {
+        key(name);
+        return value(fieldValue);
+    }
+
+    const std::string& str() const {
+        return out_;
+    }
+    bool writeToFile(const std::string& path) const;
+
+  private:
+    JsonWriter& valueInt(int64_t number);
+    JsonWriter& valueUInt(uint64_t number);
+    void separate();
+    void writeEscaped(const std::string& text);
+
+    std::string out_;
+    std::vector<bool> firstInScope_;
+    bool afterKey_ = false;
+};
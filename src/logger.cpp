@@ -0,0 +1,391 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <LLGL/LLGL.h>
+
+#include "profiler.h"
+
+namespace {
+
+constexpr const char* LEVEL_NAMES[] = { "debug", "info", "warning", "error", "off" };
+constexpr const char* CATEGORY_NAMES[LOG_CATEGORY_COUNT] = { "app", "render", "model", "shader", "pipeline", "cache" };
+
+// Message, or file contents when path is set
+struct LogRecord {
+    LogLevel level = LogLevel::Info;
+    std::string text;
+    std::string path;
+};
+
+// Bounded multi-producer, single-consumer ring. Every slot carries a sequence number: a producer claims the
+// position with a CAS on the tail and publishes the record by advancing the slot's sequence, the consumer
+// frees the slot by advancing it by a full lap. Producers only wait (yield) when the ring is full.
+class LogQueue {
+  public:
+    LogQueue() : slots_(std::make_unique<Slot[]>(CAPACITY)) {
+        for (uint64_t i = 0; i < CAPACITY; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void push(LogRecord&& record) {
+        uint64_t position = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[position % CAPACITY];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.record = std::move(record);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return;
+                }
+            } else {
+                if (sequence < position) {
+                    std::this_thread::yield(); // Full, the logger thread is behind
+                }
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Logger thread only
+    bool pop(LogRecord& record) {
+        Slot& slot = slots_[head_ % CAPACITY];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false;
+        }
+        record = std::move(slot.record);
+        slot.sequence.store(head_ + CAPACITY, std::memory_order_release);
+        head_++;
+        return true;
+    }
+
+    // Positions claimed by producers so far, including records still being stored
+    uint64_t pushed() const {
+        return tail_.load(std::memory_order_acquire);
+    }
+    uint64_t popped() const {
+        return head_;
+    }
+
+  private:
+    static constexpr uint64_t CAPACITY = 1024;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{ 0 };
+        LogRecord record;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> tail_{ 0 };
+    alignas(64) uint64_t head_ = 0;
+};
+
+struct LoggerState {
+    LoggerState() {
+        for (auto& level : levels) {
+            level.store(LogLevel::Info, std::memory_order_relaxed);
+        }
+    }
+
+    std::array<std::atomic<LogLevel>, LOG_CATEGORY_COUNT> levels;
+    std::string dumpDirectory; // Empty: dumps go to the log
+
+    LogQueue queue;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> stopping{ false };
+    // submit() calls between their running check and the end of their push
+    std::atomic<uint32_t> producers{ 0 };
+    std::atomic<uint32_t> wake{ 0 };    // Bumped by every push, the logger thread sleeps on it
+    std::atomic<uint64_t> written{ 0 }; // Records written by the logger thread, flush_logger waits on it
+
+    std::mutex controlMutex; // start/stop
+    std::thread thread;
+    bool atExitRegistered = false;
+};
+
+LoggerState& state() {
+    static LoggerState instance;
+    return instance;
+}
+
+bool parseLevel(const std::string& text, LogLevel& level) {
+    for (uint32_t i = 0; i < std::size(LEVEL_NAMES); i++) {
+        if (text == LEVEL_NAMES[i]) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseCategory(const std::string& text, LogCategory& category) {
+    for (uint32_t i = 0; i < LOG_CATEGORY_COUNT; i++) {
+        if (text == CATEGORY_NAMES[i]) {
+            category = static_cast<LogCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void writeRecord(const LogRecord& record) {
+    if (!record.path.empty()) {
+        std::ofstream file(record.path, std::ios::binary | std::ios::trunc);
+        file.write(record.text.data(), static_cast<std::streamsize>(record.text.size()));
+        if (!file) {
+            LLGL::Log::Errorf("Failed to write %s\n", record.path.c_str());
+        }
+    } else if (record.level >= LogLevel::Warning) {
+        LLGL::Log::Errorf("%s", record.text.c_str());
+    } else {
+        LLGL::Log::Printf("%s", record.text.c_str());
+    }
+}
+
+void drainQueue(LoggerState& s) {
+    LogRecord record;
+    while (s.queue.pop(record)) {
+        writeRecord(record);
+    }
+    s.written.store(s.queue.popped(), std::memory_order_release);
+    s.written.notify_all();
+}
+
+void loggerLoop() {
+    PROFILE_THREAD_NAME("Logger");
+    LoggerState& s = state();
+    for (;;) {
+        // Loaded before draining: a push after the drain changes wake, so the wait below returns at once
+        const uint32_t wake = s.wake.load(std::memory_order_acquire);
+        const bool stopping = s.stopping.load(std::memory_order_acquire);
+        drainQueue(s);
+        if (stopping) {
+            return;
+        }
+        s.wake.wait(wake, std::memory_order_acquire);
+    }
+}
+
+void wakeLogger(LoggerState& s) {
+    s.wake.fetch_add(1, std::memory_order_release);
+    s.wake.notify_one();
+}
+
+void submit(LogRecord&& record) {
+    LoggerState& s = state();
+    // Counted before checking running (both seq_cst): stop_logger either sees this producer and waits for its
+    // push, or this producer sees the logger stopped and writes directly
+    s.producers.fetch_add(1);
+    if (!s.running.load()) {
+        s.producers.fetch_sub(1, std::memory_order_release);
+        writeRecord(record);
+        return;
+    }
+    const bool error = record.level == LogLevel::Error;
+    s.queue.push(std::move(record));
+    s.producers.fetch_sub(1, std::memory_order_release);
+    wakeLogger(s);
+    if (error) {
+        flush_logger();
+    }
+}
+
+std::string formatMessage(const char* format, va_list args) {
+    char buffer[512];
+    va_list copy;
+    va_copy(copy, args);
+    const int length = std::vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+    if (length < 0) {
+        return {};
+    }
+    if (static_cast<size_t>(length) < sizeof(buffer)) {
+        return std::string(buffer, static_cast<size_t>(length));
+    }
+    std::string text(static_cast<size_t>(length), '\0');
+    std::vsnprintf(text.data(), text.size() + 1, format, args);
+    return text;
+}
+
+void logFormatted(LogLevel level, LogCategory category, const char* format, va_list args) {
+    if (!log_enabled(level, category)) {
+        return;
+    }
+    LogRecord record;
+    record.level = level;
+    record.text = formatMessage(format, args);
+    submit(std::move(record));
+}
+
+} // anonymous namespace
+
+const char* log_level_name(LogLevel level) {
+    return LEVEL_NAMES[static_cast<uint32_t>(level)];
+}
+
+const char* log_category_name(LogCategory category) {
+    return CATEGORY_NAMES[static_cast<uint32_t>(category)];
+}
+
+bool parse_log_filter(const std::string& spec, LogFilter& filter) {
+    LogFilter parsed;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        const size_t end = std::min(spec.find(',', start), spec.size());
+        const std::string entry = spec.substr(start, end - start);
+        const size_t equals = entry.find('=');
+        LogLevel level = LogLevel::Info;
+        if (equals == std::string::npos) {
+            if (!parseLevel(entry, level)) {
+                return false;
+            }
+            parsed.levels.fill(level);
+        } else {
+            LogCategory category = LogCategory::App;
+            if (!parseCategory(entry.substr(0, equals), category) || !parseLevel(entry.substr(equals + 1), level)) {
+                return false;
+            }
+            parsed.levels[static_cast<uint32_t>(category)] = level;
+        }
+        start = end + 1;
+    }
+    filter = parsed;
+    return true;
+}
+
+void set_log_filter(const LogFilter& filter) {
+    for (uint32_t i = 0; i < LOG_CATEGORY_COUNT; i++) {
+        state().levels[i].store(filter.levels[i], std::memory_order_relaxed);
+    }
+}
+
+bool log_enabled(LogLevel level, LogCategory category) {
+    return level != LogLevel::Off &&
+           level >= state().levels[static_cast<uint32_t>(category)].load(std::memory_order_relaxed);
+}
+
+void set_log_dump_directory(const std::string& directory) {
+    std::error_code ec;
+    if (!directory.empty() && !std::filesystem::create_directories(directory, ec) && ec) {
+        LLGL::Log::Errorf("Failed to create dump directory %s: %s\n", directory.c_str(), ec.message().c_str());
+        return;
+    }
+    state().dumpDirectory = directory;
+}
+
+void start_logger() {
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.controlMutex);
+    if (s.running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!s.atExitRegistered) {
+        // Registered after state() is constructed, so it runs before the state is destroyed
+        std::atexit(stop_logger);
+        s.atExitRegistered = true;
+    }
+    s.stopping.store(false, std::memory_order_relaxed);
+    s.thread = std::thread(loggerLoop);
+    s.running.store(true, std::memory_order_release);
+}
+
+void flush_logger() {
+    LoggerState& s = state();
+    if (!s.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    const uint64_t target = s.queue.pushed();
+    wakeLogger(s);
+    uint64_t written = s.written.load(std::memory_order_acquire);
+    while (written < target) {
+        s.written.wait(written, std::memory_order_acquire);
+        written = s.written.load(std::memory_order_acquire);
+    }
+}
+
+void stop_logger() {
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.controlMutex);
+    if (!s.running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    s.running.store(false);
+    s.stopping.store(true, std::memory_order_release);
+    wakeLogger(s);
+    s.thread.join();
+    // Threads that saw the logger running just before it stopped may still be pushing. Keep draining until they
+    // are done, a push into a full ring waits for this.
+    while (s.producers.load() != 0) {
+        drainQueue(s);
+        std::this_thread::yield();
+    }
+    drainQueue(s);
+}
+
+void log_message(LogLevel level, LogCategory category, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logFormatted(level, category, format, args);
+    va_end(args);
+}
+
+void log_debug(LogCategory category, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logFormatted(LogLevel::Debug, category, format, args);
+    va_end(args);
+}
+
+void log_info(LogCategory category, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logFormatted(LogLevel::Info, category, format, args);
+    va_end(args);
+}
+
+void log_warning(LogCategory category, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logFormatted(LogLevel::Warning, category, format, args);
+    va_end(args);
+}
+
+void log_error(LogCategory category, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logFormatted(LogLevel::Error, category, format, args);
+    va_end(args);
+}
+
+bool dump_enabled(LogCategory category) {
+    return !state().dumpDirectory.empty() || log_enabled(LogLevel::Debug, category);
+}
+
+void log_dump(LogCategory category, const std::string& fileName, std::string contents, bool binary) {
+    const std::string& directory = state().dumpDirectory;
+    LogRecord record;
+    record.level = LogLevel::Debug;
+    if (!directory.empty()) {
+        record.path = (std::filesystem::path(directory) / fileName).string();
+        record.text = std::move(contents);
+    } else if (!log_enabled(LogLevel::Debug, category)) {
+        return;
+    } else if (binary) {
+        record.text = fileName + ": " + std::to_string(contents.size()) + " bytes\n";
+    } else {
+        record.text = fileName + ":\n" + std::move(contents) + "\n";
+    }
+    submit(std::move(record));
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Leveled, categorized logging.
+//
+// Messages below the threshold of their category are rejected before formatting. Accepted ones are formatted
+// on the calling thread into a record of a bounded lock-free queue; a background thread writes them through
+// LLGL::Log (and dump files to disk), so terminal output never blocks the caller. Before start_logger() and
+// after stop_logger() messages are written synchronously. Errors flush the queue, so they are visible even if
+// the process dies right after.
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOG_PRINTF_FORMAT(formatIndex, firstArg) __attribute__((format(printf, formatIndex, firstArg)))
+#else
+#define LOG_PRINTF_FORMAT(formatIndex, firstArg)
+#endif
+
+enum class LogLevel : uint8_t { Debug, Info, Warning, Error, Off };
+
+enum class LogCategory : uint8_t { App, Render, Model, Shader, Pipeline, Cache };
+constexpr uint32_t LOG_CATEGORY_COUNT = 6;
+
+const char* log_level_name(LogLevel level);
+const char* log_category_name(LogCategory category);
+
+// Lowest level logged per category
+struct LogFilter {
+    std::array<LogLevel, LOG_CATEGORY_COUNT> levels;
+
+    LogFilter() {
+        levels.fill(LogLevel::Info);
+    }
+};
+
+// Comma-separated thresholds on top of the default (info): a bare level applies to every category,
+// <category>=<level> to one, e.g. "warning,shader=debug,model=off". Levels: debug, info, warning, error, off.
+// Later entries win.
+bool parse_log_filter(const std::string& spec, LogFilter& filter);
+
+void set_log_filter(const LogFilter& filter);
+bool log_enabled(LogLevel level, LogCategory category);
+
+// Dumps (e.g. translated shaders) go to files in this directory instead of the log; empty: log them at debug
+// level. Set before anything is logged.
+void set_log_dump_directory(const std::string& directory);
+
+void start_logger();
+// Blocks until every message logged so far is written
+void flush_logger();
+// Writes what is still queued and joins the thread. Also runs at exit.
+void stop_logger();
+
+void log_message(LogLevel level, LogCategory category, const char* format, ...) LOG_PRINTF_FORMAT(3, 4);
+void log_debug(LogCategory category, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+void log_info(LogCategory category, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+void log_warning(LogCategory category, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+void log_error(LogCategory category, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+
+// Large pre-formatted output, moved into the queue without a copy. Callers should check dump_enabled() first,
+// so nothing is built while dumps are off (the default). Binary contents are only written to dump files; the
+// log just mentions their size.
+bool dump_enabled(LogCategory category);
+void log_dump(LogCategory category, const std::string& fileName, std::string contents, bool binary = false);
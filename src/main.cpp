@@ -1,6 +1,9 @@
 // LLGL/SDL Test
 // 2/16/25
 
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
 #include <memory>
 #include <variant>
 
@@ -15,6 +18,7 @@
 #include <SDL2/SDL.h>
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
+#include "imgui_impl_llgl.h"
 
 #include "sdl_llgl.h"
 #include "imgui_llgl.h"
@@ -27,7 +31,24 @@
 #include "math_types.h"
 #include "camera.h"
 #include "model_loader.h"
+#include "model_renderer.h"
 #include "primitives.h"
+#include "app_options.h"
+#include "headless.h"
+#include "batch_renderer.h"
+#include "benchmark.h"
+#include "camera_path.h"
+#include "embedded_shaders.h"
+#include "gpu_timer.h"
+#include "logger.h"
+#include "occlusion_culler.h"
+#include "pipeline_cache.h"
+#include "pipeline_registry.h"
+#include "profiler.h"
+#include "shader_cache.h"
+#include "shader_hot_reload.h"
+#include "shader_precompile.h"
+#include "stress_test.h"
 
 LLGL::RenderSystemPtr llgl_renderer;
 
@@ -35,77 +56,31 @@ void print_info(LLGL::RenderSystemPtr& llgl_render, LLGL::SwapChain* llgl_swapCh
     // Print renderer information
     const auto& info = llgl_render->GetRendererInfo();
 
-    LLGL::Log::Printf("Renderer:             %s\n"
-                      "Device:               %s\n"
-                      "Vendor:               %s\n"
-                      "Shading Language:     %s\n"
-                      "Swap Chain Format:    %s\n"
-                      "Depth/Stencil Format: %s\n"
-                      "Resolution:           %u x %u\n"
-                      "Samples:              %u\n",
-                      info.rendererName.c_str(), info.deviceName.c_str(), info.vendorName.c_str(),
-                      info.shadingLanguageName.c_str(), LLGL::ToString(llgl_swapChain->GetColorFormat()),
-                      LLGL::ToString(llgl_swapChain->GetDepthStencilFormat()), llgl_swapChain->GetResolution().width,
-                      llgl_swapChain->GetResolution().height, llgl_swapChain->GetSamples());
+    log_info(LogCategory::App, "Renderer:             %s\n"
+                               "Device:               %s\n"
+                               "Vendor:               %s\n"
+                               "Shading Language:     %s\n"
+                               "Swap Chain Format:    %s\n"
+                               "Depth/Stencil Format: %s\n"
+                               "Resolution:           %u x %u\n"
+                               "Samples:              %u\n",
+             info.rendererName.c_str(), info.deviceName.c_str(), info.vendorName.c_str(),
+             info.shadingLanguageName.c_str(), LLGL::ToString(llgl_swapChain->GetColorFormat()),
+             LLGL::ToString(llgl_swapChain->GetDepthStencilFormat()), llgl_swapChain->GetResolution().width,
+             llgl_swapChain->GetResolution().height, llgl_swapChain->GetSamples());
 }
 
-LLGL::PipelineState* create_pipeline(LLGL::RenderSystemPtr& llgl_renderer, LLGL::SwapChain* llgl_swapChain,
-                                     std::vector<LLGL::ShadingLanguage> languages, LLGL::VertexFormat& vertexFormat,
-                                     std::string name, LLGL::PipelineLayout* pipelineLayout = nullptr,
-                                     bool enableDepthTest = false, LLGL::CullMode cullMode = LLGL::CullMode::Disabled) {
-    LLGL::ShaderDescriptor vertShaderDesc, fragShaderDesc;
-
-    std::variant<std::string, std::vector<uint32_t>> vertShaderSourceC, fragShaderSourceC;
-    generate_shader(vertShaderDesc, fragShaderDesc, languages, vertexFormat, name, vertShaderSourceC,
-                    fragShaderSourceC);
-
-    // Specify vertex attributes for vertex shader
-    vertShaderDesc.vertex.inputAttribs = vertexFormat.attributes;
-
-    LLGL::Shader* vertShader = llgl_renderer->CreateShader(vertShaderDesc);
-    LLGL::Shader* fragShader = llgl_renderer->CreateShader(fragShaderDesc);
-
-    for (LLGL::Shader* shader : { vertShader, fragShader }) {
-        if (const LLGL::Report* report = shader->GetReport()) {
-            LLGL::Log::Errorf("%s", report->GetText());
-        }
-    }
-
-    // Create graphics pipeline
-    LLGL::PipelineState* pipeline = nullptr;
-    LLGL::PipelineCache* pipelineCache = nullptr;
-
-    LLGL::GraphicsPipelineDescriptor pipelineDesc;
-    {
-        pipelineDesc.vertexShader = vertShader;
-        pipelineDesc.fragmentShader = fragShader;
-        pipelineDesc.renderPass = llgl_swapChain->GetRenderPass();
-        pipelineDesc.pipelineLayout = pipelineLayout;
-
-        // Depth testing for 3D rendering
-        if (enableDepthTest) {
-            pipelineDesc.depth.testEnabled = true;
-            pipelineDesc.depth.writeEnabled = true;
-            pipelineDesc.depth.compareOp = LLGL::CompareOp::Less;
-        }
-
-        // Culling - use counter-clockwise as front face (OpenGL default)
-        pipelineDesc.rasterizer.cullMode = cullMode;
-        pipelineDesc.rasterizer.frontCCW = true;
-    }
-
-    // Create graphics PSO
-    pipeline = llgl_renderer->CreatePipelineState(pipelineDesc, pipelineCache);
-
-    // Link shader program and check for errors
-    if (const LLGL::Report* report = pipeline->GetReport()) {
-        if (report->HasErrors()) {
-            const char* a = report->GetText();
-            LLGL::Log::Errorf("%s\n", a);
-            throw std::runtime_error("Failed to link shader program");
-        }
+int renderer_id_from_module(const std::string& moduleName) {
+    if (moduleName == "Vulkan") {
+        return LLGL::RendererID::Vulkan;
+    } else if (moduleName == "Metal") {
+        return LLGL::RendererID::Metal;
+    } else if (moduleName == "Direct3D11") {
+        return LLGL::RendererID::Direct3D11;
+    } else if (moduleName == "Direct3D12") {
+        return LLGL::RendererID::Direct3D12;
     }
-    return pipeline;
+    return LLGL::RendererID::OpenGL;
 }
 
 LLGL::Texture* LoadTexture(const std::string& filename, LLGL::RenderSystemPtr& llgl_render) {
@@ -142,60 +117,70 @@ LLGL::Texture* LoadTexture(const std::string& filename, LLGL::RenderSystemPtr& l
     }
 }
 
-LLGL::Buffer* create_uniform_buffer(LLGL::RenderSystemPtr& llgl_renderer, std::size_t size) {
-    LLGL::BufferDescriptor uniformBufferDesc;
-    uniformBufferDesc.size = size;
-    uniformBufferDesc.bindFlags = LLGL::BindFlags::ConstantBuffer;
-    uniformBufferDesc.cpuAccessFlags = LLGL::CPUAccessFlags::Write;
-    uniformBufferDesc.miscFlags = LLGL::MiscFlags::DynamicUsage;
-    uniformBufferDesc.debugName = "MatricesBuffer";
-    return llgl_renderer->CreateBuffer(uniformBufferDesc);
-}
+// Rolling GPU pass timings and pipeline statistics for the "Model Viewer" window
+void draw_gpu_timing_ui(const GpuTimer& gpuTimer) {
+    if (!ImGui::CollapsingHeader("GPU Timing")) {
+        return;
+    }
 
-LLGL::PipelineLayout* create_texture_pipeline_layout(LLGL::RenderSystemPtr& llgl_renderer) {
-    LLGL::PipelineLayoutDescriptor modelLayoutDesc;
-    {
-        modelLayoutDesc.bindings = {
-            LLGL::BindingDescriptor{ "Matrices", LLGL::ResourceType::Buffer, LLGL::BindFlags::ConstantBuffer,
-                                     LLGL::StageFlags::VertexStage, 0 },
-            LLGL::BindingDescriptor{ "colorMap", LLGL::ResourceType::Texture, LLGL::BindFlags::Sampled,
-                                     LLGL::StageFlags::FragmentStage, 1 },
-            LLGL::BindingDescriptor{ "samplerState", LLGL::ResourceType::Sampler, 0, LLGL::StageFlags::FragmentStage,
-                                     2 },
-        };
-        modelLayoutDesc.combinedTextureSamplers = { LLGL::CombinedTextureSamplerDescriptor{ "colorMap", "colorMap",
-                                                                                            "samplerState", 3 } };
-    }
-    return llgl_renderer->CreatePipelineLayout(modelLayoutDesc);
-}
+    ImGui::Text("CPU frame: %.2f ms", 1000.0f / ImGui::GetIO().Framerate);
+    if (!gpuTimer.hasTimerQueries() && !gpuTimer.hasPipelineStatistics()) {
+        ImGui::TextDisabled("Queries not supported by %s", llgl_renderer->GetRendererInfo().rendererName.c_str());
+        return;
+    }
+    if (gpuTimer.getResolvedFrames() == 0) {
+        ImGui::TextDisabled("Waiting for query results...");
+        return;
+    }
 
-LLGL::PipelineLayout* create_no_texture_pipeline_layout(LLGL::RenderSystemPtr& llgl_renderer) {
-    LLGL::PipelineLayoutDescriptor modelNoTexLayoutDesc;
-    {
-        modelNoTexLayoutDesc.bindings = {
-            LLGL::BindingDescriptor{ "Matrices", LLGL::ResourceType::Buffer, LLGL::BindFlags::ConstantBuffer,
-                                     LLGL::StageFlags::VertexStage, 0 },
-        };
+    for (uint32_t i = 0; i < gpuTimer.getSections().size(); i++) {
+        const auto& section = gpuTimer.getSections()[i];
+        if (section.resolvedFrames == 0) {
+            continue; // Never recorded so far, e.g. the pre-pass while it is off
+        }
+        if (gpuTimer.hasTimerQueries()) {
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "%.3f ms (avg %.3f)", section.lastMs, gpuTimer.getAverageMs(i));
+            ImGui::PlotLines(section.name.c_str(), section.historyMs.data(), GpuTimer::HISTORY_SIZE,
+                             section.historyOffset, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+        }
+        if (gpuTimer.hasPipelineStatistics()) {
+            ImGui::Text("  %s: %llu verts, %llu prims, %llu VS / %llu FS invocations", section.name.c_str(),
+                        static_cast<unsigned long long>(section.statistics.inputAssemblyVertices),
+                        static_cast<unsigned long long>(section.statistics.inputAssemblyPrimitives),
+                        static_cast<unsigned long long>(section.statistics.vertexShaderInvocations),
+                        static_cast<unsigned long long>(section.statistics.fragmentShaderInvocations));
+        }
+    }
+    if (gpuTimer.getDroppedFrames() > 0) {
+        ImGui::TextDisabled("Dropped late results: %llu", static_cast<unsigned long long>(gpuTimer.getDroppedFrames()));
     }
-    return llgl_renderer->CreatePipelineLayout(modelNoTexLayoutDesc);
 }
 
-LLGL::Texture* create_white_texture(LLGL::RenderSystemPtr& llgl_renderer) {
-    uint8_t whitePixel[] = { 255, 255, 255, 255 };
-    LLGL::ImageView whiteImageView(LLGL::ImageFormat::RGBA, LLGL::DataType::UInt8, whitePixel, 4);
-    LLGL::TextureDescriptor whiteTexDesc;
-    whiteTexDesc.type = LLGL::TextureType::Texture2D;
-    whiteTexDesc.format = LLGL::Format::RGBA8UNorm;
-    whiteTexDesc.extent = { 1, 1, 1 };
-    return llgl_renderer->CreateTexture(whiteTexDesc, &whiteImageView);
+// Fragments shaded by the scene pass per pixel, and how many the depth pre-pass saved
+void draw_overdraw_ui(const GpuTimer& gpuTimer, uint32_t sceneSection, const LLGL::Extent2D& resolution,
+                      uint64_t fragmentsWithPrepass, uint64_t fragmentsWithoutPrepass) {
+    if (!gpuTimer.hasPipelineStatistics()) {
+        ImGui::TextDisabled("  Overdraw needs pipeline statistics queries");
+        return;
+    }
+    const double pixels = std::max(1.0, static_cast<double>(resolution.width) * resolution.height);
+    const uint64_t fragments = gpuTimer.getSections()[sceneSection].statistics.fragmentShaderInvocations;
+    ImGui::Text("  Shaded fragments: %llu (%.2f per pixel)", static_cast<unsigned long long>(fragments),
+                fragments / pixels);
+    if (fragmentsWithPrepass > 0 && fragmentsWithoutPrepass > 0) {
+        const double saved = 1.0 - static_cast<double>(fragmentsWithPrepass) / fragmentsWithoutPrepass;
+        ImGui::Text("  Overdraw %.2f -> %.2f per pixel with pre-pass (%.0f%% fewer fragments)",
+                    fragmentsWithoutPrepass / pixels, fragmentsWithPrepass / pixels, saved * 100.0);
+    }
 }
 
-LLGL::Sampler* create_model_sampler(LLGL::RenderSystemPtr& llgl_renderer) {
-    LLGL::SamplerDescriptor modelSamplerDesc;
-    modelSamplerDesc.maxAnisotropy = 8;
-    modelSamplerDesc.addressModeU = LLGL::SamplerAddressMode::Repeat;
-    modelSamplerDesc.addressModeV = LLGL::SamplerAddressMode::Repeat;
-    return llgl_renderer->CreateSampler(modelSamplerDesc);
+int finish_run(const AppOptions& options, int result) {
+    if (!options.tracePath.empty()) {
+        Profiler::writeChromeTrace(options.tracePath, options.traceFrames);
+    }
+    stop_logger();
+    return result;
 }
 
 #ifdef _WIN32
@@ -206,19 +191,64 @@ extern "C"
 #endif
     int main(int argc, char* argv[]) {
 #endif
+    // Before start_logger() and the thread pools register their threads
+    PROFILE_THREAD_NAME("Main");
     LLGL::Log::RegisterCallbackStd();
 
-    int rendererID = LLGL::RendererID::OpenGL;
+    AppOptions options;
+    if (!parse_app_options(argc, argv, options)) {
+        print_app_usage(argv[0]);
+        return 1;
+    }
+
+    if (!options.logFilter.empty()) {
+        LogFilter filter;
+        parse_log_filter(options.logFilter, filter);
+        set_log_filter(filter);
+    }
+    set_log_dump_directory(options.shaderDumpDir);
+    start_logger();
+
+    if (!options.spirvOptimization.empty()) {
+        SpirvOptimization level = SpirvOptimization::None;
+        parse_spirv_optimization(options.spirvOptimization, level);
+        set_spirv_optimization(level);
+    }
+
+    if (options.precompileShaders) {
+        return finish_run(options, run_shader_precompile(options));
+    }
+
+    if (!options.batchInput.empty()) {
+        return finish_run(options, run_batch(options));
+    }
+
+    if (!options.benchmarkPath.empty()) {
+        return finish_run(options, run_benchmark(options));
+    }
+
+    if (options.headless && !options.stressCounts.empty()) {
+        return finish_run(options, run_stress(options));
+    }
+
+    if (options.headless) {
+        return finish_run(options, run_headless(options));
+    }
+
+    int rendererID = renderer_id_from_module(options.rendererModule);
 
 #ifdef LLGL_OS_LINUX
     SDL_SetHint(SDL_HINT_VIDEODRIVER, "x11");
 #endif
 
     // Init SDL
-    SDL_Init(SDL_INIT_VIDEO);
+    {
+        PROFILE_SCOPE("SDL_Init");
+        SDL_Init(SDL_INIT_VIDEO);
+    }
 
-    const uint32_t window_width = 800;
-    const uint32_t window_height = 600;
+    const uint32_t window_width = options.width;
+    const uint32_t window_height = options.height;
 
     LLGL::SwapChainDescriptor swapChainDesc;
     swapChainDesc.resolution = { window_width, window_height };
@@ -229,40 +259,52 @@ extern "C"
     auto surface = std::make_shared<SDLSurface>(swapChainDesc.resolution, "LLGL SwapChain", rendererID, desc);
     desc.flags |= LLGL::RenderSystemFlags::DebugDevice;
     LLGL::Report report;
-    llgl_renderer = LLGL::RenderSystem::Load(desc, &report);
+    {
+        PROFILE_SCOPE("RenderSystem::Load");
+        llgl_renderer = LLGL::RenderSystem::Load(desc, &report);
+    }
 
     // Create SDL window and LLGL swap-chain
     if (!llgl_renderer) {
         auto a = report.GetText();
-        LLGL::Log::Errorf("Failed to load \"%s\" module. Falling back to \"Null\" device.\n", desc.moduleName.c_str());
-        LLGL::Log::Errorf("Reason for failure: %s", report.HasErrors() ? report.GetText() : "Unknown\n");
+        log_error(LogCategory::App, "Failed to load \"%s\" module. Falling back to \"Null\" device.\n",
+                  desc.moduleName.c_str());
+        log_error(LogCategory::App, "Reason for failure: %s", report.HasErrors() ? report.GetText() : "Unknown\n");
         llgl_renderer = LLGL::RenderSystem::Load("Null");
         if (!llgl_renderer) {
-            LLGL::Log::Errorf("Failed to load \"Null\" module. Exiting.\n");
-            return 1;
+            log_error(LogCategory::App, "Failed to load \"Null\" module. Exiting.\n");
+            return finish_run(options, 1);
         }
     }
+    if (options.pipelineCache) {
+        load_pipeline_cache(llgl_renderer, options.cacheDir);
+    }
+    if (options.shaderCache) {
+        init_shader_cache(options.cacheDir);
+    }
+    if (options.asyncPipelines) {
+        // Translates on the workers while the window opens and the model loads
+        prewarm_pipelines(llgl_renderer, options.cacheDir);
+    }
 
-    auto llgl_swapChain = llgl_renderer->CreateSwapChain(swapChainDesc, surface);
+    LLGL::SwapChain* llgl_swapChain = nullptr;
+    {
+        PROFILE_SCOPE("CreateSwapChain");
+        llgl_swapChain = llgl_renderer->CreateSwapChain(swapChainDesc, surface);
+    }
 
     print_info(llgl_renderer, llgl_swapChain);
 
-    LLGL::Log::Printf("glsl version: %s\n", glslang::GetGlslVersionString());
-
-    const auto& languages = llgl_renderer->GetRenderingCaps().shadingLanguages;
+    log_info(LogCategory::App, "glsl version: %s\n", glslang::GetGlslVersionString());
 
     // Load 3D model
     Model model;
-    std::string modelPath = "../model.obj";
-
-    if (argc > 1) {
-        modelPath = argv[1];
-    }
+    const std::string& modelPath = options.modelPath;
 
     if (!model.load(modelPath, llgl_renderer)) {
-        LLGL::Log::Errorf("Failed to load model: %s\n", modelPath.c_str());
-        LLGL::Log::Printf("Usage: %s [model_path]\n", argv[0]);
-        LLGL::Log::Printf("Creating a default cube...\n");
+        log_error(LogCategory::App, "Failed to load model: %s\n", modelPath.c_str());
+        print_app_usage(argv[0]);
+        log_info(LogCategory::App, "Creating a default cube...\n");
 
         model = Primitives::createDefaultModel();
         model.calculateBounds();
@@ -270,34 +312,15 @@ extern "C"
 
     model.createBuffers(llgl_renderer);
 
-    struct Matrices {
-        Math::Mat4 model;
-        Math::Mat4 view;
-        Math::Mat4 projection;
-    } matrices;
+    ModelRenderer modelRenderer;
+    modelRenderer.setAsyncPipelines(options.asyncPipelines);
+    modelRenderer.init(llgl_renderer, llgl_swapChain->GetRenderPass(), model.getVertexFormat());
+    modelRenderer.prepare(llgl_renderer, model);
 
-    LLGL::Buffer* uniformBuffer = create_uniform_buffer(llgl_renderer, sizeof(Matrices));
-
-    // Pipeline layout for 3D model rendering (with texture)
-    LLGL::PipelineLayout* modelPipelineLayout = create_texture_pipeline_layout(llgl_renderer);
-
-    // Pipeline layout for 3D model rendering (without texture)
-    LLGL::PipelineLayout* modelNoTexPipelineLayout = create_no_texture_pipeline_layout(llgl_renderer);
-
-    auto modelVertexFormat = model.getVertexFormat();
-
-    LLGL::PipelineState* modelPipeline = create_pipeline(llgl_renderer, llgl_swapChain, languages, modelVertexFormat,
-                                                         "model", modelPipelineLayout, true, LLGL::CullMode::Back);
-
-    LLGL::PipelineState* modelNoTexPipeline =
-        create_pipeline(llgl_renderer, llgl_swapChain, languages, modelVertexFormat, "model_notex",
-                        modelNoTexPipelineLayout, true, LLGL::CullMode::Back);
-
-    // White texture for meshes without a texture
-    LLGL::Texture* whiteTexture = create_white_texture(llgl_renderer);
-
-    // Sampler for model textures
-    LLGL::Sampler* modelSampler = create_model_sampler(llgl_renderer);
+    ShaderHotReload shaderReload;
+    if (options.shaderHotReload && !shaderReload.start()) {
+        log_warning(LogCategory::App, "Shader hot reload is not available\n");
+    }
 
     // Create orbit camera
     OrbitCamera camera;
@@ -305,14 +328,59 @@ extern "C"
     float modelRadius = model.getRadius();
     camera.setTarget(modelCenter, modelRadius * 2.5f);
 
+    // Synthetic stress scene (first --stress count) replaces the model
+    StressScene stressScene;
+    StressRenderer stressRenderer;
+    StressSubmitMode stressMode = StressSubmitMode::Draws;
+    bool stressActive = false;
+    if (!options.stressCounts.empty()) {
+        StressSceneDesc stressDesc;
+        if (stress_options_to_desc(options, options.stressCounts.front(), stressDesc, stressMode) &&
+            stressRenderer.init(llgl_renderer, llgl_swapChain->GetRenderPass())) {
+            stressScene.generate(stressDesc);
+            stressScene.createBuffers(llgl_renderer);
+            frame_stress_scene(camera, stressScene);
+            modelRadius = stressScene.getBounds().radius();
+            stressActive = true;
+        }
+    }
+    OcclusionCuller culler;
+    bool cullingEnabled = options.stressCulling;
+    if (stressActive) {
+        culler.init();
+    }
+    std::vector<uint32_t> visibleObjects;
+    CullStats cullStats;
+    DrawStats sceneStats;
+
     // Model rotation angles (for auto-rotation or manual rotation)
     float modelRotationY = 0.0f;
     float modelRotationX = 0.0f;
     bool autoRotate = false;
 
+    // Camera recording for --benchmark replays
+    CameraPath recordedPath;
+    uint32_t frameIndex = 0;
+
     auto llgl_cmdBuffer = llgl_renderer->CreateCommandBuffer(LLGL::CommandBufferFlags::ImmediateSubmit);
 
-    InitImGui(*surface, llgl_renderer, llgl_swapChain, llgl_cmdBuffer);
+    // GPU pass timings, read back a few frames late
+    enum GpuSection : uint32_t { GPU_SECTION_DEPTH_PREPASS, GPU_SECTION_SCENE, GPU_SECTION_IMGUI };
+    GpuTimer gpuTimer;
+    gpuTimer.init(llgl_renderer, { "Depth pre-pass", "Scene", "ImGui" });
+
+    // Depth pre-pass and the shaded fragments of the scene pass with and without it
+    bool depthPrepass = options.depthPrepass;
+    modelRenderer.setDepthPrepass(llgl_renderer, model, depthPrepass);
+    uint64_t fragmentsWithPrepass = 0;
+    uint64_t fragmentsWithoutPrepass = 0;
+    uint32_t framesSincePrepassToggle = 0;
+    DrawStats prepassStats;
+
+    {
+        PROFILE_SCOPE("InitImGui");
+        InitImGui(*surface, llgl_renderer, llgl_swapChain, llgl_cmdBuffer);
+    }
 
     // Set up event callback for camera control
     surface->SetEventCallback([&camera](const SDL_Event& event) {
@@ -341,6 +409,14 @@ extern "C"
 
     // Main render loop
     while (surface->ProcessEvents(llgl_swapChain)) {
+        PROFILE_FRAME_MARK();
+        PROFILE_SCOPE("Frame");
+
+        // Frame boundary: start rebuilding pipelines of edited shaders, swap in those that are ready and
+        // create at most one finished pipeline per frame to bound the hitch
+        shaderReload.update(llgl_renderer);
+        pump_pipeline_compilation(llgl_renderer);
+
         // Update matrices
         float aspect = static_cast<float>(llgl_swapChain->GetResolution().width) /
                        static_cast<float>(llgl_swapChain->GetResolution().height);
@@ -350,22 +426,32 @@ extern "C"
             modelRotationY += 0.01f;
         }
 
-        // Model matrix (rotation around center)
-        matrices.model = Math::Mat4::translate(-modelCenter);
-        matrices.model = Math::Mat4::rotateY(modelRotationY) * matrices.model;
-        matrices.model = Math::Mat4::rotateX(modelRotationX) * matrices.model;
-        matrices.model = Math::Mat4::translate(modelCenter) * matrices.model;
-
-        // View matrix from camera
-        matrices.view = camera.getViewMatrix();
-
-        // Projection matrix
-        matrices.projection = Math::Mat4::perspective(3.14159f / 4.0f, aspect, 0.1f, 1000.0f);
+        if (!options.recordPath.empty()) {
+            recordedPath.record(frameIndex, camera, modelRotationY, modelRotationX);
+        }
+        frameIndex++;
 
         // Update uniform buffer
-        llgl_renderer->WriteBuffer(*uniformBuffer, 0, &matrices, sizeof(Matrices));
+        if (stressActive) {
+            stressRenderer.updateCamera(llgl_renderer, camera, aspect, stressScene);
+            if (cullingEnabled) {
+                cullStats = culler.cull(stressScene, stressRenderer.getViewProjection(), camera.getPosition(),
+                                        visibleObjects);
+            }
+        } else {
+            Matrices matrices = compute_model_matrices(camera, modelCenter, modelRotationY, modelRotationX, aspect);
+            modelRenderer.updateMatrices(llgl_renderer, matrices);
+        }
 
         // Rendering
+        gpuTimer.beginFrame(*llgl_renderer->GetCommandQueue());
+
+        // Statistics lag FRAME_LATENCY frames, skip the ones recorded before the last pre-pass toggle
+        if (gpuTimer.hasPipelineStatistics() && ++framesSincePrepassToggle > GpuTimer::FRAME_LATENCY) {
+            const auto& statistics = gpuTimer.getSections()[GPU_SECTION_SCENE].statistics;
+            (depthPrepass ? fragmentsWithPrepass : fragmentsWithoutPrepass) = statistics.fragmentShaderInvocations;
+        }
+
         llgl_cmdBuffer->Begin();
         {
             // Set viewport and scissor rectangle
@@ -376,42 +462,27 @@ extern "C"
                 // Clear with depth
                 llgl_cmdBuffer->Clear(LLGL::ClearFlags::ColorDepth, LLGL::ClearValue{ 0.1f, 0.1f, 0.15f, 1.0f });
 
+                // Depth-only pass over the position streams
+                if (!stressActive && depthPrepass) {
+                    gpuTimer.beginSection(*llgl_cmdBuffer, GPU_SECTION_DEPTH_PREPASS);
+                    prepassStats = modelRenderer.renderDepthPrepass(*llgl_cmdBuffer, model);
+                    gpuTimer.endSection(*llgl_cmdBuffer, GPU_SECTION_DEPTH_PREPASS);
+                }
+
                 // Render model meshes
+                gpuTimer.beginSection(*llgl_cmdBuffer, GPU_SECTION_SCENE);
+                if (stressActive) {
+                    sceneStats = stressRenderer.render(*llgl_cmdBuffer, stressScene, stressMode,
+                                                       cullingEnabled ? &visibleObjects : nullptr);
+                } else {
+                    sceneStats = modelRenderer.render(*llgl_cmdBuffer, model);
+                }
+                gpuTimer.endSection(*llgl_cmdBuffer, GPU_SECTION_SCENE);
                 const auto& meshes = model.getMeshes();
                 const auto& materials = model.getMaterials();
-                for (size_t i = 0; i < meshes.size(); i++) {
-                    const auto& mesh = meshes[i];
-
-                    // Check if mesh has texture
-                    bool hasTexture = false;
-                    LLGL::Texture* meshTexture = whiteTexture;
-
-                    if (mesh.materialIndex < materials.size()) {
-                        const auto& material = materials[mesh.materialIndex];
-                        if (material.hasTexture && material.diffuseTexture) {
-                            hasTexture = true;
-                            meshTexture = material.diffuseTexture;
-                        }
-                    }
-
-                    // Set appropriate pipeline
-                    if (hasTexture) {
-                        llgl_cmdBuffer->SetPipelineState(*modelPipeline);
-                        llgl_cmdBuffer->SetResource(0, *uniformBuffer);
-                        llgl_cmdBuffer->SetResource(1, *meshTexture);
-                        llgl_cmdBuffer->SetResource(2, *modelSampler);
-                    } else {
-                        llgl_cmdBuffer->SetPipelineState(*modelNoTexPipeline);
-                        llgl_cmdBuffer->SetResource(0, *uniformBuffer);
-                    }
-
-                    // Draw mesh
-                    llgl_cmdBuffer->SetVertexBuffer(*mesh.vertexBuffer);
-                    llgl_cmdBuffer->SetIndexBuffer(*mesh.indexBuffer);
-                    llgl_cmdBuffer->DrawIndexed(mesh.indexCount(), 0);
-                }
 
                 // GUI Rendering with ImGui library
+                PROFILE_SCOPE("ImGui");
                 NewFrameImGui();
                 ImGui::NewFrame();
 
@@ -420,6 +491,69 @@ extern "C"
                 ImGui::Text("Model: %s", modelPath.c_str());
                 ImGui::Text("Meshes: %zu", meshes.size());
                 ImGui::Text("Materials: %zu", materials.size());
+                if (stressActive) {
+                    ImGui::Text("Stress scene: %zu objects, %s layout", stressScene.getObjects().size(),
+                                stress_layout_name(stressScene.getDesc().layout));
+                    if (ImGui::RadioButton("Draw per object", stressMode == StressSubmitMode::Draws)) {
+                        stressMode = StressSubmitMode::Draws;
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::RadioButton("Instanced", stressMode == StressSubmitMode::Instanced)) {
+                        stressMode = StressSubmitMode::Instanced;
+                    }
+                    ImGui::Checkbox("Occlusion culling", &cullingEnabled);
+                    if (cullingEnabled) {
+                        ImGui::Text("  Visible %u / %u: %u outside frustum, %u occluded", cullStats.visible(),
+                                    cullStats.tested, cullStats.frustumCulled, cullStats.occluded);
+                        ImGui::Text("  %u occluders (%u triangles), %u x %u depth", cullStats.occluders,
+                                    cullStats.occluderTriangles, culler.getWidth(), culler.getHeight());
+                        ImGui::Text("  Cost %.3f ms: select %.3f, raster %.3f, test %.3f", cullStats.totalMs(),
+                                    cullStats.selectMs, cullStats.rasterMs, cullStats.testMs);
+                    }
+                }
+                ImGui::Text("Draws: %u, triangles: %llu, binds: %u", sceneStats.drawCalls,
+                            static_cast<unsigned long long>(sceneStats.triangles),
+                            sceneStats.pipelineBinds + sceneStats.resourceBinds);
+                if (!stressActive) {
+                    if (ImGui::Checkbox("Depth pre-pass", &depthPrepass)) {
+                        modelRenderer.setDepthPrepass(llgl_renderer, model, depthPrepass);
+                        framesSincePrepassToggle = 0;
+                    }
+                    if (depthPrepass) {
+                        ImGui::Text("  Pre-pass draws: %u, position stream %zu bytes/vertex", prepassStats.drawCalls,
+                                    sizeof(Math::Vec3));
+                    }
+                    draw_overdraw_ui(gpuTimer, GPU_SECTION_SCENE, llgl_swapChain->GetResolution(),
+                                     fragmentsWithPrepass, fragmentsWithoutPrepass);
+                }
+                const PipelineRegistryStats registryStats = pipeline_registry_stats();
+                ImGui::Text("Pipelines: %u live, %u created, %u of %u requests shared", registryStats.live,
+                            registryStats.unique, registryStats.hits, registryStats.requests);
+                ImGui::Text("  Model shader variants: %zu live, %u layouts, %u layout requests shared",
+                            modelRenderer.getLiveVariantCount(), registryStats.layouts, registryStats.layoutHits);
+                if (registryStats.pending > 0) {
+                    ImGui::Text("  Compiling %u, %u draws use the fallback pipeline", registryStats.pending,
+                                sceneStats.fallbackDraws);
+                }
+                if (registryStats.failed > 0) {
+                    ImGui::Text("  %u pipelines failed to compile, see the log", registryStats.failed);
+                }
+                if (registryStats.prewarmed > 0) {
+                    ImGui::Text("  Pre-warmed %u shader pairs, %u used", registryStats.prewarmed,
+                                registryStats.prewarmHits);
+                }
+                if (registryStats.reloaded > 0 || registryStats.reloading > 0) {
+                    ImGui::Text("  Shader reload: %u pipelines swapped in, %u compiling", registryStats.reloaded,
+                                registryStats.reloading);
+                }
+                const ImGui_ImplLLGL_Stats imguiStats = ImGui_ImplLLGL_GetStats();
+                ImGui::Text("ImGui buffers: %d frames in flight, %llu CPU waits (%.2f ms)", imguiStats.FramesInFlight,
+                            static_cast<unsigned long long>(imguiStats.FenceWaits), imguiStats.FenceWaitMs);
+                ImGui::Text("  %.1f KiB, %llu grows, %llu shrinks", imguiStats.BufferBytes / 1024.0,
+                            static_cast<unsigned long long>(imguiStats.BufferGrows),
+                            static_cast<unsigned long long>(imguiStats.BufferShrinks));
+                ImGui::Text("  %d commands in %d draws, %d binds (%d avoided)", imguiStats.DrawCommands,
+                            imguiStats.DrawCalls, imguiStats.Binds, imguiStats.BindsAvoided);
                 ImGui::Separator();
 
                 ImGui::Text("Camera Controls:");
@@ -447,32 +581,68 @@ extern "C"
                 }
 
                 if (ImGui::Button("Reset Camera")) {
-                    camera.setTarget(modelCenter, modelRadius * 2.5f);
-                    camera.setYaw(0.0f);
-                    camera.setPitch(0.0f);
+                    if (stressActive) {
+                        frame_stress_scene(camera, stressScene);
+                    } else {
+                        camera.setTarget(modelCenter, modelRadius * 2.5f);
+                        camera.setYaw(0.0f);
+                        camera.setPitch(0.0f);
+                    }
                     modelRotationX = 0.0f;
                     modelRotationY = 0.0f;
                 }
 
+                draw_gpu_timing_ui(gpuTimer);
+
                 ImGui::End();
 
                 // GUI Rendering
                 ImGui::Render();
+                gpuTimer.beginSection(*llgl_cmdBuffer, GPU_SECTION_IMGUI);
                 RenderImGui(ImGui::GetDrawData());
+                gpuTimer.endSection(*llgl_cmdBuffer, GPU_SECTION_IMGUI);
             }
             llgl_cmdBuffer->EndRenderPass();
         }
         llgl_cmdBuffer->End();
 
         // Present result on screen
-        llgl_swapChain->Present();
+        {
+            PROFILE_SCOPE("Present");
+            llgl_swapChain->Present();
+        }
+    }
+
+    if (!options.recordPath.empty() && recordedPath.save(options.recordPath)) {
+        log_info(LogCategory::App, "Recorded %u frames to %s\n", frameIndex, options.recordPath.c_str());
     }
 
     // Cleanup
+    gpuTimer.release(llgl_renderer);
+    stressRenderer.release(llgl_renderer);
+    stressScene.release(llgl_renderer);
+    modelRenderer.release(llgl_renderer);
     model.release(llgl_renderer);
     ShutdownImGui();
+    shaderReload.stop();
+    if (shaderReload.getReloadCount() > 0) {
+        log_info(LogCategory::App, "Shader hot reload: %u pipelines rebuilt\n", shaderReload.getReloadCount());
+    }
+    const PipelineRegistryStats registryStats = pipeline_registry_stats();
+    log_info(LogCategory::App, "Pipeline registry: %u requests, %u hits, %u unique pipelines, %.2f ms translating\n",
+             registryStats.requests, registryStats.hits, registryStats.unique, registryStats.translationMs);
+    if (options.asyncPipelines) {
+        save_pipeline_prewarm_list(options.cacheDir);
+    }
+    shutdown_pipeline_registry();
+    if (!embedded_shader_blobs().empty()) {
+        log_info(LogCategory::App, "Embedded shaders: %u of %zu translations used\n", embedded_shader_hits(),
+                 embedded_shader_blobs().size());
+    }
+    log_shader_cache_stats();
+    save_pipeline_cache(llgl_renderer);
     LLGL::RenderSystem::Unload(std::move(llgl_renderer));
     SDL_Quit();
 
-    return 0;
+    return finish_run(options, 0);
 }
\ No newline at end of file
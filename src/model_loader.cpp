@@ -6,6 +6,9 @@
 #include <stb_image.h>
 #include <LLGL/Utils/VertexFormat.h>
 
+#include "logger.h"
+#include "profiler.h"
+
 namespace {
 
 constexpr unsigned int ASSIMP_LOAD_FLAGS = aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_FlipUVs |
@@ -16,60 +19,86 @@ std::string extractDirectory(const std::string& path) {
     return (lastSlash != std::string::npos) ? path.substr(0, lastSlash + 1) : "";
 }
 
-LLGL::Texture* loadTextureFromFile(const std::string& path, LLGL::RenderSystemPtr& renderer) {
+bool decodeTextureFromFile(const std::string& path, TextureImage& image) {
+    PROFILE_SCOPE("DecodeTexture");
     int width, height, channels;
     unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
 
     if (!data) {
-        LLGL::Log::Errorf("Failed to load texture: %s\n", path.c_str());
-        return nullptr;
+        log_error(LogCategory::Model, "Failed to load texture: %s\n", path.c_str());
+        return false;
     }
 
-    LLGL::ImageView imageView(LLGL::ImageFormat::RGBA, LLGL::DataType::UInt8, data,
-                              static_cast<size_t>(width * height * 4));
+    image.width = static_cast<uint32_t>(width);
+    image.height = static_cast<uint32_t>(height);
+    image.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+
+    stbi_image_free(data);
+    log_info(LogCategory::Model, "Loaded texture: %s (%dx%d)\n", path.c_str(), width, height);
+
+    return true;
+}
+
+LLGL::Texture* createTextureFromImage(const TextureImage& image, LLGL::RenderSystemPtr& renderer) {
+    LLGL::ImageView imageView(LLGL::ImageFormat::RGBA, LLGL::DataType::UInt8, image.pixels.data(),
+                              image.pixels.size());
 
     LLGL::TextureDescriptor texDesc;
     texDesc.type = LLGL::TextureType::Texture2D;
     texDesc.format = LLGL::Format::RGBA8UNorm;
-    texDesc.extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 };
+    texDesc.extent = { image.width, image.height, 1 };
     texDesc.miscFlags = LLGL::MiscFlags::GenerateMips;
 
-    LLGL::Texture* texture = renderer->CreateTexture(texDesc, &imageView);
-
-    stbi_image_free(data);
-    LLGL::Log::Printf("Loaded texture: %s (%dx%d)\n", path.c_str(), width, height);
-
-    return texture;
+    return renderer->CreateTexture(texDesc, &imageView);
 }
 
 } // anonymous namespace
 
 bool Model::load(const std::string& path, LLGL::RenderSystemPtr& renderer) {
+    if (!import(path)) {
+        return false;
+    }
+
+    // Upload decoded textures
+    createTextures(renderer);
+
+    return true;
+}
+
+bool Model::import(const std::string& path) {
+    PROFILE_SCOPE("Model::import");
     Assimp::Importer importer;
 
-    const aiScene* scene = importer.ReadFile(path, ASSIMP_LOAD_FLAGS);
+    const aiScene* scene = nullptr;
+    {
+        PROFILE_SCOPE("Assimp ReadFile");
+        scene = importer.ReadFile(path, ASSIMP_LOAD_FLAGS);
+    }
 
     if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
-        LLGL::Log::Errorf("Assimp error: %s\n", importer.GetErrorString());
+        log_error(LogCategory::Model, "Assimp error: %s\n", importer.GetErrorString());
         return false;
     }
 
     directory_ = extractDirectory(path);
 
     // Process scene hierarchy
-    processNode(scene->mRootNode, scene);
+    {
+        PROFILE_SCOPE("Model::processNode");
+        processNode(scene->mRootNode, scene);
+    }
 
-    // Load materials and textures
-    loadMaterials(scene, renderer);
+    // Load materials and decode textures
+    loadMaterials(scene);
 
     // Calculate bounding box
     calculateBounds();
 
-    LLGL::Log::Printf("Model loaded: %zu meshes, %zu materials\n", meshes_.size(), materials_.size());
-    LLGL::Log::Printf("Bounds: (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f)\n", bounds_.minPoint.x, bounds_.minPoint.y,
-                      bounds_.minPoint.z, bounds_.maxPoint.x, bounds_.maxPoint.y, bounds_.maxPoint.z);
-    LLGL::Log::Printf("Center: (%.2f, %.2f, %.2f), Radius: %.2f\n", getCenter().x, getCenter().y, getCenter().z,
-                      getRadius());
+    log_info(LogCategory::Model, "Model loaded: %zu meshes, %zu materials\n", meshes_.size(), materials_.size());
+    log_info(LogCategory::Model, "Bounds: (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f)\n", bounds_.minPoint.x,
+             bounds_.minPoint.y, bounds_.minPoint.z, bounds_.maxPoint.x, bounds_.maxPoint.y, bounds_.maxPoint.z);
+    log_info(LogCategory::Model, "Center: (%.2f, %.2f, %.2f), Radius: %.2f\n", getCenter().x, getCenter().y,
+             getCenter().z, getRadius());
 
     return true;
 }
@@ -125,7 +154,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
     return result;
 }
 
-void Model::loadMaterials(const aiScene* scene, LLGL::RenderSystemPtr& renderer) {
+void Model::loadMaterials(const aiScene* scene) {
     materials_.resize(scene->mNumMaterials);
 
     for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
@@ -133,7 +162,7 @@ void Model::loadMaterials(const aiScene* scene, LLGL::RenderSystemPtr& renderer)
         // print the shader model
         aiString shaderModel;
         if (mat->Get(AI_MATKEY_SHADER_FRAGMENT, shaderModel) == AI_SUCCESS) {
-            LLGL::Log::Printf("Shader Model: %s\n", shaderModel.C_Str());
+            log_info(LogCategory::Model, "Shader Model: %s\n", shaderModel.C_Str());
         }
 
         Material& material = materials_[i];
@@ -150,12 +179,25 @@ void Model::loadMaterials(const aiScene* scene, LLGL::RenderSystemPtr& renderer)
 
             std::string fullPath = directory_ + texPath.C_Str();
             material.diffuseTexturePath = fullPath;
-            material.diffuseTexture = loadTextureFromFile(fullPath, renderer);
-            material.hasTexture = (material.diffuseTexture != nullptr);
+            decodeTextureFromFile(fullPath, material.diffuseImage);
         }
     }
 }
 
+void Model::createTextures(LLGL::RenderSystemPtr& renderer) {
+    PROFILE_SCOPE("Model::createTextures");
+    for (auto& material : materials_) {
+        if (material.diffuseImage.pixels.empty()) {
+            continue;
+        }
+        material.diffuseTexture = createTextureFromImage(material.diffuseImage, renderer);
+        material.hasTexture = (material.diffuseTexture != nullptr);
+
+        // The GPU copy is all we need from now on
+        material.diffuseImage = TextureImage{};
+    }
+}
+
 void Model::calculateBounds() {
     bounds_ = Math::AABB{};
 
@@ -167,6 +209,7 @@ void Model::calculateBounds() {
 }
 
 void Model::createBuffers(LLGL::RenderSystemPtr& renderer) {
+    PROFILE_SCOPE("Model::createBuffers");
     vertexFormat_.AppendAttribute({ "position", LLGL::Format::RGB32Float });
     vertexFormat_.AppendAttribute({ "normal", LLGL::Format::RGB32Float });
     vertexFormat_.AppendAttribute({ "texCoord", LLGL::Format::RG32Float });
@@ -192,12 +235,40 @@ void Model::createBuffers(LLGL::RenderSystemPtr& renderer) {
     }
 }
 
+void Model::createPositionBuffers(LLGL::RenderSystemPtr& renderer) {
+    PROFILE_SCOPE("Model::createPositionBuffers");
+    const LLGL::VertexFormat positionFormat = createPositionVertexFormat();
+    std::vector<Math::Vec3> positions;
+    for (auto& mesh : meshes_) {
+        if (mesh.positionBuffer) {
+            continue;
+        }
+
+        // 12 instead of 32 bytes per vertex
+        positions.resize(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); i++) {
+            positions[i] = mesh.vertices[i].position;
+        }
+        LLGL::BufferDescriptor positionDesc;
+        positionDesc.size = positions.size() * sizeof(Math::Vec3);
+        positionDesc.bindFlags = LLGL::BindFlags::VertexBuffer;
+        positionDesc.vertexAttribs = positionFormat.attributes;
+        positionDesc.debugName = "ModelPositionBuffer";
+
+        mesh.positionBuffer = renderer->CreateBuffer(positionDesc, positions.data());
+    }
+}
+
 void Model::release(LLGL::RenderSystemPtr& renderer) {
     for (auto& mesh : meshes_) {
         if (mesh.vertexBuffer) {
             renderer->Release(*mesh.vertexBuffer);
             mesh.vertexBuffer = nullptr;
         }
+        if (mesh.positionBuffer) {
+            renderer->Release(*mesh.positionBuffer);
+            mesh.positionBuffer = nullptr;
+        }
         if (mesh.indexBuffer) {
             renderer->Release(*mesh.indexBuffer);
             mesh.indexBuffer = nullptr;
@@ -25,6 +25,7 @@ struct Mesh {
     std::vector<ModelVertex> vertices;
     std::vector<uint32_t> indices;
     LLGL::Buffer* vertexBuffer = nullptr;
+    LLGL::Buffer* positionBuffer = nullptr; // Tightly packed positions, only while the depth pre-pass is used
     LLGL::Buffer* indexBuffer = nullptr;
     uint32_t materialIndex = 0;
 
@@ -33,9 +34,17 @@ struct Mesh {
     }
 };
 
+// Decoded RGBA8 image waiting for GPU upload
+struct TextureImage {
+    std::vector<uint8_t> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
 // Material data
 struct Material {
     std::string diffuseTexturePath;
+    TextureImage diffuseImage; // Filled by Model::import, released by Model::createTextures
     LLGL::Texture* diffuseTexture = nullptr;
     Math::Vec3 diffuseColor{ 0.8f, 0.8f, 0.8f };
     bool hasTexture = false;
@@ -57,7 +66,14 @@ class Model {
 
     // Loading
     bool load(const std::string& path, LLGL::RenderSystemPtr& renderer);
+
+    // CPU-only part of load(): scene import and texture decoding, safe to run on worker threads
+    bool import(const std::string& path);
+    // Uploads the textures decoded by import(); must run on the render thread
+    void createTextures(LLGL::RenderSystemPtr& renderer);
     void createBuffers(LLGL::RenderSystemPtr& renderer);
+    // Position-only streams for the depth pre-pass, for the meshes that don't have one yet
+    void createPositionBuffers(LLGL::RenderSystemPtr& renderer);
     void release(LLGL::RenderSystemPtr& renderer);
 
     // Accessors
@@ -96,9 +112,11 @@ class Model {
     void calculateBounds();
 
   private:
+    friend struct ModelBenchAccess; // bench/microbench.cpp times processMesh
+
     void processNode(aiNode* node, const aiScene* scene);
     Mesh processMesh(aiMesh* mesh, const aiScene* scene);
-    void loadMaterials(const aiScene* scene, LLGL::RenderSystemPtr& renderer);
+    void loadMaterials(const aiScene* scene);
 
     std::vector<Mesh> meshes_;
     std::vector<Material> materials_;
@@ -116,3 +134,11 @@ inline LLGL::VertexFormat createModelVertexFormat() {
     format.SetStride(sizeof(ModelVertex));
     return format;
 }
+
+// Helper to create vertex format for Mesh::positionBuffer
+inline LLGL::VertexFormat createPositionVertexFormat() {
+    LLGL::VertexFormat format;
+    format.AppendAttribute({ "position", LLGL::Format::RGB32Float });
+    format.SetStride(sizeof(Math::Vec3));
+    return format;
+}
@@ -0,0 +1,360 @@
+#include "model_renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include <LLGL/Utils/VertexFormat.h>
+
+#include "logger.h"
+#include "pipeline_cache.h"
+#include "pipeline_registry.h"
+#include "shader_reflection.h"
+#include "shader_translation.h"
+#include "shader_variants.h"
+#include "profiler.h"
+
+LLGL::PipelineState* create_pipeline(LLGL::RenderSystemPtr& llgl_renderer, const LLGL::RenderPass* renderPass,
+                                     std::vector<LLGL::ShadingLanguage> languages,
+                                     const LLGL::VertexFormat& vertexFormat, std::string name,
+                                     LLGL::PipelineLayout* pipelineLayout, DepthMode depthMode,
+                                     LLGL::CullMode cullMode) {
+    PROFILE_SCOPE("create_pipeline");
+    std::string vertShaderSource, fragShaderSource;
+    load_shader_sources(name, vertShaderSource, fragShaderSource);
+    auto shaders = translate_shaders(languages, vertexFormat, std::move(vertShaderSource), std::move(fragShaderSource));
+    return create_pipeline_from_shaders(llgl_renderer, renderPass, *shaders, pipelineLayout, depthMode, cullMode);
+}
+
+LLGL::PipelineState* create_pipeline_from_shaders(LLGL::RenderSystemPtr& llgl_renderer,
+                                                  const LLGL::RenderPass* renderPass,
+                                                  const TranslatedShaders& shaders,
+                                                  LLGL::PipelineLayout* pipelineLayout, DepthMode depthMode,
+                                                  LLGL::CullMode cullMode) {
+    PROFILE_SCOPE("create_pipeline_from_shaders");
+    LLGL::Shader* vertShader = nullptr;
+    LLGL::Shader* fragShader = nullptr;
+    {
+        PROFILE_SCOPE("CreateShader");
+        vertShader = llgl_renderer->CreateShader(shaders.vertShaderDesc);
+        fragShader = llgl_renderer->CreateShader(shaders.fragShaderDesc);
+    }
+
+    for (LLGL::Shader* shader : { vertShader, fragShader }) {
+        if (const LLGL::Report* report = shader->GetReport()) {
+            log_error(LogCategory::Render, "%s", report->GetText());
+        }
+    }
+
+    // Create graphics pipeline
+    LLGL::PipelineState* pipeline = nullptr;
+    LLGL::PipelineCache* pipelineCache = shared_pipeline_cache();
+
+    LLGL::GraphicsPipelineDescriptor pipelineDesc;
+    {
+        pipelineDesc.vertexShader = vertShader;
+        pipelineDesc.fragmentShader = fragShader;
+        pipelineDesc.renderPass = renderPass;
+        pipelineDesc.pipelineLayout = pipelineLayout;
+
+        // Depth testing for 3D rendering
+        if (depthMode != DepthMode::Disabled) {
+            pipelineDesc.depth.testEnabled = true;
+            pipelineDesc.depth.writeEnabled = depthMode != DepthMode::PrepassEqual;
+            pipelineDesc.depth.compareOp =
+                depthMode == DepthMode::PrepassEqual ? LLGL::CompareOp::LessEqual : LLGL::CompareOp::Less;
+        }
+        if (depthMode == DepthMode::PrepassWrite) {
+            pipelineDesc.blend.targets[0].colorMask = 0;
+        }
+
+        // Culling - use counter-clockwise as front face (OpenGL default)
+        pipelineDesc.rasterizer.cullMode = cullMode;
+        pipelineDesc.rasterizer.frontCCW = true;
+    }
+
+    // Create graphics PSO
+    {
+        PROFILE_SCOPE("CreatePipelineState");
+        const auto start = std::chrono::steady_clock::now();
+        pipeline = llgl_renderer->CreatePipelineState(pipelineDesc, pipelineCache);
+        record_pipeline_creation(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // Link shader program and check for errors
+    if (const LLGL::Report* report = pipeline->GetReport()) {
+        if (report->HasErrors()) {
+            const char* a = report->GetText();
+            log_error(LogCategory::Render, "%s\n", a);
+            throw std::runtime_error("Failed to link shader program");
+        }
+    }
+    return pipeline;
+}
+
+namespace {
+
+LLGL::Buffer* create_uniform_buffer(LLGL::RenderSystemPtr& llgl_renderer, std::size_t size) {
+    LLGL::BufferDescriptor uniformBufferDesc;
+    uniformBufferDesc.size = size;
+    uniformBufferDesc.bindFlags = LLGL::BindFlags::ConstantBuffer;
+    uniformBufferDesc.cpuAccessFlags = LLGL::CPUAccessFlags::Write;
+    uniformBufferDesc.miscFlags = LLGL::MiscFlags::DynamicUsage;
+    uniformBufferDesc.debugName = "MatricesBuffer";
+    return llgl_renderer->CreateBuffer(uniformBufferDesc);
+}
+
+LLGL::Sampler* create_model_sampler(LLGL::RenderSystemPtr& llgl_renderer) {
+    LLGL::SamplerDescriptor modelSamplerDesc;
+    modelSamplerDesc.maxAnisotropy = 8;
+    modelSamplerDesc.addressModeU = LLGL::SamplerAddressMode::Repeat;
+    modelSamplerDesc.addressModeV = LLGL::SamplerAddressMode::Repeat;
+    return llgl_renderer->CreateSampler(modelSamplerDesc);
+}
+
+} // anonymous namespace
+
+Matrices compute_model_matrices(const OrbitCamera& camera, const Math::Vec3& modelCenter, float rotationY,
+                                float rotationX, float aspect) {
+    Matrices matrices;
+
+    // Model matrix (rotation around center)
+    matrices.model = Math::Mat4::translate(-modelCenter);
+    matrices.model = Math::Mat4::rotateY(rotationY) * matrices.model;
+    matrices.model = Math::Mat4::rotateX(rotationX) * matrices.model;
+    matrices.model = Math::Mat4::translate(modelCenter) * matrices.model;
+
+    // View matrix from camera
+    matrices.view = camera.getViewMatrix();
+
+    // Projection matrix
+    matrices.projection = Math::Mat4::perspective(3.14159f / 4.0f, aspect, 0.1f, 1000.0f);
+
+    return matrices;
+}
+
+void ModelRenderer::init(LLGL::RenderSystemPtr& renderer, const LLGL::RenderPass* renderPass,
+                         const LLGL::VertexFormat& vertexFormat) {
+    uniformBuffer_ = create_uniform_buffer(renderer, sizeof(Matrices));
+    uploadOffset_ = 0;
+    uploadEnd_ = 0;
+
+    renderPass_ = renderPass;
+    vertexFormat_ = vertexFormat;
+
+    // Fallback while the others compile
+    acquireVariant(renderer, 0);
+
+    // Sampler for model textures
+    sampler_ = create_model_sampler(renderer);
+}
+
+void ModelRenderer::release(LLGL::RenderSystemPtr& renderer) {
+    for (auto& [features, variant] : variants_) {
+        release_pipeline(renderer, variant.pipeline);
+        if (variant.prepassPipeline) {
+            release_pipeline(renderer, variant.prepassPipeline);
+        }
+        release_pipeline_layout(renderer, variant.layout);
+    }
+    variants_.clear();
+    if (depthPipeline_) {
+        release_pipeline(renderer, depthPipeline_);
+        depthPipeline_.reset();
+    }
+    depthPrepass_ = false;
+    release_pipeline_layout(renderer, depthPipelineLayout_);
+    depthPipelineLayout_ = nullptr;
+    if (uniformBuffer_) {
+        renderer->Release(*uniformBuffer_);
+        uniformBuffer_ = nullptr;
+    }
+    if (sampler_) {
+        renderer->Release(*sampler_);
+        sampler_ = nullptr;
+    }
+}
+
+AsyncPipelineRef ModelRenderer::acquireModelPipeline(LLGL::RenderSystemPtr& renderer,
+                                                    const LLGL::VertexFormat& vertexFormat, const std::string& name,
+                                                    const std::vector<std::string>& defines,
+                                                    LLGL::PipelineLayout* layout, DepthMode depthMode, bool wait) {
+    // All model pipelines cull back faces
+    PipelineRequest request;
+    request.shaderName = name;
+    request.defines = defines;
+    request.vertexFormat = vertexFormat;
+    request.pipelineLayout = layout;
+    request.renderPass = renderPass_;
+    request.depthMode = depthMode;
+    request.cullMode = LLGL::CullMode::Back;
+    AsyncPipelineRef pipeline = acquire_pipeline_async(renderer, request);
+    if (wait) {
+        wait_for_pipeline(renderer, pipeline);
+    }
+    return pipeline;
+}
+
+LLGL::PipelineLayout* ModelRenderer::createReflectedLayout(LLGL::RenderSystemPtr& renderer, const std::string& name,
+                                                          const std::vector<std::string>& defines) {
+    const std::shared_ptr<const ShaderReflection> reflection = reflect_shaders(name, defines);
+    log_shader_reflection(shader_variant_name(name, defines), *reflection);
+
+    // Widen the upload to what this shader reads of the Matrices block
+    if (const UniformBlockReflection* block = reflection->findUniformBlock("Matrices")) {
+        if (block->usedSize() > 0) {
+            const uint32_t end = block->usedOffset() + block->usedSize();
+            uploadOffset_ = uploadEnd_ == 0 ? block->usedOffset() : std::min(uploadOffset_, block->usedOffset());
+            uploadEnd_ = std::max(uploadEnd_, end);
+        }
+    }
+    return acquire_pipeline_layout(renderer, make_pipeline_layout_desc(*reflection));
+}
+
+ModelRenderer::VariantPipelines& ModelRenderer::acquireVariant(LLGL::RenderSystemPtr& renderer, uint32_t features) {
+    auto it = variants_.find(features);
+    if (it != variants_.end()) {
+        return it->second;
+    }
+
+    PROFILE_SCOPE("ModelRenderer::acquireVariant");
+    const std::vector<std::string> defines = model_shader_defines(features);
+    // The fallback is always waited on so that every mesh can be drawn from the first frame
+    const bool wait = features == 0 || !asyncPipelines_;
+    VariantPipelines& variant = variants_[features];
+    variant.layout = createReflectedLayout(renderer, "model", defines);
+    variant.pipeline = acquireModelPipeline(renderer, vertexFormat_, "model", defines, variant.layout,
+                                            DepthMode::TestAndWrite, wait);
+    if (depthPipeline_) {
+        variant.prepassPipeline = acquireModelPipeline(renderer, vertexFormat_, "model", defines, variant.layout,
+                                                       DepthMode::PrepassEqual, !asyncPipelines_);
+    }
+    log_info(LogCategory::Render, "Shader variants: %s requested, %zu live\n",
+             shader_variant_name("model", defines).c_str(), variants_.size());
+    return variant;
+}
+
+void ModelRenderer::prepare(LLGL::RenderSystemPtr& renderer, Model& model) {
+    const auto& materials = model.getMaterials();
+    for (const auto& mesh : model.getMeshes()) {
+        acquireVariant(renderer, model_shader_features(mesh, materials));
+    }
+    if (depthPrepass_) {
+        model.createPositionBuffers(renderer);
+    }
+}
+
+bool ModelRenderer::isPrepassReady() const {
+    if (!depthPrepass_ || !depthPipeline_->get()) {
+        return false;
+    }
+    for (const auto& [features, variant] : variants_) {
+        if (!variant.prepassPipeline->get()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ModelRenderer::updateMatrices(LLGL::RenderSystemPtr& renderer, const Matrices& matrices) {
+    if (uploadEnd_ > uploadOffset_) {
+        renderer->WriteBuffer(*uniformBuffer_, uploadOffset_, reinterpret_cast<const char*>(&matrices) + uploadOffset_,
+                              uploadEnd_ - uploadOffset_);
+    }
+}
+
+void ModelRenderer::setDepthPrepass(LLGL::RenderSystemPtr& renderer, Model& model, bool enabled) {
+    depthPrepass_ = enabled;
+    if (!enabled) {
+        return;
+    }
+    model.createPositionBuffers(renderer);
+    if (depthPipeline_) {
+        return;
+    }
+
+    PROFILE_SCOPE("ModelRenderer::setDepthPrepass");
+    const bool wait = !asyncPipelines_;
+    depthPipelineLayout_ = createReflectedLayout(renderer, "depth", {});
+    depthPipeline_ = acquireModelPipeline(renderer, createPositionVertexFormat(), "depth", {}, depthPipelineLayout_,
+                                          DepthMode::PrepassWrite, wait);
+    for (auto& [features, variant] : variants_) {
+        variant.prepassPipeline = acquireModelPipeline(renderer, vertexFormat_, "model", model_shader_defines(features),
+                                                       variant.layout, DepthMode::PrepassEqual, wait);
+    }
+}
+
+DrawStats ModelRenderer::renderDepthPrepass(LLGL::CommandBuffer& cmdBuffer, const Model& model) {
+    DrawStats stats;
+    if (!isPrepassReady()) {
+        return stats;
+    }
+
+    PROFILE_SCOPE("ModelRenderer::renderDepthPrepass");
+    cmdBuffer.SetPipelineState(*depthPipeline_->get());
+    cmdBuffer.SetResource(0, *uniformBuffer_);
+    stats.pipelineBinds++;
+    stats.resourceBinds++;
+
+    for (const auto& mesh : model.getMeshes()) {
+        cmdBuffer.SetVertexBuffer(*mesh.positionBuffer);
+        cmdBuffer.SetIndexBuffer(*mesh.indexBuffer);
+        cmdBuffer.DrawIndexed(mesh.indexCount(), 0);
+        stats.drawCalls++;
+        stats.triangles += mesh.indexCount() / 3;
+    }
+    return stats;
+}
+
+DrawStats ModelRenderer::render(LLGL::CommandBuffer& cmdBuffer, const Model& model) {
+    PROFILE_SCOPE("ModelRenderer::render");
+    DrawStats stats;
+    // Without the pre-pass pipelines the depth buffer is empty, so shade with the regular ones
+    const bool prepass = isPrepassReady();
+    auto variantPipeline = [&](const VariantPipelines& variant) {
+        return (prepass ? variant.prepassPipeline : variant.pipeline)->get();
+    };
+    LLGL::PipelineState* fallbackPipeline = variantPipeline(variants_.at(0));
+    const auto& meshes = model.getMeshes();
+    const auto& materials = model.getMaterials();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const auto& mesh = meshes[i];
+        uint32_t features = model_shader_features(mesh, materials);
+
+        // Permutation not prepared or still compiling: draw untextured with the fallback
+        LLGL::PipelineState* pipeline = fallbackPipeline;
+        if (features != 0) {
+            auto it = variants_.find(features);
+            LLGL::PipelineState* variant = it != variants_.end() ? variantPipeline(it->second) : nullptr;
+            if (variant) {
+                pipeline = variant;
+            } else {
+                features = 0;
+                stats.fallbackDraws++;
+            }
+        }
+
+        // Set the permutation's pipeline and resources
+        cmdBuffer.SetPipelineState(*pipeline);
+        if (features & MODEL_SHADER_TEXTURE) {
+            LLGL::Texture* meshTexture = materials[mesh.materialIndex].diffuseTexture;
+            cmdBuffer.SetResource(0, *uniformBuffer_);
+            cmdBuffer.SetResource(1, *meshTexture);
+            cmdBuffer.SetResource(2, *sampler_);
+            stats.resourceBinds += 3;
+        } else {
+            cmdBuffer.SetResource(0, *uniformBuffer_);
+            stats.resourceBinds += 1;
+        }
+        stats.pipelineBinds++;
+
+        // Draw mesh
+        cmdBuffer.SetVertexBuffer(*mesh.vertexBuffer);
+        cmdBuffer.SetIndexBuffer(*mesh.indexBuffer);
+        cmdBuffer.DrawIndexed(mesh.indexCount(), 0);
+        stats.drawCalls++;
+        stats.triangles += mesh.indexCount() / 3;
+    }
+    return stats;
+}
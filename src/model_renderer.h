@@ -0,0 +1,132 @@
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include <LLGL/LLGL.h>
+#include <LLGL/Utils/VertexFormat.h>
+
+#include "math_types.h"
+#include "camera.h"
+#include "model_loader.h"
+
+struct AsyncPipeline;
+struct TranslatedShaders;
+
+// Uniform buffer layout shared by the model shaders
+struct Matrices {
+    Math::Mat4 model;
+    Math::Mat4 view;
+    Math::Mat4 projection;
+};
+
+// Builds the model/view/projection matrices for a model rotated around its center
+Matrices compute_model_matrices(const OrbitCamera& camera, const Math::Vec3& modelCenter, float rotationY,
+                                float rotationX, float aspect);
+
+// Depth state of pipelines built by create_pipeline
+enum class DepthMode {
+    Disabled,
+    TestAndWrite, // Less, writes depth
+    PrepassWrite, // Less, writes depth but no color (depth pre-pass)
+    PrepassEqual, // LessEqual against the pre-pass depth, no depth writes
+};
+
+// Commands recorded by ModelRenderer::render
+struct DrawStats {
+    uint32_t drawCalls = 0;
+    uint64_t triangles = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t resourceBinds = 0;
+    uint32_t fallbackDraws = 0; // Drawn with the fallback pipeline because theirs is still compiling
+};
+
+// GPU state and draw recording for a Model. Works with any render pass (swap chain or offscreen target).
+class ModelRenderer {
+  public:
+    // Call before init. Pipelines then compile in the background (pump_pipeline_compilation); until a
+    // pipeline is ready its meshes are drawn untextured with the featureless model permutation, which is
+    // always created up front, and the depth pre-pass is skipped.
+    void setAsyncPipelines(bool enabled) {
+        asyncPipelines_ = enabled;
+    }
+
+    void init(LLGL::RenderSystemPtr& renderer, const LLGL::RenderPass* renderPass,
+              const LLGL::VertexFormat& vertexFormat);
+    void release(LLGL::RenderSystemPtr& renderer);
+
+    // Uploads the part of the block the live shaders read (see getUniformUploadBytes)
+    void updateMatrices(LLGL::RenderSystemPtr& renderer, const Matrices& matrices);
+    uint32_t getUniformUploadBytes() const {
+        return uploadEnd_ - uploadOffset_;
+    }
+
+    // Acquires the model shader permutations the meshes of a model need (shader_variants.h). Permutations
+    // are compiled on first use and kept for later models; call after loading a model, before render().
+    void prepare(LLGL::RenderSystemPtr& renderer, Model& model);
+    size_t getLiveVariantCount() const {
+        return variants_.size();
+    }
+
+    // Enables the depth pre-pass; its pipelines and the model's position streams are created on first use.
+    // Models prepared while it is enabled get their streams from prepare().
+    void setDepthPrepass(LLGL::RenderSystemPtr& renderer, Model& model, bool enabled);
+    bool getDepthPrepass() const {
+        return depthPrepass_;
+    }
+
+    // Lays down depth from the position-only streams. With the pre-pass enabled, call inside the render
+    // pass before render(), which then only shades the front-most fragment of each pixel.
+    DrawStats renderDepthPrepass(LLGL::CommandBuffer& cmdBuffer, const Model& model);
+
+    // Records the draw commands for every mesh; must be called inside a render pass. Meshes whose
+    // permutation was not prepared are drawn with the fallback.
+    DrawStats render(LLGL::CommandBuffer& cmdBuffer, const Model& model);
+
+  private:
+    // Pipelines of one model shader permutation
+    struct VariantPipelines {
+        LLGL::PipelineLayout* layout = nullptr; // From the permutation's reflection
+        std::shared_ptr<AsyncPipeline> pipeline;
+        std::shared_ptr<AsyncPipeline> prepassPipeline; // Shading after the pre-pass, null while it is disabled
+    };
+
+    VariantPipelines& acquireVariant(LLGL::RenderSystemPtr& renderer, uint32_t features);
+    LLGL::PipelineLayout* createReflectedLayout(LLGL::RenderSystemPtr& renderer, const std::string& name,
+                                                const std::vector<std::string>& defines);
+    std::shared_ptr<AsyncPipeline> acquireModelPipeline(LLGL::RenderSystemPtr& renderer,
+                                                        const LLGL::VertexFormat& vertexFormat,
+                                                        const std::string& name,
+                                                        const std::vector<std::string>& defines,
+                                                        LLGL::PipelineLayout* layout, DepthMode depthMode, bool wait);
+    bool isPrepassReady() const;
+
+    bool asyncPipelines_ = false;
+    LLGL::Buffer* uniformBuffer_ = nullptr;
+    uint32_t uploadOffset_ = 0; // Byte range of Matrices read by any live shader
+    uint32_t uploadEnd_ = 0;
+    std::map<uint32_t, VariantPipelines> variants_; // By feature bits; 0 is the fallback, never asynchronous
+
+    const LLGL::RenderPass* renderPass_ = nullptr;
+    bool depthPrepass_ = false;
+    LLGL::PipelineLayout* depthPipelineLayout_ = nullptr;
+    std::shared_ptr<AsyncPipeline> depthPipeline_;
+    LLGL::VertexFormat vertexFormat_;
+    LLGL::Sampler* sampler_ = nullptr;
+};
+
+LLGL::PipelineState* create_pipeline(LLGL::RenderSystemPtr& llgl_renderer, const LLGL::RenderPass* renderPass,
+                                     std::vector<LLGL::ShadingLanguage> languages,
+                                     const LLGL::VertexFormat& vertexFormat, std::string name,
+                                     LLGL::PipelineLayout* pipelineLayout = nullptr,
+                                     DepthMode depthMode = DepthMode::Disabled,
+                                     LLGL::CullMode cullMode = LLGL::CullMode::Disabled);
+
+// Second half of create_pipeline, for shaders translated ahead of time (pipeline registry).
+// Must run on the render thread.
+LLGL::PipelineState* create_pipeline_from_shaders(LLGL::RenderSystemPtr& llgl_renderer,
+                                                  const LLGL::RenderPass* renderPass,
+                                                  const TranslatedShaders& shaders,
+                                                  LLGL::PipelineLayout* pipelineLayout = nullptr,
+                                                  DepthMode depthMode = DepthMode::Disabled,
+                                                  LLGL::CullMode cullMode = LLGL::CullMode::Disabled);
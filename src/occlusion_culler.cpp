@@ -0,0 +1,346 @@
+#include "occlusion_culler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_CULLER_SSE2 1
+#endif
+
+#include "profiler.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float EMPTY_DEPTH = 1.0f;
+constexpr float MIN_CLIP_W = 1.0e-5f;
+constexpr uint32_t ROWS_PER_BAND = 8;
+constexpr uint32_t CHUNKS_PER_THREAD = 4;
+
+double millisecondsBetween(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct ClipVertex {
+    float x, y, z, w;
+};
+
+ClipVertex transformPoint(const Math::Mat4& matrix, const Math::Vec3& point) {
+    ClipVertex result;
+    result.x = matrix(0, 0) * point.x + matrix(0, 1) * point.y + matrix(0, 2) * point.z + matrix(0, 3);
+    result.y = matrix(1, 0) * point.x + matrix(1, 1) * point.y + matrix(1, 2) * point.z + matrix(1, 3);
+    result.z = matrix(2, 0) * point.x + matrix(2, 1) * point.y + matrix(2, 2) * point.z + matrix(2, 3);
+    result.w = matrix(3, 0) * point.x + matrix(3, 1) * point.y + matrix(3, 2) * point.z + matrix(3, 3);
+    return result;
+}
+
+// Corner i has bit 0/1/2 selecting max x/y/z
+Math::Vec3 boxCorner(const Math::AABB& box, int i) {
+    return { (i & 1) ? box.maxPoint.x : box.minPoint.x, (i & 2) ? box.maxPoint.y : box.minPoint.y,
+             (i & 4) ? box.maxPoint.z : box.minPoint.z };
+}
+
+// Two triangles per face; winding doesn't matter, the rasterizer accepts both
+constexpr int BOX_TRIANGLES[12][3] = {
+    { 0, 2, 3 }, { 0, 3, 1 }, { 4, 5, 7 }, { 4, 7, 6 }, { 0, 1, 5 }, { 0, 5, 4 },
+    { 2, 6, 7 }, { 2, 7, 3 }, { 0, 4, 6 }, { 0, 6, 2 }, { 1, 3, 7 }, { 1, 7, 5 },
+};
+
+// Runs fn(begin, end) over [0, count) split into about taskCount ranges, on the pool if there is one
+template <typename F> void parallelFor(ThreadPool* pool, uint32_t count, uint32_t taskCount, F&& fn) {
+    taskCount = std::max(1u, std::min(taskCount, count));
+    if (!pool || taskCount == 1) {
+        fn(0u, count);
+        return;
+    }
+    const uint32_t step = (count + taskCount - 1) / taskCount;
+    std::vector<std::future<void>> tasks;
+    for (uint32_t begin = step; begin < count; begin += step) {
+        const uint32_t end = std::min(begin + step, count);
+        tasks.push_back(pool->submit([&fn, begin, end]() { fn(begin, end); }));
+    }
+    // The calling thread takes the first range instead of idling
+    fn(0u, std::min(step, count));
+    for (auto& task : tasks) {
+        task.get();
+    }
+}
+
+} // anonymous namespace
+
+void OcclusionCuller::init(uint32_t width, uint32_t height, size_t threadCount) {
+    width_ = (std::max(width, 4u) + 3u) & ~3u;
+    height_ = std::max(height, 1u);
+    depth_.assign(static_cast<size_t>(width_) * height_, EMPTY_DEPTH);
+    triangles_.clear();
+
+    pool_ = std::make_unique<ThreadPool>(threadCount);
+    if (pool_->getThreadCount() <= 1) {
+        pool_.reset();
+    }
+}
+
+void OcclusionCuller::clearOccluders() {
+    triangles_.clear();
+}
+
+void OcclusionCuller::addOccluderBox(const Math::AABB& box, const Math::Mat4& modelViewProjection) {
+    const float width = static_cast<float>(width_);
+    const float height = static_cast<float>(height_);
+
+    float screenX[8], screenY[8], depth[8];
+    for (int i = 0; i < 8; i++) {
+        const ClipVertex clip = transformPoint(modelViewProjection, boxCorner(box, i));
+        // Boxes crossing the near plane are skipped rather than clipped; that only loses occlusion
+        if (clip.w < MIN_CLIP_W || clip.z < -clip.w) {
+            return;
+        }
+        const float invW = 1.0f / clip.w;
+        screenX[i] = (clip.x * invW * 0.5f + 0.5f) * width;
+        screenY[i] = (0.5f - clip.y * invW * 0.5f) * height;
+        depth[i] = clip.z * invW * 0.5f + 0.5f;
+    }
+
+    for (const auto& indices : BOX_TRIANGLES) {
+        const float x0 = screenX[indices[0]], y0 = screenY[indices[0]];
+        const float x1 = screenX[indices[1]], y1 = screenY[indices[1]];
+        const float x2 = screenX[indices[2]], y2 = screenY[indices[2]];
+
+        Triangle triangle;
+        triangle.minX = std::max(0, static_cast<int>(std::floor(std::min({ x0, x1, x2 }))));
+        triangle.maxX = std::min(static_cast<int>(width_) - 1, static_cast<int>(std::floor(std::max({ x0, x1, x2 }))));
+        triangle.minY = std::max(0, static_cast<int>(std::floor(std::min({ y0, y1, y2 }))));
+        triangle.maxY = std::min(static_cast<int>(height_) - 1, static_cast<int>(std::floor(std::max({ y0, y1, y2 }))));
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+            continue;
+        }
+
+        const float ax[3] = { x0, x1, x2 };
+        const float ay[3] = { y0, y1, y2 };
+        for (int edge = 0; edge < 3; edge++) {
+            const int next = (edge + 1) % 3;
+            triangle.edgeA[edge] = ay[edge] - ay[next];
+            triangle.edgeB[edge] = ax[next] - ax[edge];
+            triangle.edgeC[edge] = ax[edge] * ay[next] - ay[edge] * ax[next];
+        }
+
+        // Flip the edges of clockwise triangles so the inside is always positive
+        const float area = triangle.edgeC[0] + triangle.edgeC[1] + triangle.edgeC[2];
+        if (std::abs(area) < 1.0e-6f) {
+            continue;
+        }
+        if (area < 0.0f) {
+            for (int edge = 0; edge < 3; edge++) {
+                triangle.edgeA[edge] = -triangle.edgeA[edge];
+                triangle.edgeB[edge] = -triangle.edgeB[edge];
+                triangle.edgeC[edge] = -triangle.edgeC[edge];
+            }
+        }
+
+        // Farthest vertex depth for the whole triangle keeps the buffer conservative
+        triangle.depth = std::max({ depth[indices[0]], depth[indices[1]], depth[indices[2]] });
+        triangles_.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::rasterizeOccluders() {
+    PROFILE_SCOPE("OcclusionCuller::rasterize");
+    const uint32_t bands = (height_ + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+    const uint32_t taskCount = pool_ ? static_cast<uint32_t>(pool_->getThreadCount()) : 1u;
+    parallelFor(pool_.get(), bands, taskCount, [this](uint32_t bandBegin, uint32_t bandEnd) {
+        rasterizeRows(static_cast<int>(bandBegin * ROWS_PER_BAND),
+                      static_cast<int>(std::min(bandEnd * ROWS_PER_BAND, height_)));
+    });
+}
+
+void OcclusionCuller::rasterizeRows(int rowBegin, int rowEnd) {
+    std::fill(depth_.begin() + static_cast<size_t>(rowBegin) * width_,
+              depth_.begin() + static_cast<size_t>(rowEnd) * width_, EMPTY_DEPTH);
+
+    for (const Triangle& triangle : triangles_) {
+        const int minY = std::max(triangle.minY, rowBegin);
+        const int maxY = std::min(triangle.maxY, rowEnd - 1);
+        const int startX = triangle.minX & ~3;
+
+        for (int y = minY; y <= maxY; y++) {
+            const float pixelY = static_cast<float>(y) + 0.5f;
+            float* row = &depth_[static_cast<size_t>(y) * width_];
+
+#ifdef OCCLUSION_CULLER_SSE2
+            // Edge values of 4 horizontally adjacent pixel centers, stepped by 4 * A per iteration
+            const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 startPixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(startX)), offsets);
+            __m128 edge[3], edgeStep[3];
+            for (int i = 0; i < 3; i++) {
+                const __m128 a = _mm_set1_ps(triangle.edgeA[i]);
+                edge[i] = _mm_add_ps(_mm_mul_ps(a, startPixelX),
+                                     _mm_set1_ps(triangle.edgeB[i] * pixelY + triangle.edgeC[i]));
+                edgeStep[i] = _mm_mul_ps(a, _mm_set1_ps(4.0f));
+            }
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 triangleDepth = _mm_set1_ps(triangle.depth);
+            for (int x = startX; x <= triangle.maxX; x += 4) {
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge[0], zero), _mm_cmpge_ps(edge[1], zero)),
+                                                 _mm_cmpge_ps(edge[2], zero));
+                const __m128 current = _mm_loadu_ps(row + x);
+                const __m128 candidate = _mm_or_ps(_mm_and_ps(inside, triangleDepth), _mm_andnot_ps(inside, current));
+                _mm_storeu_ps(row + x, _mm_min_ps(current, candidate));
+                for (int i = 0; i < 3; i++) {
+                    edge[i] = _mm_add_ps(edge[i], edgeStep[i]);
+                }
+            }
+#else
+            for (int x = triangle.minX; x <= triangle.maxX; x++) {
+                const float pixelX = static_cast<float>(x) + 0.5f;
+                bool inside = true;
+                for (int i = 0; i < 3; i++) {
+                    const float edge = triangle.edgeA[i] * pixelX + triangle.edgeB[i] * pixelY + triangle.edgeC[i];
+                    inside = inside && edge >= 0.0f;
+                }
+                if (inside) {
+                    row[x] = std::min(row[x], triangle.depth);
+                }
+            }
+#endif
+        }
+    }
+}
+
+OcclusionCuller::TestResult OcclusionCuller::testBounds(const Math::AABB& worldBounds,
+                                                        const Math::Mat4& viewProjection) const {
+    float minX = 1.0e30f, minY = 1.0e30f, maxX = -1.0e30f, maxY = -1.0e30f;
+    float nearestDepth = 1.0e30f;
+    int behindNear = 0;
+    for (int i = 0; i < 8; i++) {
+        const ClipVertex clip = transformPoint(viewProjection, boxCorner(worldBounds, i));
+        if (clip.w < MIN_CLIP_W || clip.z < -clip.w) {
+            behindNear++;
+            continue;
+        }
+        const float invW = 1.0f / clip.w;
+        minX = std::min(minX, clip.x * invW);
+        maxX = std::max(maxX, clip.x * invW);
+        minY = std::min(minY, clip.y * invW);
+        maxY = std::max(maxY, clip.y * invW);
+        nearestDepth = std::min(nearestDepth, clip.z * invW * 0.5f + 0.5f);
+    }
+    if (behindNear == 8) {
+        return TestResult::OutsideFrustum;
+    }
+    if (behindNear > 0) {
+        // Crosses the near plane, the projected rectangle isn't reliable
+        return TestResult::Visible;
+    }
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f || nearestDepth > 1.0f) {
+        return TestResult::OutsideFrustum;
+    }
+
+    const float width = static_cast<float>(width_);
+    const float height = static_cast<float>(height_);
+    const int lastX = static_cast<int>(width_) - 1;
+    const int lastY = static_cast<int>(height_) - 1;
+    const int x0 = std::clamp(static_cast<int>(std::floor((minX * 0.5f + 0.5f) * width)), 0, lastX);
+    const int x1 = std::clamp(static_cast<int>(std::floor((maxX * 0.5f + 0.5f) * width)), 0, lastX);
+    const int y0 = std::clamp(static_cast<int>(std::floor((0.5f - maxY * 0.5f) * height)), 0, lastY);
+    const int y1 = std::clamp(static_cast<int>(std::floor((0.5f - minY * 0.5f) * height)), 0, lastY);
+
+    // Visible as soon as one pixel of the rectangle is at least as far as the nearest corner. The SIMD path
+    // also reads the pixels up to the next multiple of 4, which can only make the result more conservative.
+    for (int y = y0; y <= y1; y++) {
+        const float* row = &depth_[static_cast<size_t>(y) * width_];
+#ifdef OCCLUSION_CULLER_SSE2
+        const __m128 objectDepth = _mm_set1_ps(nearestDepth);
+        for (int x = x0 & ~3; x <= x1; x += 4) {
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), objectDepth)) != 0) {
+                return TestResult::Visible;
+            }
+        }
+#else
+        for (int x = x0; x <= x1; x++) {
+            if (row[x] >= nearestDepth) {
+                return TestResult::Visible;
+            }
+        }
+#endif
+    }
+    return TestResult::Occluded;
+}
+
+CullStats OcclusionCuller::cull(const StressScene& scene, const Math::Mat4& viewProjection, const Math::Vec3& eye,
+                                std::vector<uint32_t>& visibleObjects) {
+    PROFILE_SCOPE("OcclusionCuller::cull");
+    CullStats stats;
+    const auto& objects = scene.getObjects();
+    const auto& instances = scene.getInstances();
+    const uint32_t count = static_cast<uint32_t>(objects.size());
+    stats.tested = count;
+
+    // Occluders: the objects with the largest angular size
+    const auto selectStart = Clock::now();
+    std::vector<uint32_t> candidates(count);
+    std::iota(candidates.begin(), candidates.end(), 0u);
+    const uint32_t occluderCount = std::min(maxOccluders_, count);
+    auto angularSize = [&objects, &eye](uint32_t i) {
+        const Math::Vec3 toObject = objects[i].bounds.center() - eye;
+        return objects[i].bounds.radius() / std::max(toObject.length(), 1.0e-3f);
+    };
+    std::nth_element(candidates.begin(), candidates.begin() + occluderCount, candidates.end(),
+                     [&angularSize](uint32_t a, uint32_t b) { return angularSize(a) > angularSize(b); });
+
+    clearOccluders();
+    for (uint32_t i = 0; i < occluderCount; i++) {
+        const uint32_t objectIndex = candidates[i];
+        addOccluderBox(scene.getOccluderBoxes()[objects[objectIndex].meshIndex],
+                       viewProjection * instances[objectIndex].model);
+    }
+    stats.occluders = occluderCount;
+    stats.occluderTriangles = static_cast<uint32_t>(triangles_.size());
+    const auto rasterStart = Clock::now();
+
+    rasterizeOccluders();
+    const auto testStart = Clock::now();
+
+    // Each chunk keeps its visible indices in order, so concatenating them keeps the list ascending
+    const uint32_t chunkCount = pool_ ? static_cast<uint32_t>(pool_->getThreadCount()) * CHUNKS_PER_THREAD : 1u;
+    const uint32_t chunkSize = (count + chunkCount - 1) / std::max(chunkCount, 1u);
+    std::vector<std::vector<uint32_t>> chunkVisible(chunkCount);
+    std::vector<uint32_t> chunkFrustumCulled(chunkCount, 0);
+    std::vector<uint32_t> chunkOccluded(chunkCount, 0);
+    parallelFor(pool_.get(), count, chunkCount, [&](uint32_t begin, uint32_t end) {
+        PROFILE_SCOPE("OcclusionCuller::test");
+        const uint32_t chunk = begin / std::max(chunkSize, 1u);
+        auto& visible = chunkVisible[chunk];
+        visible.reserve(end - begin);
+        for (uint32_t i = begin; i < end; i++) {
+            switch (testBounds(objects[i].bounds, viewProjection)) {
+                case TestResult::Visible:
+                    visible.push_back(i);
+                    break;
+                case TestResult::OutsideFrustum:
+                    chunkFrustumCulled[chunk]++;
+                    break;
+                case TestResult::Occluded:
+                    chunkOccluded[chunk]++;
+                    break;
+            }
+        }
+    });
+
+    visibleObjects.clear();
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+        visibleObjects.insert(visibleObjects.end(), chunkVisible[chunk].begin(), chunkVisible[chunk].end());
+        stats.frustumCulled += chunkFrustumCulled[chunk];
+        stats.occluded += chunkOccluded[chunk];
+    }
+    const auto testEnd = Clock::now();
+
+    stats.selectMs = millisecondsBetween(selectStart, rasterStart);
+    stats.rasterMs = millisecondsBetween(rasterStart, testStart);
+    stats.testMs = millisecondsBetween(testStart, testEnd);
+    return stats;
+}
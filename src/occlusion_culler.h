@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "math_types.h"
+#include "stress_scene.h"
+#include "thread_pool.h"
+
+struct CullStats {
+    uint32_t tested = 0;
+    uint32_t frustumCulled = 0;
+    uint32_t occluded = 0;
+    uint32_t occluders = 0;
+    uint32_t occluderTriangles = 0;
+    double selectMs = 0.0; // Occluder selection and triangle setup
+    double rasterMs = 0.0;
+    double testMs = 0.0;
+
+    uint32_t visible() const {
+        return tested - frustumCulled - occluded;
+    }
+    double totalMs() const {
+        return selectMs + rasterMs + testMs;
+    }
+};
+
+// CPU occlusion culling against a low-resolution depth buffer, no GPU involved.
+// The objects covering the most screen are rasterized as occluders, using their inner boxes
+// (StressScene::getOccluderBoxes) and the farthest vertex depth per triangle so the buffer never
+// claims more occlusion than the real geometry. Then the screen rectangle and nearest depth of every
+// object's bounds are tested against it. Rasterization (in row bands) and testing (in object chunks)
+// run on worker threads, 4 pixels at a time with SSE2 where available.
+class OcclusionCuller {
+  public:
+    static constexpr uint32_t DEFAULT_WIDTH = 256;
+    static constexpr uint32_t DEFAULT_HEIGHT = 128;
+
+    enum class TestResult { Visible, OutsideFrustum, Occluded };
+
+    // The width is rounded up to a multiple of 4. A thread count of 0 uses one worker per hardware thread.
+    void init(uint32_t width = DEFAULT_WIDTH, uint32_t height = DEFAULT_HEIGHT, size_t threadCount = 0);
+
+    // Fills visibleObjects with the ascending indices of all objects that may be visible
+    CullStats cull(const StressScene& scene, const Math::Mat4& viewProjection, const Math::Vec3& eye,
+                   std::vector<uint32_t>& visibleObjects);
+
+    void setMaxOccluders(uint32_t count) {
+        maxOccluders_ = count;
+    }
+    uint32_t getMaxOccluders() const {
+        return maxOccluders_;
+    }
+
+    // Individual steps of cull(), public for benchmarks and debugging
+    void clearOccluders();
+    void addOccluderBox(const Math::AABB& box, const Math::Mat4& modelViewProjection);
+    void rasterizeOccluders();
+    TestResult testBounds(const Math::AABB& worldBounds, const Math::Mat4& viewProjection) const;
+
+    // Row-major, top row first, depth in [0, 1] with 1 = nothing rasterized
+    const std::vector<float>& getDepthBuffer() const {
+        return depth_;
+    }
+    uint32_t getWidth() const {
+        return width_;
+    }
+    uint32_t getHeight() const {
+        return height_;
+    }
+
+  private:
+    // Screen-space triangle with edge functions A*x + B*y + C >= 0 inside
+    struct Triangle {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        float depth;
+        int minX, maxX, minY, maxY;
+    };
+
+    void rasterizeRows(int rowBegin, int rowEnd);
+
+    std::unique_ptr<ThreadPool> pool_;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint32_t maxOccluders_ = 32;
+    std::vector<float> depth_;
+    std::vector<Triangle> triangles_;
+};
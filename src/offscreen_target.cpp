@@ -0,0 +1,87 @@
+#include "offscreen_target.h"
+
+#include <cstring>
+
+#include <stb_image_write.h>
+
+#include "logger.h"
+
+bool OffscreenTarget::create(LLGL::RenderSystemPtr& renderer, const LLGL::Extent2D& resolution) {
+    resolution_ = resolution;
+
+    LLGL::TextureDescriptor colorDesc;
+    colorDesc.type = LLGL::TextureType::Texture2D;
+    colorDesc.format = LLGL::Format::RGBA8UNorm;
+    colorDesc.extent = { resolution.width, resolution.height, 1 };
+    colorDesc.bindFlags = LLGL::BindFlags::ColorAttachment | LLGL::BindFlags::Sampled | LLGL::BindFlags::CopySrc;
+    colorDesc.mipLevels = 1;
+    colorDesc.debugName = "OffscreenColor";
+    colorTexture_ = renderer->CreateTexture(colorDesc);
+    if (colorTexture_ == nullptr) {
+        log_error(LogCategory::Render, "Failed to create offscreen color texture\n");
+        return false;
+    }
+
+    LLGL::RenderTargetDescriptor targetDesc;
+    targetDesc.resolution = resolution;
+    targetDesc.colorAttachments[0] = colorTexture_;
+    targetDesc.depthStencilAttachment = LLGL::Format::D32Float;
+    targetDesc.debugName = "OffscreenTarget";
+    renderTarget_ = renderer->CreateRenderTarget(targetDesc);
+    if (renderTarget_ == nullptr) {
+        log_error(LogCategory::Render, "Failed to create offscreen render target\n");
+        return false;
+    }
+
+    return true;
+}
+
+void OffscreenTarget::release(LLGL::RenderSystemPtr& renderer) {
+    if (renderTarget_) {
+        renderer->Release(*renderTarget_);
+        renderTarget_ = nullptr;
+    }
+    if (colorTexture_) {
+        renderer->Release(*colorTexture_);
+        colorTexture_ = nullptr;
+    }
+}
+
+bool OffscreenTarget::readPixels(LLGL::RenderSystemPtr& renderer, std::vector<uint8_t>& pixels) const {
+    if (colorTexture_ == nullptr) {
+        return false;
+    }
+
+    const size_t rowSize = static_cast<size_t>(resolution_.width) * 4;
+    pixels.resize(rowSize * resolution_.height);
+
+    LLGL::TextureRegion region{ LLGL::Offset3D{ 0, 0, 0 }, LLGL::Extent3D{ resolution_.width, resolution_.height, 1 } };
+    LLGL::MutableImageView dstImageView(LLGL::ImageFormat::RGBA, LLGL::DataType::UInt8, pixels.data(),
+                                        pixels.size());
+    renderer->ReadTexture(*colorTexture_, region, dstImageView);
+
+    // OpenGL reads rows bottom-up, flip them so every backend returns the same image
+    if (renderer->GetRenderingCaps().screenOrigin == LLGL::ScreenOrigin::LowerLeft) {
+        std::vector<uint8_t> row(rowSize);
+        for (uint32_t y = 0; y < resolution_.height / 2; y++) {
+            uint8_t* top = pixels.data() + y * rowSize;
+            uint8_t* bottom = pixels.data() + (resolution_.height - 1 - y) * rowSize;
+            std::memcpy(row.data(), top, rowSize);
+            std::memcpy(top, bottom, rowSize);
+            std::memcpy(bottom, row.data(), rowSize);
+        }
+    }
+
+    return true;
+}
+
+bool OffscreenTarget::writePNG(const std::string& path, const LLGL::Extent2D& resolution,
+                               const std::vector<uint8_t>& pixels) {
+    const int stride = static_cast<int>(resolution.width * 4);
+    if (!stbi_write_png(path.c_str(), static_cast<int>(resolution.width), static_cast<int>(resolution.height), 4,
+                        pixels.data(), stride)) {
+        log_error(LogCategory::Render, "Failed to write image: %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+// Color + depth render target used instead of a swap chain for headless rendering
+class OffscreenTarget {
+  public:
+    bool create(LLGL::RenderSystemPtr& renderer, const LLGL::Extent2D& resolution);
+    void release(LLGL::RenderSystemPtr& renderer);
+
+    LLGL::RenderTarget* getRenderTarget() const {
+        return renderTarget_;
+    }
+    const LLGL::RenderPass* getRenderPass() const {
+        return renderTarget_ ? renderTarget_->GetRenderPass() : nullptr;
+    }
+    LLGL::Texture* getColorTexture() const {
+        return colorTexture_;
+    }
+    const LLGL::Extent2D& getResolution() const {
+        return resolution_;
+    }
+
+    // Copies the color attachment into tightly packed, top-down RGBA8 rows
+    bool readPixels(LLGL::RenderSystemPtr& renderer, std::vector<uint8_t>& pixels) const;
+
+    static bool writePNG(const std::string& path, const LLGL::Extent2D& resolution, const std::vector<uint8_t>& pixels);
+
+  private:
+    LLGL::Texture* colorTexture_ = nullptr;
+    LLGL::RenderTarget* renderTarget_ = nullptr;
+    LLGL::Extent2D resolution_;
+};
@@ -0,0 +1,176 @@
+#include "pipeline_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "hash.h"
+#include "logger.h"
+
+namespace {
+
+// File layout: magic, version, key length, key, blob size, blob
+constexpr char FILE_MAGIC[4] = { 'T', 'L', 'P', 'C' };
+constexpr uint32_t FILE_VERSION = 1;
+
+struct PipelineCacheState {
+    std::mutex mutex;
+    LLGL::PipelineCache* cache = nullptr;
+    std::string path;
+    std::string key;
+    PipelineCacheStats stats;
+};
+
+PipelineCacheState& state() {
+    static PipelineCacheState instance;
+    return instance;
+}
+
+// Everything that may change the backend's binary format. Only the GL renderer name carries the driver
+// version (e.g. "OpenGL 4.6.0 NVIDIA 550.54"); Vulkan and D3D report the API version there. For those the
+// pipeline cache ID tells driver builds apart (Vulkan's pipelineCacheUUID, which the driver changes whenever
+// its cache format does); D3D12 additionally rejects cached blobs of another driver version itself.
+std::string makeCacheKey(LLGL::RenderSystemPtr& renderer) {
+    const auto& info = renderer->GetRendererInfo();
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+    std::string cacheID;
+    for (char byte : info.pipelineCacheID) {
+        cacheID += HEX_DIGITS[(static_cast<unsigned char>(byte) >> 4) & 0xF];
+        cacheID += HEX_DIGITS[static_cast<unsigned char>(byte) & 0xF];
+    }
+    return info.rendererName + "\n" + info.deviceName + "\n" + info.vendorName + "\n" + info.shadingLanguageName +
+           "\n" + cacheID;
+}
+
+bool readCacheFile(const std::string& path, const std::string& key, std::vector<char>& blob) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    char magic[4] = {};
+    uint32_t version = 0, keyLength = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+    if (!file || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 || version != FILE_VERSION ||
+        keyLength != key.size()) {
+        return false;
+    }
+
+    std::string fileKey(keyLength, '\0');
+    uint64_t blobSize = 0;
+    file.read(fileKey.data(), keyLength);
+    file.read(reinterpret_cast<char*>(&blobSize), sizeof(blobSize));
+    if (!file || fileKey != key) {
+        return false;
+    }
+
+    blob.resize(static_cast<size_t>(blobSize));
+    file.read(blob.data(), static_cast<std::streamsize>(blobSize));
+    return static_cast<bool>(file);
+}
+
+bool writeCacheFile(const std::string& path, const std::string& key, const void* data, size_t size) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    // Write to a temporary file first so an interrupted run never leaves a truncated cache behind
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        const uint32_t keyLength = static_cast<uint32_t>(key.size());
+        const uint64_t blobSize = size;
+        file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&FILE_VERSION), sizeof(FILE_VERSION));
+        file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+        file.write(key.data(), keyLength);
+        file.write(reinterpret_cast<const char*>(&blobSize), sizeof(blobSize));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!file) {
+            return false;
+        }
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
+
+} // anonymous namespace
+
+void load_pipeline_cache(LLGL::RenderSystemPtr& renderer, const std::string& cacheDir) {
+    PipelineCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+    if (!renderer->GetRenderingCaps().features.hasPipelineCaching) {
+        log_warning(LogCategory::Cache, "Pipeline cache: not supported by %s\n",
+                    renderer->GetRendererInfo().rendererName.c_str());
+        return;
+    }
+
+    // One file per configuration, so switching renderers or GPUs doesn't evict the other caches
+    cacheState.key = makeCacheKey(renderer);
+    const std::string fileName = "pipelines_" + hash_to_hex(hash_string(cacheState.key)) + ".bin";
+    cacheState.path = (std::filesystem::path(cacheDir) / fileName).string();
+
+    std::vector<char> blob;
+    if (readCacheFile(cacheState.path, cacheState.key, blob) && !blob.empty()) {
+        cacheState.cache = renderer->CreatePipelineCache(LLGL::Blob::CreateCopy(blob.data(), blob.size()));
+        cacheState.stats.warm = true;
+        cacheState.stats.loadedBytes = blob.size();
+    } else {
+        cacheState.cache = renderer->CreatePipelineCache();
+    }
+    cacheState.stats.enabled = cacheState.cache != nullptr;
+
+    log_info(LogCategory::Cache, "Pipeline cache: %s (%s, %zu bytes)\n", cacheState.path.c_str(),
+             cacheState.stats.warm ? "warm" : "cold", cacheState.stats.loadedBytes);
+}
+
+void save_pipeline_cache(LLGL::RenderSystemPtr& renderer) {
+    PipelineCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+
+    const PipelineCacheStats& stats = cacheState.stats;
+    if (stats.pipelines > 0) {
+        log_info(LogCategory::Cache, "Pipeline creation: %u pipelines in %.2f ms (%s cache)\n", stats.pipelines,
+                 stats.creationMs, !stats.enabled ? "no" : (stats.warm ? "warm" : "cold"));
+    }
+    if (!cacheState.cache) {
+        return;
+    }
+
+    LLGL::Blob blob = cacheState.cache->GetBlob();
+    if (blob && blob.GetSize() > 0) {
+        if (writeCacheFile(cacheState.path, cacheState.key, blob.GetData(), blob.GetSize())) {
+            cacheState.stats.savedBytes = blob.GetSize();
+        } else {
+            log_error(LogCategory::Cache, "Failed to write pipeline cache: %s\n", cacheState.path.c_str());
+        }
+    }
+
+    renderer->Release(*cacheState.cache);
+    cacheState.cache = nullptr;
+}
+
+LLGL::PipelineCache* shared_pipeline_cache() {
+    PipelineCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+    return cacheState.cache;
+}
+
+void record_pipeline_creation(double milliseconds) {
+    PipelineCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+    cacheState.stats.pipelines++;
+    cacheState.stats.creationMs += milliseconds;
+}
+
+PipelineCacheStats pipeline_cache_stats() {
+    PipelineCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+    return cacheState.stats;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <LLGL/LLGL.h>
+
+struct PipelineCacheStats {
+    bool enabled = false; // Backend supports pipeline caching and a cache was created
+    bool warm = false;    // Started from a blob written by a previous run on the same renderer/device/driver
+    size_t loadedBytes = 0;
+    size_t savedBytes = 0;
+    uint32_t pipelines = 0; // PipelineState objects created so far
+    double creationMs = 0.0;
+};
+
+// Creates the pipeline cache shared by create_pipeline and the ImGui backend, starting from the blob in
+// cacheDir when it was written for the same renderer, device and driver. Blobs from any other
+// configuration are ignored. Without backend support shared_pipeline_cache() stays null.
+void load_pipeline_cache(LLGL::RenderSystemPtr& renderer, const std::string& cacheDir);
+
+// Writes the cache back to its file, logs the creation time and releases the cache
+void save_pipeline_cache(LLGL::RenderSystemPtr& renderer);
+
+LLGL::PipelineCache* shared_pipeline_cache();
+
+// Adds one CreatePipelineState call to the statistics (thread-safe)
+void record_pipeline_creation(double milliseconds);
+PipelineCacheStats pipeline_cache_stats();
@@ -0,0 +1,668 @@
+#include "pipeline_registry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "hash.h"
+#include "logger.h"
+#include "profiler.h"
+#include "shader_translation.h"
+#include "shader_variants.h"
+#include "thread_pool.h"
+
+namespace {
+
+constexpr const char* PREWARM_FILE_NAME = "pipeline_prewarm.txt";
+
+using TranslationFuture = std::shared_future<std::shared_ptr<TranslatedShaders>>;
+
+// Backend shaders for one shader name, source and vertex format, shared by every pipeline built from them
+struct TranslationEntry {
+    std::string shaderName;
+    std::vector<std::string> defines;
+    LLGL::VertexFormat vertexFormat;
+    std::string vertSource;
+    std::string fragSource;
+    TranslationFuture future;
+    bool prewarmed = false;
+    bool requested = false; // By this session, recorded in the next pre-warm list
+};
+
+struct RegistryEntry {
+    PipelineRequest request;
+    uint64_t translationKey = 0;
+    TranslationFuture translation;
+    AsyncPipelineRef pipeline;
+    uint32_t references = 0;
+    bool failed = false; // Shaders didn't compile; get() stays null until a reload fixes them
+    uint64_t reloadKey = 0;
+    TranslationFuture reload; // Valid while reload_pipelines rebuilds the pipeline
+};
+
+// Pipeline layout shared by every acquire_pipeline_layout with the same descriptor
+struct LayoutEntry {
+    std::string signature; // Empty: not shared
+    LLGL::PipelineLayout* layout = nullptr;
+    uint32_t references = 0;
+};
+
+struct PipelineRegistryState {
+    std::mutex mutex;
+    std::unordered_multimap<uint64_t, RegistryEntry> entries;
+    std::unordered_multimap<uint64_t, LayoutEntry> layouts;
+    std::unordered_map<uint64_t, TranslationEntry> translations;
+    std::unique_ptr<ThreadPool> pool;
+    PipelineRegistryStats stats;
+    std::atomic<uint64_t> translationMicroseconds{ 0 }; // Written by the workers, which never take the mutex
+};
+
+PipelineRegistryState& state() {
+    static PipelineRegistryState instance;
+    return instance;
+}
+
+uint64_t hashAttribute(const LLGL::VertexAttribute& attribute, uint64_t hash) {
+    hash = hash_string(std::string(attribute.name.c_str()), hash);
+    hash = hash_value(attribute.format, hash);
+    hash = hash_value(attribute.location, hash);
+    hash = hash_value(attribute.semanticIndex, hash);
+    hash = hash_value(attribute.slot, hash);
+    hash = hash_value(attribute.offset, hash);
+    hash = hash_value(attribute.stride, hash);
+    return hash_value(attribute.instanceDivisor, hash);
+}
+
+bool sameAttribute(const LLGL::VertexAttribute& a, const LLGL::VertexAttribute& b) {
+    return std::string(a.name.c_str()) == b.name.c_str() && a.format == b.format && a.location == b.location &&
+           a.semanticIndex == b.semanticIndex && a.slot == b.slot && a.offset == b.offset && a.stride == b.stride &&
+           a.instanceDivisor == b.instanceDivisor;
+}
+
+bool sameVertexFormat(const LLGL::VertexFormat& a, const LLGL::VertexFormat& b) {
+    if (a.attributes.size() != b.attributes.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.attributes.size(); i++) {
+        if (!sameAttribute(a.attributes[i], b.attributes[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t hashTranslation(const std::string& shaderName, const LLGL::VertexFormat& vertexFormat,
+                         const std::string& vertSource, const std::string& fragSource) {
+    uint64_t hash = hash_string(shaderName);
+    hash = hash_string(vertSource, hash);
+    hash = hash_string(fragSource, hash);
+    hash = hash_value(vertexFormat.attributes.size(), hash);
+    for (const auto& attribute : vertexFormat.attributes) {
+        hash = hashAttribute(attribute, hash);
+    }
+    return hash;
+}
+
+// Everything that tells two layout descriptors apart, written out so that equal layouts compare equal as
+// strings. The debug name doesn't matter.
+std::string layoutSignature(const LLGL::PipelineLayoutDescriptor& desc) {
+    std::ostringstream signature;
+    auto writeSlot = [&](const LLGL::BindingSlot& slot) { signature << ' ' << slot.index << ' ' << slot.set; };
+    auto writeBindings = [&](const std::vector<LLGL::BindingDescriptor>& bindings) {
+        signature << bindings.size();
+        for (const auto& binding : bindings) {
+            signature << ' ' << binding.name.c_str() << ' ' << static_cast<int>(binding.type) << ' '
+                      << binding.bindFlags << ' ' << binding.stageFlags << ' ' << binding.arraySize;
+            writeSlot(binding.slot);
+        }
+        signature << '\n';
+    };
+    writeBindings(desc.heapBindings);
+    writeBindings(desc.bindings);
+    signature << desc.uniforms.size();
+    for (const auto& uniform : desc.uniforms) {
+        signature << ' ' << uniform.name.c_str() << ' ' << static_cast<int>(uniform.type) << ' ' << uniform.arraySize;
+    }
+    signature << '\n' << desc.combinedTextureSamplers.size();
+    for (const auto& combined : desc.combinedTextureSamplers) {
+        signature << ' ' << combined.name.c_str() << ' ' << combined.textureName.c_str() << ' '
+                  << combined.samplerName.c_str();
+        writeSlot(combined.slot);
+    }
+    signature << '\n' << desc.barrierFlags;
+    return signature.str();
+}
+
+uint64_t hashPipeline(uint64_t translationKey, const PipelineRequest& request) {
+    // Layouts and render passes are identified by object: equal layouts are one object when they come from
+    // acquire_pipeline_layout, and the renderers create their render passes once
+    uint64_t hash = hash_value(translationKey);
+    hash = hash_value(request.pipelineLayout, hash);
+    hash = hash_value(request.renderPass, hash);
+    hash = hash_value(request.depthMode, hash);
+    return hash_value(request.cullMode, hash);
+}
+
+// Guards against hash collisions, a hit must match field by field
+bool sameTranslation(const TranslationEntry& entry, const std::string& shaderName,
+                     const LLGL::VertexFormat& vertexFormat, const std::string& vertSource,
+                     const std::string& fragSource) {
+    return entry.shaderName == shaderName && entry.vertSource == vertSource && entry.fragSource == fragSource &&
+           sameVertexFormat(entry.vertexFormat, vertexFormat);
+}
+
+bool samePipeline(const RegistryEntry& entry, uint64_t translationKey, const PipelineRequest& request) {
+    return entry.translationKey == translationKey && entry.request.pipelineLayout == request.pipelineLayout &&
+           entry.request.renderPass == request.renderPass && entry.request.depthMode == request.depthMode &&
+           entry.request.cullMode == request.cullMode;
+}
+
+ThreadPool& workerPool(PipelineRegistryState& registry) {
+    if (!registry.pool) {
+        // Leave half of the cores to the render thread and the driver
+        registry.pool = std::make_unique<ThreadPool>(std::max(1u, std::thread::hardware_concurrency() / 2));
+    }
+    return *registry.pool;
+}
+
+// Returns the translation for key, starting it on the workers if there is none yet
+TranslationEntry& findOrStartTranslation(PipelineRegistryState& registry, LLGL::RenderSystemPtr& renderer, uint64_t key,
+                                         const std::string& shaderName, const std::vector<std::string>& defines,
+                                         const LLGL::VertexFormat& vertexFormat, std::string vertSource,
+                                         std::string fragSource) {
+    auto it = registry.translations.find(key);
+    if (it != registry.translations.end() &&
+        sameTranslation(it->second, shaderName, vertexFormat, vertSource, fragSource)) {
+        return it->second;
+    }
+
+    // A colliding entry is replaced, pipelines built from it hold their own reference to its shaders
+    TranslationEntry entry;
+    entry.shaderName = shaderName;
+    entry.defines = defines;
+    entry.vertexFormat = vertexFormat;
+    entry.vertSource = std::move(vertSource);
+    entry.fragSource = std::move(fragSource);
+
+    std::atomic<uint64_t>* microseconds = &registry.translationMicroseconds;
+    entry.future = workerPool(registry)
+                       .submit([languages = renderer->GetRenderingCaps().shadingLanguages, vertexFormat,
+                                vertSource = entry.vertSource, fragSource = entry.fragSource, microseconds]() {
+                           PROFILE_SCOPE("translate_shaders");
+                           const auto start = std::chrono::steady_clock::now();
+                           std::shared_ptr<TranslatedShaders> shaders =
+                               translate_shaders(languages, vertexFormat, vertSource, fragSource);
+                           *microseconds += std::chrono::duration_cast<std::chrono::microseconds>(
+                                                std::chrono::steady_clock::now() - start)
+                                                .count();
+                           return shaders;
+                       })
+                       .share();
+    return registry.translations.insert_or_assign(key, std::move(entry)).first->second;
+}
+
+// Translation and creation errors mark the entry failed and are rethrown on the render thread
+void createPipeline(LLGL::RenderSystemPtr& renderer, PipelineRegistryState& registry, RegistryEntry& entry) {
+    registry.stats.pending--;
+    try {
+        const std::shared_ptr<TranslatedShaders> shaders = entry.translation.get();
+        const PipelineRequest& request = entry.request;
+        LLGL::PipelineState* pipeline = create_pipeline_from_shaders(renderer, request.renderPass, *shaders,
+                                                                     request.pipelineLayout, request.depthMode,
+                                                                     request.cullMode);
+        entry.pipeline->pipeline.store(pipeline, std::memory_order_release);
+    } catch (...) {
+        entry.failed = true;
+        registry.stats.failed++;
+        throw;
+    }
+}
+
+// Moves entries whose translation key changed to their new hash
+void rekeyEntries(PipelineRegistryState& registry, const std::vector<RegistryEntry*>& changed) {
+    for (auto it = registry.entries.begin(); it != registry.entries.end();) {
+        if (std::find(changed.begin(), changed.end(), &it->second) == changed.end()) {
+            ++it;
+            continue;
+        }
+        auto next = std::next(it);
+        auto node = registry.entries.extract(it);
+        node.key() = hashPipeline(node.mapped().translationKey, node.mapped().request);
+        registry.entries.insert(std::move(node));
+        it = next;
+    }
+}
+
+// Swaps in the reloaded pipelines whose translation finished. The previous pipelines may still be used by
+// the last frame, so the queue is drained before they are released.
+void swapReloadedPipelines(LLGL::RenderSystemPtr& renderer, PipelineRegistryState& registry) {
+    std::vector<LLGL::PipelineState*> retired;
+    std::vector<RegistryEntry*> changed;
+    for (auto& [hash, entry] : registry.entries) {
+        if (!entry.reload.valid() ||
+            entry.reload.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            continue;
+        }
+        TranslationFuture reload = std::move(entry.reload);
+        entry.reload = TranslationFuture();
+        registry.stats.reloading--;
+
+        const PipelineRequest& request = entry.request;
+        try {
+            const std::shared_ptr<TranslatedShaders> shaders = reload.get();
+            LLGL::PipelineState* pipeline = create_pipeline_from_shaders(renderer, request.renderPass, *shaders,
+                                                                         request.pipelineLayout, request.depthMode,
+                                                                         request.cullMode);
+            retired.push_back(entry.pipeline->pipeline.exchange(pipeline, std::memory_order_acq_rel));
+        } catch (const std::exception& e) {
+            log_error(LogCategory::Pipeline, "Shader reload: %s failed, keeping the previous pipeline (%s)\n",
+                      request.shaderName.c_str(), e.what());
+            continue;
+        }
+        entry.translation = std::move(reload);
+        entry.translationKey = entry.reloadKey;
+        changed.push_back(&entry);
+        registry.stats.reloaded++;
+    }
+    if (retired.empty()) {
+        return;
+    }
+    renderer->GetCommandQueue()->WaitIdle();
+    for (LLGL::PipelineState* pipeline : retired) {
+        renderer->Release(*pipeline);
+    }
+    rekeyEntries(registry, changed);
+}
+
+template <typename Match> void releaseEntry(LLGL::RenderSystemPtr& renderer, Match match) {
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto it = registry.entries.begin(); it != registry.entries.end(); ++it) {
+        if (!match(it->second)) {
+            continue;
+        }
+        if (--it->second.references == 0) {
+            // A pipeline still compiling is dropped; the translation stays for later requests
+            if (LLGL::PipelineState* pipeline = it->second.pipeline->get()) {
+                renderer->Release(*pipeline);
+            } else if (it->second.failed) {
+                registry.stats.failed--;
+            } else {
+                registry.stats.pending--;
+            }
+            if (it->second.reload.valid()) {
+                registry.stats.reloading--;
+            }
+            registry.entries.erase(it);
+            registry.stats.live--;
+        }
+        return;
+    }
+    log_error(LogCategory::Pipeline, "release_pipeline: pipeline was not created by the registry\n");
+}
+
+bool parsePrewarmLine(const std::string& line, PrewarmEntry& entry) {
+    std::istringstream stream(line);
+    size_t attributeCount = 0;
+    if (!(stream >> entry.shaderName >> attributeCount)) {
+        return false;
+    }
+    LLGL::VertexFormat& vertexFormat = entry.vertexFormat;
+    vertexFormat.attributes.clear();
+    for (size_t i = 0; i < attributeCount; i++) {
+        std::string name;
+        int format = 0;
+        LLGL::VertexAttribute attribute;
+        if (!(stream >> name >> format >> attribute.location >> attribute.semanticIndex >> attribute.slot >>
+              attribute.offset >> attribute.stride >> attribute.instanceDivisor)) {
+            return false;
+        }
+        attribute.name = LLGL::StringLiteral(name.c_str(), LLGL::CopyTag{}); // name is gone after this iteration
+        attribute.format = static_cast<LLGL::Format>(format);
+        vertexFormat.attributes.push_back(attribute);
+    }
+
+    // Permutation defines, missing in lists written before shader permutations
+    size_t defineCount = 0;
+    entry.defines.clear();
+    if (stream >> defineCount) {
+        entry.defines.resize(defineCount);
+        for (auto& define : entry.defines) {
+            if (!(stream >> define)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+AsyncPipelineRef acquire_pipeline_async(LLGL::RenderSystemPtr& renderer, const PipelineRequest& request) {
+    PROFILE_SCOPE("acquire_pipeline_async");
+    std::string vertSource, fragSource;
+    load_shader_sources(request.shaderName, vertSource, fragSource);
+    vertSource = apply_shader_defines(vertSource, request.defines);
+    fragSource = apply_shader_defines(fragSource, request.defines);
+    const uint64_t translationKey = hashTranslation(request.shaderName, request.vertexFormat, vertSource, fragSource);
+    const uint64_t hash = hashPipeline(translationKey, request);
+
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.stats.requests++;
+
+    auto [first, last] = registry.entries.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (samePipeline(it->second, translationKey, request)) {
+            it->second.references++;
+            registry.stats.hits++;
+            return it->second.pipeline;
+        }
+    }
+
+    TranslationEntry& translation =
+        findOrStartTranslation(registry, renderer, translationKey, request.shaderName, request.defines,
+                               request.vertexFormat, std::move(vertSource), std::move(fragSource));
+    if (translation.prewarmed && !translation.requested) {
+        registry.stats.prewarmHits++;
+    }
+    translation.requested = true;
+
+    RegistryEntry entry;
+    entry.request = request;
+    entry.translationKey = translationKey;
+    entry.translation = translation.future;
+    entry.pipeline = std::make_shared<AsyncPipeline>();
+    entry.references = 1;
+    registry.stats.unique++;
+    registry.stats.live++;
+    registry.stats.pending++;
+
+    AsyncPipelineRef pipeline = entry.pipeline;
+    registry.entries.emplace(hash, std::move(entry));
+    return pipeline;
+}
+
+LLGL::PipelineLayout* acquire_pipeline_layout(LLGL::RenderSystemPtr& renderer,
+                                              const LLGL::PipelineLayoutDescriptor& desc) {
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::string signature = desc.staticSamplers.empty() ? layoutSignature(desc) : std::string();
+    const uint64_t hash = hash_string(signature);
+    if (!signature.empty()) {
+        auto [first, last] = registry.layouts.equal_range(hash);
+        for (auto it = first; it != last; ++it) {
+            if (it->second.signature == signature) {
+                it->second.references++;
+                registry.stats.layoutHits++;
+                return it->second.layout;
+            }
+        }
+    }
+
+    LayoutEntry entry;
+    entry.signature = std::move(signature);
+    entry.layout = renderer->CreatePipelineLayout(desc);
+    entry.references = 1;
+    registry.stats.layouts++;
+    return registry.layouts.emplace(hash, std::move(entry))->second.layout;
+}
+
+void release_pipeline_layout(LLGL::RenderSystemPtr& renderer, LLGL::PipelineLayout* layout) {
+    if (!layout) {
+        return;
+    }
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto it = registry.layouts.begin(); it != registry.layouts.end(); ++it) {
+        if (it->second.layout != layout) {
+            continue;
+        }
+        if (--it->second.references == 0) {
+            renderer->Release(*layout);
+            registry.layouts.erase(it);
+            registry.stats.layouts--;
+        }
+        return;
+    }
+    log_error(LogCategory::Pipeline, "release_pipeline_layout: layout was not created by the registry\n");
+}
+
+LLGL::PipelineState* wait_for_pipeline(LLGL::RenderSystemPtr& renderer, const AsyncPipelineRef& pipeline) {
+    if (LLGL::PipelineState* ready = pipeline->get()) {
+        return ready;
+    }
+
+    PROFILE_SCOPE("wait_for_pipeline");
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& [hash, entry] : registry.entries) {
+        if (entry.pipeline == pipeline) {
+            if (!entry.failed) {
+                createPipeline(renderer, registry, entry);
+            }
+            break;
+        }
+    }
+    return pipeline->get();
+}
+
+LLGL::PipelineState* acquire_pipeline(LLGL::RenderSystemPtr& renderer, const PipelineRequest& request) {
+    return wait_for_pipeline(renderer, acquire_pipeline_async(renderer, request));
+}
+
+uint32_t pump_pipeline_compilation(LLGL::RenderSystemPtr& renderer, uint32_t maxPipelines) {
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (registry.stats.reloading > 0) {
+        PROFILE_SCOPE("swapReloadedPipelines");
+        swapReloadedPipelines(renderer, registry);
+    }
+    if (registry.stats.pending == 0) {
+        return 0;
+    }
+
+    PROFILE_SCOPE("pump_pipeline_compilation");
+    uint32_t created = 0;
+    for (auto& [hash, entry] : registry.entries) {
+        if (created == maxPipelines) {
+            break;
+        }
+        if (!entry.pipeline->get() && !entry.failed &&
+            entry.translation.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            // A broken permutation must not take the frame down: its users keep drawing with their fallback
+            try {
+                createPipeline(renderer, registry, entry);
+            } catch (const std::exception& e) {
+                log_error(LogCategory::Pipeline, "Pipeline %s failed, drawing with the fallback instead (%s)\n",
+                          shader_variant_name(entry.request.shaderName, entry.request.defines).c_str(), e.what());
+            }
+            created++;
+        }
+    }
+    return created;
+}
+
+uint32_t reload_pipelines(LLGL::RenderSystemPtr& renderer, const std::vector<std::string>& shaderNames) {
+    PROFILE_SCOPE("reload_pipelines");
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint32_t started = 0;
+    std::vector<RegistryEntry*> changed;
+    for (auto& [hash, entry] : registry.entries) {
+        const PipelineRequest& request = entry.request;
+        if (std::find(shaderNames.begin(), shaderNames.end(), request.shaderName) == shaderNames.end()) {
+            continue;
+        }
+        std::string vertSource, fragSource;
+        try {
+            load_shader_sources(request.shaderName, vertSource, fragSource);
+        } catch (const std::exception& e) {
+            log_error(LogCategory::Pipeline, "Shader reload: %s skipped (%s)\n", request.shaderName.c_str(), e.what());
+            continue;
+        }
+        vertSource = apply_shader_defines(vertSource, request.defines);
+        fragSource = apply_shader_defines(fragSource, request.defines);
+
+        // The sources are hashed after include expansion and defines, so unaffected permutations keep their key
+        const uint64_t key = hashTranslation(request.shaderName, request.vertexFormat, vertSource, fragSource);
+        if (key == (entry.reload.valid() ? entry.reloadKey : entry.translationKey)) {
+            continue;
+        }
+        TranslationEntry& translation =
+            findOrStartTranslation(registry, renderer, key, request.shaderName, request.defines,
+                                   request.vertexFormat, std::move(vertSource), std::move(fragSource));
+        translation.requested = true;
+
+        // Not created yet, or failed: build it from the new shaders in the first place
+        if (!entry.pipeline->get()) {
+            if (entry.failed) {
+                entry.failed = false;
+                registry.stats.failed--;
+                registry.stats.pending++;
+            }
+            entry.translation = translation.future;
+            entry.translationKey = key;
+            changed.push_back(&entry);
+            continue;
+        }
+        if (!entry.reload.valid()) {
+            registry.stats.reloading++;
+        }
+        entry.reload = translation.future;
+        entry.reloadKey = key;
+        started++;
+    }
+    rekeyEntries(registry, changed);
+    return started;
+}
+
+void release_pipeline(LLGL::RenderSystemPtr& renderer, const AsyncPipelineRef& pipeline) {
+    if (pipeline) {
+        releaseEntry(renderer, [&pipeline](const RegistryEntry& entry) { return entry.pipeline == pipeline; });
+    }
+}
+
+void release_pipeline(LLGL::RenderSystemPtr& renderer, LLGL::PipelineState* pipeline) {
+    if (pipeline) {
+        releaseEntry(renderer, [pipeline](const RegistryEntry& entry) { return entry.pipeline->get() == pipeline; });
+    }
+}
+
+bool read_pipeline_prewarm_list(const std::string& cacheDir, std::vector<PrewarmEntry>& entries) {
+    std::ifstream file(std::filesystem::path(cacheDir) / PREWARM_FILE_NAME);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    PrewarmEntry entry;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] != '#' && parsePrewarmLine(line, entry)) {
+            entries.push_back(entry);
+        }
+    }
+    return true;
+}
+
+void prewarm_pipelines(LLGL::RenderSystemPtr& renderer, const std::string& cacheDir) {
+    std::vector<PrewarmEntry> entries;
+    if (!read_pipeline_prewarm_list(cacheDir, entries)) {
+        return;
+    }
+
+    PROFILE_SCOPE("prewarm_pipelines");
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint32_t started = 0;
+    std::string vertSource, fragSource;
+    for (const auto& entry : entries) {
+        try {
+            load_shader_sources(entry.shaderName, vertSource, fragSource);
+        } catch (const std::exception&) {
+            continue; // Shader removed since the list was written
+        }
+        vertSource = apply_shader_defines(vertSource, entry.defines);
+        fragSource = apply_shader_defines(fragSource, entry.defines);
+
+        const uint64_t key = hashTranslation(entry.shaderName, entry.vertexFormat, vertSource, fragSource);
+        if (registry.translations.count(key) == 0) {
+            findOrStartTranslation(registry, renderer, key, entry.shaderName, entry.defines, entry.vertexFormat,
+                                   vertSource, fragSource)
+                .prewarmed = true;
+            started++;
+        }
+    }
+    registry.stats.prewarmed += started;
+    const std::filesystem::path path = std::filesystem::path(cacheDir) / PREWARM_FILE_NAME;
+    log_info(LogCategory::Pipeline, "Pipeline pre-warm: translating %u shader pairs from %s\n", started,
+             path.string().c_str());
+}
+
+void save_pipeline_prewarm_list(const std::string& cacheDir) {
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // One line per translation: shader name, attribute count, then name, format, location, semantic index,
+    // slot, offset, stride and instance divisor of every attribute, then the define count and the permutation
+    // defines. Sorted so that the file is stable.
+    std::vector<std::string> lines;
+    for (const auto& [key, translation] : registry.translations) {
+        if (!translation.requested) {
+            continue;
+        }
+        std::ostringstream line;
+        line << translation.shaderName << ' ' << translation.vertexFormat.attributes.size();
+        for (const auto& attribute : translation.vertexFormat.attributes) {
+            line << ' ' << attribute.name.c_str() << ' ' << static_cast<int>(attribute.format) << ' '
+                 << attribute.location << ' ' << attribute.semanticIndex << ' ' << attribute.slot << ' '
+                 << attribute.offset << ' ' << attribute.stride << ' ' << attribute.instanceDivisor;
+        }
+        line << ' ' << translation.defines.size();
+        for (const auto& define : translation.defines) {
+            line << ' ' << define;
+        }
+        lines.push_back(line.str());
+    }
+    if (lines.empty()) {
+        return;
+    }
+    // Hot-reloaded shaders leave one translation per revision
+    std::sort(lines.begin(), lines.end());
+    lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir, ec);
+    const std::filesystem::path path = std::filesystem::path(cacheDir) / PREWARM_FILE_NAME;
+    std::ofstream file(path, std::ios::trunc);
+    file << "# Shaders requested by the last session, translated ahead of time on the next start\n";
+    for (const auto& line : lines) {
+        file << line << '\n';
+    }
+    if (!file) {
+        log_error(LogCategory::Pipeline, "Failed to write pipeline pre-warm list: %s\n", path.string().c_str());
+    }
+}
+
+void shutdown_pipeline_registry() {
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.pool.reset();
+    registry.translations.clear();
+}
+
+PipelineRegistryStats pipeline_registry_stats() {
+    PipelineRegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    PipelineRegistryStats stats = registry.stats;
+    stats.translationMs = static_cast<double>(registry.translationMicroseconds.load()) / 1000.0;
+    return stats;
+}
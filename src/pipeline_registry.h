@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+#include <LLGL/Utils/VertexFormat.h>
+
+#include "model_renderer.h"
+
+// Everything create_pipeline turns into a GraphicsPipelineDescriptor. Blend state follows from the
+// depth mode (PrepassWrite masks color), so it needs no field of its own.
+struct PipelineRequest {
+    std::string shaderName; // shader/<name>.vert and .frag
+    std::vector<std::string> defines; // Permutation of the shader, defined in both stages
+    LLGL::VertexFormat vertexFormat;
+    LLGL::PipelineLayout* pipelineLayout = nullptr;
+    const LLGL::RenderPass* renderPass = nullptr;
+    DepthMode depthMode = DepthMode::Disabled;
+    LLGL::CullMode cullMode = LLGL::CullMode::Disabled;
+};
+
+// A registry pipeline that may still be compiling; get() is null until it has been created
+struct AsyncPipeline {
+    std::atomic<LLGL::PipelineState*> pipeline{ nullptr };
+
+    LLGL::PipelineState* get() const {
+        return pipeline.load(std::memory_order_acquire);
+    }
+};
+using AsyncPipelineRef = std::shared_ptr<AsyncPipeline>;
+
+struct PipelineRegistryStats {
+    uint32_t requests = 0;
+    uint32_t hits = 0;          // Requests answered with an existing pipeline
+    uint32_t layouts = 0;       // Pipeline layouts currently referenced
+    uint32_t layoutHits = 0;    // Layout requests answered with an existing layout
+    uint32_t unique = 0;        // Pipelines created or compiling
+    uint32_t live = 0;          // Pipelines currently referenced
+    uint32_t pending = 0;       // Referenced pipelines that are not created yet
+    uint32_t failed = 0;        // Referenced pipelines whose shaders failed to compile
+    uint32_t prewarmed = 0;     // Translations started from the pre-warm list
+    uint32_t prewarmHits = 0;   // Requests whose shaders were translated by the pre-warm
+    uint32_t reloading = 0;     // Pipelines rebuilt by reload_pipelines that are not swapped in yet
+    uint32_t reloaded = 0;      // Pipelines swapped in by reload_pipelines
+    double translationMs = 0.0; // Shader translation time on the workers, summed
+};
+
+// Returns the pipeline for request at once and compiles it in the background. Identical requests (same
+// shader sources, vertex format, layout, render pass and fixed-function state) share one reference-counted
+// pipeline, and pipelines built from the same shaders and vertex format share one translation. Layouts and
+// render passes are compared by object: take layouts from acquire_pipeline_layout so that equal ones are one
+// object. Sources are read again on every request, so an edited shader file produces a new pipeline.
+//
+// Shaders are translated on worker threads. LLGL's RenderSystem is not thread-safe (and OpenGL objects
+// belong to the context's thread), so the LLGL objects are created by pump_pipeline_compilation or
+// wait_for_pipeline on the render thread.
+AsyncPipelineRef acquire_pipeline_async(LLGL::RenderSystemPtr& renderer, const PipelineRequest& request);
+
+// Blocks until the translation is done and creates the pipeline if needed. Shader errors are rethrown the
+// first time; a pipeline that failed returns null from then on, until a reload fixes its shaders.
+LLGL::PipelineState* wait_for_pipeline(LLGL::RenderSystemPtr& renderer, const AsyncPipelineRef& pipeline);
+
+// acquire_pipeline_async followed by wait_for_pipeline
+LLGL::PipelineState* acquire_pipeline(LLGL::RenderSystemPtr& renderer, const PipelineRequest& request);
+
+// Creates up to maxPipelines pipelines whose shaders are translated and swaps in every reloaded pipeline
+// whose shaders are; call once per frame, outside of command recording. Returns the number created. Shader
+// errors are logged, not thrown: the pipeline stays null and its users draw with their fallback.
+uint32_t pump_pipeline_compilation(LLGL::RenderSystemPtr& renderer, uint32_t maxPipelines = 1);
+
+// Hot reload: reads the sources of the live pipelines built from these shaders again. Pipelines whose
+// sources are unchanged are left alone; the others are translated in the background and swapped into their
+// AsyncPipeline by pump_pipeline_compilation, so their users pick them up at the next frame. Until then, and
+// if the new shaders fail to compile, the previous pipeline stays in use. Returns the number of pipelines
+// being rebuilt.
+uint32_t reload_pipelines(LLGL::RenderSystemPtr& renderer, const std::vector<std::string>& shaderNames);
+
+// Drops one reference; the pipeline is released together with its last user
+void release_pipeline(LLGL::RenderSystemPtr& renderer, const AsyncPipelineRef& pipeline);
+void release_pipeline(LLGL::RenderSystemPtr& renderer, LLGL::PipelineState* pipeline);
+
+// Returns the layout for desc, shared by every identical descriptor so that pipeline requests of different
+// renderers can match. Layouts with static samplers are not compared and always created anew.
+LLGL::PipelineLayout* acquire_pipeline_layout(LLGL::RenderSystemPtr& renderer,
+                                              const LLGL::PipelineLayoutDescriptor& desc);
+
+// Drops one reference; the layout is released together with its last user. Release the pipelines built
+// with it first.
+void release_pipeline_layout(LLGL::RenderSystemPtr& renderer, LLGL::PipelineLayout* layout);
+
+// Starts translating the shaders that the previous session requested, as recorded in
+// cacheDir/pipeline_prewarm.txt, so that their pipelines only need to be created when requested
+void prewarm_pipelines(LLGL::RenderSystemPtr& renderer, const std::string& cacheDir);
+
+// Shader permutation and vertex format combination from the pre-warm list
+struct PrewarmEntry {
+    std::string shaderName;
+    std::vector<std::string> defines;
+    LLGL::VertexFormat vertexFormat;
+};
+
+// Reads cacheDir/pipeline_prewarm.txt; returns false if there is none
+bool read_pipeline_prewarm_list(const std::string& cacheDir, std::vector<PrewarmEntry>& entries);
+
+// Records the shader and vertex format combinations requested in this session for the next pre-warm
+void save_pipeline_prewarm_list(const std::string& cacheDir);
+
+// Waits for translations still running (pre-warm, or pipelines released before they were ready) and drops
+// the translated shaders. Call before unloading the renderer after asynchronous use.
+void shutdown_pipeline_registry();
+
+PipelineRegistryStats pipeline_registry_stats();
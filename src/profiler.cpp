@@ -0,0 +1,167 @@
+#include "profiler.h"
+
+#include "logger.h"
+
+#ifdef TEST_LLGL_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "json_writer.h"
+
+namespace Profiler {
+
+namespace {
+
+constexpr size_t RING_CAPACITY = 1 << 16; // Events per thread, must be a power of two
+
+struct Event {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+    uint32_t frame;
+};
+
+struct ThreadBuffer {
+    uint32_t threadIndex = 0;
+    std::string name;
+    std::vector<Event> events = std::vector<Event>(RING_CAPACITY);
+    std::atomic<uint64_t> writeIndex{ 0 };
+};
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+std::atomic<uint32_t> g_frame{ 0 };
+
+// Buffers are owned here so events of finished threads can still be dumped
+std::mutex g_registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_registry;
+
+ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        auto created = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        created->threadIndex = static_cast<uint32_t>(g_registry.size());
+        created->name = "Thread " + std::to_string(created->threadIndex); // Until PROFILE_THREAD_NAME
+        g_registry.push_back(created);
+        buffer = created.get();
+    }
+    return *buffer;
+}
+
+} // anonymous namespace
+
+uint64_t now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count());
+}
+
+void record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadBuffer& buffer = threadBuffer();
+    uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+    buffer.events[index & (RING_CAPACITY - 1)] = { name, startNs, endNs, g_frame.load(std::memory_order_relaxed) };
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void setThreadName(const char* name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    buffer.name = name;
+}
+
+void markFrame() {
+    g_frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t currentFrame() {
+    return g_frame.load(std::memory_order_relaxed);
+}
+
+bool writeChromeTrace(const std::string& path, uint32_t lastFrames) {
+    const uint32_t frame = currentFrame();
+    const uint32_t firstFrame = frame > lastFrames ? frame - lastFrames : 1;
+
+    JsonWriter json;
+    json.beginObject();
+    json.field("displayTimeUnit", "ms");
+    json.key("traceEvents").beginArray();
+
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    size_t eventCount = 0;
+    for (const auto& buffer : g_registry) {
+        json.beginObject();
+        json.field("name", "thread_name");
+        json.field("ph", "M");
+        json.field("pid", 1);
+        json.field("tid", buffer->threadIndex);
+        json.key("args").beginObject().field("name", buffer->name).endObject();
+        json.endObject();
+
+        const uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        const uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            const Event& event = buffer->events[i & (RING_CAPACITY - 1)];
+            const bool isStartup = event.frame == 0;
+            if (!isStartup && (lastFrames == 0 || event.frame < firstFrame)) {
+                continue;
+            }
+
+            json.beginObject();
+            json.field("name", event.name);
+            json.field("cat", isStartup ? "startup" : "frame");
+            json.field("ph", "X");
+            json.field("ts", static_cast<double>(event.startNs) / 1000.0);
+            json.field("dur", static_cast<double>(event.endNs - event.startNs) / 1000.0);
+            json.field("pid", 1);
+            json.field("tid", buffer->threadIndex);
+            json.key("args").beginObject().field("frame", event.frame).endObject();
+            json.endObject();
+            eventCount++;
+        }
+    }
+
+    json.endArray();
+    json.endObject();
+
+    if (!json.writeToFile(path)) {
+        log_error(LogCategory::App, "Failed to write trace: %s\n", path.c_str());
+        return false;
+    }
+    log_info(LogCategory::App, "Wrote %zu trace events to %s\n", eventCount, path.c_str());
+    return true;
+}
+
+} // namespace Profiler
+
+#else
+
+namespace Profiler {
+
+uint64_t now() {
+    return 0;
+}
+
+void record(const char*, uint64_t, uint64_t) {
+}
+
+void setThreadName(const char*) {
+}
+
+void markFrame() {
+}
+
+uint32_t currentFrame() {
+    return 0;
+}
+
+bool writeChromeTrace(const std::string&, uint32_t) {
+    log_error(LogCategory::App, "Profiler support is compiled out, reconfigure with -DTEST_LLGL_ENABLE_PROFILER=ON\n");
+    return false;
+}
+
+} // namespace Profiler
+
+#endif
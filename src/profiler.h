@@ -0,0 +1,68 @@
+#pragma once
+
+// Low-overhead CPU scope profiler.
+//
+// Each thread records into its own fixed-size ring buffer, so the hot path is two clock reads and
+// a store without locks. Events can be dumped as Chrome/Perfetto trace JSON (chrome://tracing,
+// ui.perfetto.dev). Everything below compiles to nothing unless TEST_LLGL_PROFILER is defined
+// (CMake option TEST_LLGL_ENABLE_PROFILER).
+
+#include <cstdint>
+#include <string>
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef TEST_LLGL_PROFILER
+#define PROFILE_SCOPE(name) Profiler::ScopedEvent PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FRAME_MARK() Profiler::markFrame()
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void) 0)
+#define PROFILE_FRAME_MARK() ((void) 0)
+#define PROFILE_THREAD_NAME(name) ((void) 0)
+#endif
+
+namespace Profiler {
+
+constexpr bool isEnabled() {
+#ifdef TEST_LLGL_PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Nanoseconds since the profiler epoch (process start)
+uint64_t now();
+
+// Appends a completed event to the calling thread's ring buffer. Name must be a string literal.
+void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+void setThreadName(const char* name);
+
+// Frame 0 covers startup, every call starts a new frame
+void markFrame();
+uint32_t currentFrame();
+
+// Writes startup events plus the last `lastFrames` frames (0 = startup only).
+// Should be called while the instrumented threads are idle, e.g. on shutdown.
+bool writeChromeTrace(const std::string& path, uint32_t lastFrames);
+
+class ScopedEvent {
+  public:
+    explicit ScopedEvent(const char* name) : name_(name), start_(now()) {
+    }
+    ~ScopedEvent() {
+        record(name_, start_, now());
+    }
+
+    ScopedEvent(const ScopedEvent&) = delete;
+    ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+  private:
+    const char* name_;
+    uint64_t start_;
+};
+
+} // namespace Profiler
@@ -0,0 +1,44 @@
+#include "sample_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Nearest-rank percentile of sorted samples
+double percentile(const std::vector<double>& sorted, double p) {
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+} // anonymous namespace
+
+SampleSummary summarize_samples(std::vector<double> samples) {
+    SampleSummary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    summary.min = samples.front();
+    summary.max = samples.back();
+    summary.mean = sum / static_cast<double>(samples.size());
+    summary.p50 = percentile(samples, 50.0);
+    summary.p95 = percentile(samples, 95.0);
+    summary.p99 = percentile(samples, 99.0);
+    return summary;
+}
+
+void write_summary(JsonWriter& json, const std::string& name, const SampleSummary& summary) {
+    json.key(name).beginObject();
+    json.field("min", summary.min);
+    json.field("mean", summary.mean);
+    json.field("p50", summary.p50);
+    json.field("p95", summary.p95);
+    json.field("p99", summary.p99);
+    json.field("max", summary.max);
+    json.endObject();
+}
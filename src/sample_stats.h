@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "json_writer.h"
+
+// Distribution of timing samples, percentiles use the nearest-rank method
+struct SampleSummary {
+    double min = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+SampleSummary summarize_samples(std::vector<double> samples);
+
+// Writes the summary as an object under `name`
+void write_summary(JsonWriter& json, const std::string& name, const SampleSummary& summary);
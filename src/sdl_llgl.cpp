@@ -6,6 +6,8 @@
 
 #include <SDL2/SDL_syswm.h>
 #include "sdl_llgl.h"
+#include "logger.h"
+#include "profiler.h"
 
 #if defined(LLGL_OS_LINUX) || defined(WIN32)
 LLGL::OpenGL::RenderSystemNativeHandle handle;
@@ -34,8 +36,8 @@ SDLSurface::SDLSurface(const LLGL::Extent2D& size, const char* title, int render
 
     wnd = SDL_CreateWindow(title, 400, 200, (int) size.width, (int) size.height, flags);
     if (wnd == nullptr) {
-        LLGL::Log::Errorf("%s\n", SDL_GetError());
-        LLGL::Log::Errorf("Failed to create SDL2 window\n");
+        log_error(LogCategory::Render, "%s\n", SDL_GetError());
+        log_error(LogCategory::Render, "Failed to create SDL2 window\n");
         throw std::runtime_error(SDL_GetError());
     }
 
@@ -133,6 +135,7 @@ LLGL::Display* SDLSurface::FindResidentDisplay() const {
 }
 
 bool SDLSurface::ProcessEvents(LLGL::SwapChain* swapChain) {
+    PROFILE_SCOPE("ProcessEvents");
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
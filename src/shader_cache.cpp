@@ -0,0 +1,186 @@
+#include "shader_cache.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "hash.h"
+#include "logger.h"
+
+namespace {
+
+// File layout: magic, version, key, target, translation time, then vertex and fragment code as
+// kind (0 = text, 1 = SPIR-V words), byte size and bytes
+constexpr char FILE_MAGIC[4] = { 'T', 'L', 'S', 'H' };
+constexpr uint32_t FILE_VERSION = 1;
+
+struct ShaderCacheState {
+    std::mutex mutex;
+    std::filesystem::path directory; // Empty: disabled
+    ShaderCacheStats stats;
+};
+
+ShaderCacheState& state() {
+    static ShaderCacheState instance;
+    return instance;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool readCode(std::ifstream& file, ShaderCode& code) {
+    uint8_t kind = 0;
+    uint64_t size = 0;
+    file.read(reinterpret_cast<char*>(&kind), sizeof(kind));
+    file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!file || kind > 1 || (kind == 1 && size % sizeof(uint32_t) != 0)) {
+        return false;
+    }
+    if (kind == 0) {
+        std::string text(static_cast<size_t>(size), '\0');
+        file.read(text.data(), static_cast<std::streamsize>(size));
+        code = std::move(text);
+    } else {
+        std::vector<uint32_t> words(static_cast<size_t>(size / sizeof(uint32_t)));
+        file.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(size));
+        code = std::move(words);
+    }
+    return static_cast<bool>(file);
+}
+
+void writeCode(std::ofstream& file, const ShaderCode& code) {
+    const uint8_t kind = static_cast<uint8_t>(code.index());
+    const void* data = nullptr;
+    uint64_t size = 0;
+    if (const auto* text = std::get_if<std::string>(&code)) {
+        data = text->data();
+        size = text->size();
+    } else {
+        const auto& words = std::get<std::vector<uint32_t>>(code);
+        data = words.data();
+        size = words.size() * sizeof(uint32_t);
+    }
+    file.write(reinterpret_cast<const char*>(&kind), sizeof(kind));
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+std::filesystem::path cachePath(const std::filesystem::path& directory, uint64_t key) {
+    return directory / (hash_to_hex(key) + ".bin");
+}
+
+} // anonymous namespace
+
+void init_shader_cache(const std::string& cacheDir) {
+    ShaderCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+    cacheState.directory = std::filesystem::path(cacheDir) / "shaders";
+    cacheState.stats.enabled = true;
+}
+
+bool read_cached_shaders(uint64_t key, uint32_t target, ShaderCode& vertShader, ShaderCode& fragShader) {
+    const auto start = std::chrono::steady_clock::now();
+    std::filesystem::path directory;
+    {
+        ShaderCacheState& cacheState = state();
+        std::lock_guard<std::mutex> lock(cacheState.mutex);
+        if (cacheState.directory.empty()) {
+            return false;
+        }
+        directory = cacheState.directory;
+    }
+
+    // Files are read outside the lock, translations on several workers look up different keys
+    std::ifstream file(cachePath(directory, key), std::ios::binary);
+    char magic[4] = {};
+    uint32_t version = 0, fileTarget = 0;
+    uint64_t fileKey = 0;
+    double translationMs = 0.0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey));
+    file.read(reinterpret_cast<char*>(&fileTarget), sizeof(fileTarget));
+    file.read(reinterpret_cast<char*>(&translationMs), sizeof(translationMs));
+    const bool hit = file && std::memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0 && version == FILE_VERSION &&
+                     fileKey == key && fileTarget == target && readCode(file, vertShader) &&
+                     readCode(file, fragShader);
+
+    ShaderCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+    if (target == REFLECTION_CACHE_TARGET) {
+        (hit ? cacheState.stats.reflectionHits : cacheState.stats.reflectionMisses)++;
+    } else if (hit) {
+        cacheState.stats.hits++;
+        cacheState.stats.savedMs += translationMs - millisecondsSince(start);
+    } else {
+        cacheState.stats.misses++;
+    }
+    return hit;
+}
+
+void write_cached_shaders(uint64_t key, uint32_t target, const ShaderCode& vertShader, const ShaderCode& fragShader,
+                          double translationMs) {
+    std::filesystem::path directory;
+    {
+        ShaderCacheState& cacheState = state();
+        std::lock_guard<std::mutex> lock(cacheState.mutex);
+        if (cacheState.directory.empty()) {
+            return;
+        }
+        directory = cacheState.directory;
+        if (target != REFLECTION_CACHE_TARGET) {
+            cacheState.stats.translationMs += translationMs;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    // Temporary file per thread, then rename: concurrent writers of the same key never mix their bytes
+    const std::filesystem::path path = cachePath(directory, key);
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&FILE_VERSION), sizeof(FILE_VERSION));
+        file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        file.write(reinterpret_cast<const char*>(&target), sizeof(target));
+        file.write(reinterpret_cast<const char*>(&translationMs), sizeof(translationMs));
+        writeCode(file, vertShader);
+        writeCode(file, fragShader);
+        if (!file) {
+            log_error(LogCategory::Cache, "Failed to write shader cache: %s\n", tempPath.string().c_str());
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, path, ec);
+}
+
+void log_shader_cache_stats() {
+    const ShaderCacheStats stats = shader_cache_stats();
+    if (!stats.enabled) {
+        return;
+    }
+    const uint32_t lookups = stats.hits + stats.misses;
+    if (lookups > 0) {
+        log_info(LogCategory::Cache, "Shader cache: %u / %u hits (%.0f%%), %.2f ms saved, %.2f ms translating misses\n",
+                 stats.hits, lookups, 100.0 * stats.hits / lookups, stats.savedMs, stats.translationMs);
+    }
+    const uint32_t reflectionLookups = stats.reflectionHits + stats.reflectionMisses;
+    if (reflectionLookups > 0) {
+        log_info(LogCategory::Cache, "Shader cache: %u / %u reflection hits\n", stats.reflectionHits,
+                 reflectionLookups);
+    }
+}
+
+ShaderCacheStats shader_cache_stats() {
+    ShaderCacheState& cacheState = state();
+    std::lock_guard<std::mutex> lock(cacheState.mutex);
+    return cacheState.stats;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+// Output of one translated stage: source text (GLSL, ESSL, HLSL, MSL) or SPIR-V words
+using ShaderCode = std::variant<std::string, std::vector<uint32_t>>;
+
+// Target id of shader reflection records, next to the ShaderTarget values of translations. Their lookups are
+// counted apart from the translation stats.
+constexpr uint32_t REFLECTION_CACHE_TARGET = 0x6c666572; // "refl"
+
+struct ShaderCacheStats {
+    bool enabled = false;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    double savedMs = 0.0;       // Translation time recorded for the hits, minus the time to read them
+    double translationMs = 0.0; // glslang and SPIRV-Cross time of the misses
+    uint32_t reflectionHits = 0;
+    uint32_t reflectionMisses = 0;
+};
+
+// Enables the translation cache in cacheDir/shaders. Without it generate_shader_from_string always runs
+// glslang and SPIRV-Cross (the microbenchmarks rely on that).
+void init_shader_cache(const std::string& cacheDir);
+
+// Looks up the translation with this key (see generate_shader_from_string for what it covers) and target.
+// Thread-safe; returns false on a miss or when the cache is disabled.
+bool read_cached_shaders(uint64_t key, uint32_t target, ShaderCode& vertShader, ShaderCode& fragShader);
+
+// Stores a translation that took translationMs, so later hits can report the time they saved
+void write_cached_shaders(uint64_t key, uint32_t target, const ShaderCode& vertShader, const ShaderCode& fragShader,
+                          double translationMs);
+
+// Logs hit rate and time saved, if the cache was used
+void log_shader_cache_stats();
+ShaderCacheStats shader_cache_stats();
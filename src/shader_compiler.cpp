@@ -0,0 +1,266 @@
+#include "shader_compiler.h"
+
+#include <chrono>
+#include <stdexcept>
+
+#include <glslang/SPIRV/SpvTools.h>
+#include <LLGL/LLGL.h>
+
+#include "logger.h"
+#include "profiler.h"
+
+extern LLGL::RenderSystemPtr llgl_renderer;
+
+namespace {
+
+TBuiltInResource buildResources(const LLGL::RenderingCapabilities& caps) {
+    TBuiltInResource Resources = {};
+    const auto& limits = caps.limits;
+
+    Resources.maxLights = 32;
+    Resources.maxClipPlanes = 6;
+    Resources.maxTextureUnits = 32;
+    Resources.maxTextureCoords = 32;
+    Resources.maxVertexAttribs = 64;
+    Resources.maxVertexUniformComponents = 4096;
+    Resources.maxVaryingFloats = 64;
+    Resources.maxVertexTextureImageUnits = 32;
+    Resources.maxCombinedTextureImageUnits = 80;
+    Resources.maxTextureImageUnits = 32;
+    Resources.maxFragmentUniformComponents = 4096;
+    Resources.maxDrawBuffers = 32;
+    Resources.maxVertexUniformVectors = 128;
+    Resources.maxVaryingVectors = 8;
+    Resources.maxFragmentUniformVectors = 16;
+    Resources.maxVertexOutputVectors = 16;
+    Resources.maxFragmentInputVectors = 15;
+    Resources.minProgramTexelOffset = -8;
+    Resources.maxProgramTexelOffset = 7;
+    Resources.maxClipDistances = 8;
+    Resources.maxComputeWorkGroupCountX = limits.maxComputeShaderWorkGroups[0];
+    Resources.maxComputeWorkGroupCountY = limits.maxComputeShaderWorkGroups[1];
+    Resources.maxComputeWorkGroupCountZ = limits.maxComputeShaderWorkGroups[2];
+    Resources.maxComputeWorkGroupSizeX = limits.maxComputeShaderWorkGroupSize[0];
+    Resources.maxComputeWorkGroupSizeY = limits.maxComputeShaderWorkGroupSize[1];
+    Resources.maxComputeWorkGroupSizeZ = limits.maxComputeShaderWorkGroupSize[2];
+    Resources.maxComputeUniformComponents = 1024;
+    Resources.maxComputeTextureImageUnits = 16;
+    Resources.maxComputeImageUniforms = 8;
+    Resources.maxComputeAtomicCounters = 8;
+    Resources.maxComputeAtomicCounterBuffers = 1;
+    Resources.maxVaryingComponents = 60;
+    Resources.maxVertexOutputComponents = 64;
+    Resources.maxGeometryInputComponents = 64;
+    Resources.maxGeometryOutputComponents = 128;
+    Resources.maxFragmentInputComponents = 128;
+    Resources.maxImageUnits = 8;
+    Resources.maxCombinedImageUnitsAndFragmentOutputs = 8;
+    Resources.maxCombinedShaderOutputResources = 8;
+    Resources.maxImageSamples = 0;
+    Resources.maxVertexImageUniforms = 0;
+    Resources.maxTessControlImageUniforms = 0;
+    Resources.maxTessEvaluationImageUniforms = 0;
+    Resources.maxGeometryImageUniforms = 0;
+    Resources.maxFragmentImageUniforms = 8;
+    Resources.maxCombinedImageUniforms = 8;
+    Resources.maxGeometryTextureImageUnits = 16;
+    Resources.maxGeometryOutputVertices = 256;
+    Resources.maxGeometryTotalOutputComponents = 1024;
+    Resources.maxGeometryUniformComponents = 1024;
+    Resources.maxGeometryVaryingComponents = 64;
+    Resources.maxTessControlInputComponents = 128;
+    Resources.maxTessControlOutputComponents = 128;
+    Resources.maxTessControlTextureImageUnits = 16;
+    Resources.maxTessControlUniformComponents = 1024;
+    Resources.maxTessControlTotalOutputComponents = 4096;
+    Resources.maxTessEvaluationInputComponents = 128;
+    Resources.maxTessEvaluationOutputComponents = 128;
+    Resources.maxTessEvaluationTextureImageUnits = 16;
+    Resources.maxTessEvaluationUniformComponents = 1024;
+    Resources.maxTessPatchComponents = 120;
+    Resources.maxPatchVertices = 32;
+    Resources.maxTessGenLevel = 64;
+    Resources.maxViewports = limits.maxViewports;
+    Resources.maxVertexAtomicCounters = 0;
+    Resources.maxTessControlAtomicCounters = 0;
+    Resources.maxTessEvaluationAtomicCounters = 0;
+    Resources.maxGeometryAtomicCounters = 0;
+    Resources.maxFragmentAtomicCounters = 8;
+    Resources.maxCombinedAtomicCounters = 8;
+    Resources.maxAtomicCounterBindings = 1;
+    Resources.maxVertexAtomicCounterBuffers = 0;
+    Resources.maxTessControlAtomicCounterBuffers = 0;
+    Resources.maxTessEvaluationAtomicCounterBuffers = 0;
+    Resources.maxGeometryAtomicCounterBuffers = 0;
+    Resources.maxFragmentAtomicCounterBuffers = 1;
+    Resources.maxCombinedAtomicCounterBuffers = 1;
+    Resources.maxAtomicCounterBufferSize = 16384;
+    Resources.maxTransformFeedbackBuffers = 4;
+    Resources.maxTransformFeedbackInterleavedComponents = 64;
+    Resources.maxCullDistances = 8;
+    Resources.maxCombinedClipAndCullDistances = 8;
+    Resources.maxSamples = 4;
+    Resources.maxMeshOutputVerticesNV = 256;
+    Resources.maxMeshOutputPrimitivesNV = 512;
+    Resources.maxMeshWorkGroupSizeX_NV = 32;
+    Resources.maxMeshWorkGroupSizeY_NV = 1;
+    Resources.maxMeshWorkGroupSizeZ_NV = 1;
+    Resources.maxTaskWorkGroupSizeX_NV = 32;
+    Resources.maxTaskWorkGroupSizeY_NV = 1;
+    Resources.maxTaskWorkGroupSizeZ_NV = 1;
+    Resources.maxMeshViewCountNV = 4;
+
+    Resources.limits.nonInductiveForLoops = 1;
+    Resources.limits.whileLoops = 1;
+    Resources.limits.doWhileLoops = 1;
+    Resources.limits.generalUniformIndexing = 1;
+    Resources.limits.generalAttributeMatrixVectorIndexing = 1;
+    Resources.limits.generalVaryingIndexing = 1;
+    Resources.limits.generalSamplerIndexing = 1;
+    Resources.limits.generalVariableIndexing = 1;
+    Resources.limits.generalConstantMatrixVectorIndexing = 1;
+
+    return Resources;
+}
+
+uint32_t countInstructions(const std::vector<uint32_t>& spirv) {
+    // Five header words, then every instruction starts with its word count in the upper 16 bits
+    uint32_t count = 0;
+    for (size_t i = 5; i < spirv.size(); count++) {
+        const uint32_t wordCount = spirv[i] >> 16;
+        i += wordCount > 0 ? wordCount : 1;
+    }
+    return count;
+}
+
+} // anonymous namespace
+
+const char* spirv_optimization_name(SpirvOptimization level) {
+    switch (level) {
+    case SpirvOptimization::Size:
+        return "size";
+    case SpirvOptimization::Performance:
+        return "performance";
+    default:
+        return "none";
+    }
+}
+
+bool parse_spirv_optimization(const std::string& name, SpirvOptimization& level) {
+    for (SpirvOptimization candidate :
+         { SpirvOptimization::None, SpirvOptimization::Size, SpirvOptimization::Performance }) {
+        if (name == spirv_optimization_name(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+ShaderCompiler& ShaderCompiler::instance() {
+    // Function-local static: constructed once even when several workers translate at the same time
+    static ShaderCompiler compiler;
+    return compiler;
+}
+
+ShaderCompiler::ShaderCompiler() {
+    PROFILE_SCOPE("ShaderCompiler");
+    glslang::InitializeProcess();
+    resources_ = buildResources(llgl_renderer->GetRenderingCaps());
+
+#ifdef __APPLE__
+    glslOptions_.enable_420pack_extension = false;
+#endif
+    mslOptions_.enable_decoration_binding = true;
+}
+
+ShaderCompiler::~ShaderCompiler() {
+    glslang::FinalizeProcess();
+}
+
+std::vector<uint32_t> ShaderCompiler::compileToSpirv(EShLanguage stage, const std::string& source,
+                                                     const std::string& fileName, SpirvOptimization optimization,
+                                                     SpirvStats* stats) const {
+    PROFILE_SCOPE("glslang");
+    glslang::TShader shader(stage);
+    const char* sourceC = source.c_str();
+    shader.setStrings(&sourceC, 1);
+    shader.setSourceFile(fileName.c_str());
+    shader.setEnvInput(glslang::EShSourceGlsl, stage, glslang::EShClientVulkan, 100);
+    shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_5);
+    shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_2);
+    shader.setTextureSamplerTransformMode(EShTextureSamplerTransformMode::EShTexSampTransKeep);
+
+    shader.parse(&resources_, 120, true, EShMsgDefault);
+    const char* log = shader.getInfoLog();
+    if (log != nullptr && *log != '\0') {
+        log_error(LogCategory::Shader, "%s", log);
+        throw std::runtime_error(stage == EShLangVertex ? "Failed to compile vertex shader"
+                                                        : "Failed to compile fragment shader");
+    }
+    if (shader.getIntermediate() == nullptr) {
+        log_error(LogCategory::Shader, "Failed to get intermediate\n");
+        throw std::runtime_error("Failed to get intermediate");
+    }
+
+    spv::SpvBuildLogger logger;
+    glslang::SpvOptions spvOptions;
+    spvOptions.validate = false;
+    spvOptions.disableOptimizer = true;
+    spvOptions.optimizeSize = false;
+
+    std::vector<uint32_t> spirv;
+    {
+        PROFILE_SCOPE("GlslangToSpv");
+        glslang::GlslangToSpv(*shader.getIntermediate(), spirv, &logger, &spvOptions);
+    }
+    if (stats) {
+        stats->instructionsBefore = countInstructions(spirv);
+        stats->bytesBefore = spirv.size() * sizeof(uint32_t);
+    }
+
+    // glslang runs SPIRV-Tools as part of code generation, so the optimized module is generated again from the
+    // same intermediate (the unoptimized one is only kept for the stats)
+    if (optimization != SpirvOptimization::None) {
+        PROFILE_SCOPE("SpirvOptimizer");
+        const auto start = std::chrono::steady_clock::now();
+        spvOptions.disableOptimizer = false;
+        spvOptions.optimizeSize = optimization == SpirvOptimization::Size;
+        spirv.clear();
+        glslang::GlslangToSpv(*shader.getIntermediate(), spirv, &logger, &spvOptions);
+        if (stats) {
+            stats->optimizeMs =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    if (stats) {
+        stats->instructionsAfter = countInstructions(spirv);
+        stats->bytesAfter = spirv.size() * sizeof(uint32_t);
+    }
+    return spirv;
+}
+
+void ShaderCompiler::stripUnusedResources(spirv_cross::Compiler& compiler) {
+    auto enabled = compiler.get_active_interface_variables();
+    const spirv_cross::ShaderResources resources = compiler.get_shader_resources();
+    for (const auto& input : resources.stage_inputs) {
+        enabled.insert(input.id);
+    }
+    for (const auto& output : resources.stage_outputs) {
+        enabled.insert(output.id);
+    }
+    compiler.set_enabled_interface_variables(std::move(enabled));
+}
+
+spirv_cross::CompilerGLSL::Options ShaderCompiler::getGlslOptions(int version, bool es) const {
+    spirv_cross::CompilerGLSL::Options options = glslOptions_;
+    options.version = version;
+    options.es = es;
+    return options;
+}
+
+spirv_cross::CompilerHLSL::Options ShaderCompiler::getHlslOptions(int version) const {
+    spirv_cross::CompilerHLSL::Options options;
+    options.shader_model = version / 10;
+    return options;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glslang/Include/ResourceLimits.h>
+#include <glslang/Public/ShaderLang.h>
+
+#include "spirv_cross/spirv_glsl.hpp"
+#include "spirv_cross/spirv_hlsl.hpp"
+#include "spirv_cross/spirv_msl.hpp"
+
+// SPIR-V optimizer setting of a translation. Size and Performance run the glslang/SPIRV-Tools pass lists
+// (dead code and dead branch elimination, inlining, ...) and strip unused resources before SPIRV-Cross.
+enum class SpirvOptimization : uint32_t { None, Size, Performance };
+
+const char* spirv_optimization_name(SpirvOptimization level);
+// Accepts "none", "size" and "performance"
+bool parse_spirv_optimization(const std::string& name, SpirvOptimization& level);
+
+// Module size before and after the optimizer (equal for SpirvOptimization::None)
+struct SpirvStats {
+    uint32_t instructionsBefore = 0;
+    uint32_t instructionsAfter = 0;
+    size_t bytesBefore = 0;
+    size_t bytesAfter = 0;
+    double optimizeMs = 0.0;
+};
+
+// Long-lived glslang front end and SPIRV-Cross option setup shared by all shader translations.
+// glslang is initialized once per process and the built-in resource table is built once from the
+// renderer's limits, so a translation only pays for parsing and code generation. Thread-safe: the shared
+// state is immutable after construction and every call uses its own glslang and SPIRV-Cross objects.
+class ShaderCompiler {
+  public:
+    // Created on first use from the capabilities of llgl_renderer, which must be loaded by then
+    static ShaderCompiler& instance();
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    // GLSL with Vulkan semantics to SPIR-V 1.5. Prints the glslang log and throws std::runtime_error on errors.
+    std::vector<uint32_t> compileToSpirv(EShLanguage stage, const std::string& source,
+                                         const std::string& fileName = "",
+                                         SpirvOptimization optimization = SpirvOptimization::None,
+                                         SpirvStats* stats = nullptr) const;
+
+    // Removes uniform buffers, textures and samplers the entry point never uses from the compiler's output.
+    // Stage inputs and outputs are kept, so the vertex and fragment interfaces still match.
+    static void stripUnusedResources(spirv_cross::Compiler& compiler);
+
+    // Target options with the platform-specific settings applied
+    spirv_cross::CompilerGLSL::Options getGlslOptions(int version, bool es) const;
+    spirv_cross::CompilerHLSL::Options getHlslOptions(int version) const;
+    const spirv_cross::CompilerMSL::Options& getMslOptions() const {
+        return mslOptions_;
+    }
+
+    const TBuiltInResource& getResources() const {
+        return resources_;
+    }
+
+  private:
+    ShaderCompiler();
+    ~ShaderCompiler();
+
+    TBuiltInResource resources_;
+    spirv_cross::CompilerGLSL::Options glslOptions_;
+    spirv_cross::CompilerMSL::Options mslOptions_;
+};
@@ -0,0 +1,85 @@
+#include "shader_hot_reload.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "logger.h"
+#include "pipeline_registry.h"
+#include "profiler.h"
+#include "shader_translation.h"
+
+namespace {
+
+void addUnique(std::vector<std::string>& names, const std::string& name) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+        names.push_back(name);
+    }
+}
+
+} // anonymous namespace
+
+bool ShaderHotReload::start() {
+    const std::string directory = get_shader_directory();
+    if (!watcher_.start(directory)) {
+        return false;
+    }
+    buildDependencyGraph();
+    log_info(LogCategory::Shader, "Shader hot reload: watching %s (%zu files)\n", directory.c_str(),
+             dependents_.size());
+    return true;
+}
+
+void ShaderHotReload::stop() {
+    watcher_.stop();
+    dependents_.clear();
+}
+
+void ShaderHotReload::buildDependencyGraph() {
+    PROFILE_SCOPE("ShaderHotReload::buildDependencyGraph");
+    dependents_.clear();
+    std::string vertSource, fragSource;
+    std::vector<std::string> dependencies;
+    for (const auto& name : list_shader_names()) {
+        try {
+            load_shader_sources(name, vertSource, fragSource, &dependencies);
+        } catch (const std::exception&) {
+            // Broken include: depend on the pair itself, so fixing it triggers a reload
+            dependencies = { name + ".vert", name + ".frag" };
+        }
+        for (const auto& file : dependencies) {
+            addUnique(dependents_[file], name);
+        }
+    }
+}
+
+void ShaderHotReload::update(LLGL::RenderSystemPtr& renderer) {
+    const std::vector<std::string> changed = watcher_.poll();
+    if (changed.empty()) {
+        return;
+    }
+
+    PROFILE_SCOPE("ShaderHotReload::update");
+    std::vector<std::string> shaders;
+    for (const auto& file : changed) {
+        auto it = dependents_.find(file);
+        if (it != dependents_.end()) {
+            for (const auto& name : it->second) {
+                addUnique(shaders, name);
+            }
+        }
+    }
+    if (shaders.empty()) {
+        return; // Editor temporaries or files no shader reads
+    }
+
+    // Includes may have been added or removed
+    buildDependencyGraph();
+
+    const uint32_t rebuilt = reload_pipelines(renderer, shaders);
+    reloadCount_ += rebuilt;
+    std::string names;
+    for (const auto& name : shaders) {
+        names += (names.empty() ? "" : ", ") + name;
+    }
+    log_info(LogCategory::Shader, "Shader hot reload: %s changed, rebuilding %u pipelines\n", names.c_str(), rebuilt);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+#include "file_watcher.h"
+
+// Watches the shader directory and rebuilds the pipelines of the shaders a changed file affects, directly or
+// through #include. Keeps a dependency graph from every file to the shader pairs that read it, so editing
+// an include only touches its users, and the pipeline registry skips permutations whose text is unchanged.
+class ShaderHotReload {
+  public:
+    // Returns false when files can't be watched on this platform or the directory is missing
+    bool start();
+    void stop();
+
+    // Polls for changes and starts rebuilding the affected pipelines; call once per frame before
+    // pump_pipeline_compilation, which swaps them in
+    void update(LLGL::RenderSystemPtr& renderer);
+
+    uint32_t getReloadCount() const {
+        return reloadCount_;
+    }
+
+  private:
+    void buildDependencyGraph();
+
+    FileWatcher watcher_;
+    std::unordered_map<std::string, std::vector<std::string>> dependents_; // File -> shader names
+    uint32_t reloadCount_ = 0; // Pipelines rebuilt so far
+};
@@ -0,0 +1,196 @@
+#include "shader_precompile.h"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+#include "hash.h"
+#include "headless.h"
+#include "json_writer.h"
+#include "logger.h"
+#include "model_loader.h"
+#include "pipeline_registry.h"
+#include "profiler.h"
+#include "shader_cache.h"
+#include "shader_reflection.h"
+#include "shader_translation.h"
+#include "shader_variants.h"
+
+extern LLGL::RenderSystemPtr llgl_renderer;
+
+namespace {
+
+// The viewer's own combinations when it has run before, otherwise every permutation with the model format
+std::vector<PrewarmEntry> collectShaderPairs(const std::string& cacheDir) {
+    std::vector<PrewarmEntry> pairs;
+    if (read_pipeline_prewarm_list(cacheDir, pairs) && !pairs.empty()) {
+        log_info(LogCategory::Shader, "Precompiling %zu shader pairs from the pipeline pre-warm list\n", pairs.size());
+        return pairs;
+    }
+    for (const auto& name : list_shader_names()) {
+        for (auto& defines : shader_permutations(name)) {
+            pairs.push_back({ name, std::move(defines), createModelVertexFormat() });
+        }
+    }
+    log_info(LogCategory::Shader, "Precompiling %zu shader pairs with the model vertex format\n", pairs.size());
+    return pairs;
+}
+
+void writeSpirvStats(JsonWriter& json, const char* name, SpirvOptimization optimization, const SpirvStats& stats) {
+    json.key(name).beginObject();
+    json.field("optimization", spirv_optimization_name(optimization));
+    json.field("instructionsBefore", stats.instructionsBefore);
+    json.field("instructionsAfter", stats.instructionsAfter);
+    json.field("bytesBefore", stats.bytesBefore);
+    json.field("bytesAfter", stats.bytesAfter);
+    json.field("optimizeMs", stats.optimizeMs);
+    json.endObject();
+}
+
+// Uniform members the pair reads, from its reflection
+void writeUniformBlocks(JsonWriter& json, const ShaderReflection& reflection) {
+    json.key("uniformBlocks").beginArray();
+    for (const auto& block : reflection.uniformBlocks) {
+        json.beginObject();
+        json.field("name", block.name);
+        json.field("size", block.size);
+        json.field("usedOffset", block.usedOffset());
+        json.field("usedSize", block.usedSize());
+        json.key("members").beginArray();
+        for (const auto& member : block.members) {
+            json.beginObject();
+            json.field("name", member.name);
+            json.field("offset", member.offset);
+            json.field("size", member.size);
+            json.field("used", member.used);
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+}
+
+void logSpirvStats(const char* stage, SpirvOptimization optimization, const SpirvStats& stats) {
+    if (stats.instructionsBefore == 0) {
+        return; // Every target came from a cache
+    }
+    log_info(LogCategory::Shader, "    %s SPIR-V (%s): %u -> %u instructions, %zu -> %zu bytes, %.2f ms optimizing\n",
+             stage, spirv_optimization_name(optimization), stats.instructionsBefore, stats.instructionsAfter,
+             stats.bytesBefore, stats.bytesAfter, stats.optimizeMs);
+}
+
+} // anonymous namespace
+
+int run_shader_precompile(const AppOptions& options) {
+    // The translator only needs the rendering caps, so the Null device is enough
+    llgl_renderer = load_headless_renderer(options.rendererModule);
+    if (!llgl_renderer) {
+        return 1;
+    }
+    if (options.shaderCache) {
+        init_shader_cache(options.cacheDir);
+    }
+
+    const std::vector<ShaderTargetDesc>& targets = shipped_shader_targets();
+    JsonWriter json;
+    json.beginObject();
+    json.field("spirvOptimization", spirv_optimization_name(spirv_optimization()));
+    json.key("targets").beginArray();
+    for (const auto& target : targets) {
+        json.value(target.name);
+    }
+    json.endArray();
+
+    int exitCode = 0;
+    double totalMs = 0.0, serialMs = 0.0;
+    json.key("shaders").beginArray();
+    for (const auto& pair : collectShaderPairs(options.cacheDir)) {
+        PROFILE_SCOPE("precompile_shader_pair");
+        std::string vertSource, fragSource;
+        try {
+            load_shader_sources(pair.shaderName, vertSource, fragSource);
+        } catch (const std::exception&) {
+            log_error(LogCategory::Shader, "Skipping %s: shader files not found\n", pair.shaderName.c_str());
+            continue;
+        }
+        vertSource = apply_shader_defines(vertSource, pair.defines);
+        fragSource = apply_shader_defines(fragSource, pair.defines);
+        const std::string variantName = shader_variant_name(pair.shaderName, pair.defines);
+        const ShaderTranslationReport report =
+            translate_shader_targets(targets, pair.vertexFormat, vertSource, fragSource);
+
+        // What the same work costs one stage and one target at a time
+        double pairSerialMs = report.spirvMs;
+        for (const auto& result : report.results) {
+            pairSerialMs += result.translationMs;
+        }
+        totalMs += report.totalMs;
+        serialMs += pairSerialMs;
+
+        json.beginObject();
+        json.field("shader", pair.shaderName);
+        json.field("variant", variantName);
+        json.field("attributes", pair.vertexFormat.attributes.size());
+        json.field("spirvMs", report.spirvMs);
+        json.field("totalMs", report.totalMs);
+        json.field("serialMs", pairSerialMs);
+        writeSpirvStats(json, "vertSpirv", report.vertOptimization, report.vertSpirv);
+        writeSpirvStats(json, "fragSpirv", report.fragOptimization, report.fragSpirv);
+        try {
+            writeUniformBlocks(json, *reflect_shader_sources(vertSource, fragSource));
+        } catch (const std::exception&) {
+            // Compile errors are reported with the targets below
+        }
+        json.key("results").beginArray();
+        log_info(LogCategory::Shader, "%-20s %8.2f ms (SPIR-V %.2f ms, serial %.2f ms):", variantName.c_str(),
+                 report.totalMs, report.spirvMs, pairSerialMs);
+        std::vector<const ShaderTargetResult*> failed;
+        for (const auto& result : report.results) {
+            json.beginObject();
+            json.field("target", result.name);
+            if (result.error.empty()) {
+                json.field("cached", result.cached);
+                json.field("translationMs", result.translationMs);
+                json.field("outputHash", hash_to_hex(result.outputHash));
+                log_info(LogCategory::Shader, " %s %.2f%s", result.name.c_str(), result.translationMs,
+                         result.cached ? " (cached)" : "");
+            } else {
+                json.field("error", result.error);
+                log_info(LogCategory::Shader, " %s failed", result.name.c_str());
+                failed.push_back(&result);
+                exitCode = 1;
+            }
+            json.endObject();
+        }
+        log_info(LogCategory::Shader, "\n");
+        for (const ShaderTargetResult* result : failed) {
+            log_error(LogCategory::Shader, "%s (%s): %s\n", variantName.c_str(), result->name.c_str(),
+                      result->error.c_str());
+        }
+        logSpirvStats("vertex", report.vertOptimization, report.vertSpirv);
+        logSpirvStats("fragment", report.fragOptimization, report.fragSpirv);
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+    json.field("totalMs", totalMs);
+    json.field("serialMs", serialMs);
+    json.endObject();
+    log_info(LogCategory::Shader, "Shader precompile: %.2f ms end to end, %.2f ms of translation work\n", totalMs,
+             serialMs);
+
+    const std::string reportPath = options.reportPath.empty() ? "precompile.json" : options.reportPath;
+    if (json.writeToFile(reportPath)) {
+        log_info(LogCategory::Shader, "Wrote %s\n", reportPath.c_str());
+    } else {
+        log_error(LogCategory::Shader, "Failed to write precompile report: %s\n", reportPath.c_str());
+        exitCode = 1;
+    }
+
+    log_shader_cache_stats();
+    LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+    return exitCode;
+}
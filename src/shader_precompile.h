@@ -0,0 +1,8 @@
+#pragma once
+
+#include "app_options.h"
+
+// Translates every shader pair for every shipped backend (GLSL, ESSL, HLSL, MSL, SPIR-V) into the shader
+// cache, using the vertex formats of the last viewer session (pipeline pre-warm list) or the model format.
+// Logs the latency of each pair and writes it to options.reportPath (default precompile.json).
+int run_shader_precompile(const AppOptions& options);
@@ -0,0 +1,314 @@
+#include "shader_reflection.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "hash.h"
+#include "logger.h"
+#include "profiler.h"
+#include "shader_cache.h"
+#include "shader_compiler.h"
+#include "shader_translation.h"
+
+namespace {
+
+constexpr uint32_t REFLECTION_VERSION = 1;
+
+struct ReflectionState {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const ShaderReflection>> reflections;
+};
+
+ReflectionState& state() {
+    static ReflectionState instance;
+    return instance;
+}
+
+uint64_t reflectionKey(const std::string& vertShaderSource, const std::string& fragShaderSource) {
+    uint64_t hash = hash_string("reflection");
+    hash = hash_value(REFLECTION_VERSION, hash);
+    hash = hash_string(vertShaderSource, hash);
+    return hash_string(fragShaderSource, hash);
+}
+
+void addBinding(ShaderReflection& reflection, const std::string& name, LLGL::ResourceType type, long bindFlags,
+                long stage, uint32_t slot) {
+    for (auto& binding : reflection.bindings) {
+        if (binding.name == name && binding.type == type && binding.slot == slot) {
+            binding.stageFlags |= stage;
+            return;
+        }
+    }
+    reflection.bindings.push_back({ name, type, bindFlags, stage, slot });
+}
+
+UniformBlockReflection& findOrAddBlock(ShaderReflection& reflection, const std::string& name, uint32_t slot) {
+    for (auto& block : reflection.uniformBlocks) {
+        if (block.name == name && block.slot == slot) {
+            return block;
+        }
+    }
+    reflection.uniformBlocks.emplace_back();
+    reflection.uniformBlocks.back().name = name;
+    reflection.uniformBlocks.back().slot = slot;
+    return reflection.uniformBlocks.back();
+}
+
+void reflectStage(const std::vector<uint32_t>& spirv, long stage, ShaderReflection& reflection) {
+    spirv_cross::Compiler compiler(spirv);
+    const spirv_cross::ShaderResources resources =
+        compiler.get_shader_resources(compiler.get_active_interface_variables());
+
+    for (const auto& buffer : resources.uniform_buffers) {
+        // Backends bind uniform blocks by block name, the instance is usually anonymous
+        std::string name = compiler.get_name(buffer.base_type_id);
+        if (name.empty()) {
+            name = buffer.name;
+        }
+        const uint32_t slot = compiler.get_decoration(buffer.id, spv::DecorationBinding);
+        addBinding(reflection, name, LLGL::ResourceType::Buffer, LLGL::BindFlags::ConstantBuffer, stage, slot);
+
+        const spirv_cross::SPIRType& type = compiler.get_type(buffer.base_type_id);
+        UniformBlockReflection& block = findOrAddBlock(reflection, name, slot);
+        block.size = static_cast<uint32_t>(compiler.get_declared_struct_size(type));
+        block.stageFlags |= stage;
+        if (block.members.empty()) {
+            for (uint32_t i = 0; i < type.member_types.size(); i++) {
+                UniformMemberReflection member;
+                member.name = compiler.get_member_name(buffer.base_type_id, i);
+                member.offset = compiler.type_struct_member_offset(type, i);
+                member.size = static_cast<uint32_t>(compiler.get_declared_struct_member_size(type, i));
+                block.members.push_back(member);
+            }
+        }
+        for (const auto& range : compiler.get_active_buffer_ranges(buffer.id)) {
+            if (range.index < block.members.size()) {
+                block.members[range.index].used = true;
+            }
+        }
+    }
+
+    for (const auto* images : { &resources.separate_images, &resources.sampled_images }) {
+        for (const auto& image : *images) {
+            addBinding(reflection, image.name, LLGL::ResourceType::Texture, LLGL::BindFlags::Sampled, stage,
+                       compiler.get_decoration(image.id, spv::DecorationBinding));
+        }
+    }
+    for (const auto& sampler : resources.separate_samplers) {
+        addBinding(reflection, sampler.name, LLGL::ResourceType::Sampler, 0, stage,
+                   compiler.get_decoration(sampler.id, spv::DecorationBinding));
+    }
+
+    if (!resources.separate_images.empty() && !resources.separate_samplers.empty()) {
+        compiler.build_combined_image_samplers();
+        for (const auto& combined : compiler.get_combined_image_samplers()) {
+            CombinedSamplerReflection pair{ compiler.get_name(combined.image_id),
+                                            compiler.get_name(combined.sampler_id) };
+            const bool known =
+                std::any_of(reflection.combinedSamplers.begin(), reflection.combinedSamplers.end(),
+                            [&pair](const CombinedSamplerReflection& other) {
+                                return other.textureName == pair.textureName && other.samplerName == pair.samplerName;
+                            });
+            if (!known) {
+                reflection.combinedSamplers.push_back(pair);
+            }
+        }
+    }
+}
+
+// One record per line: "binding <name> <type> <bindFlags> <stageFlags> <slot>",
+// "block <name> <slot> <size> <stageFlags> <memberCount>" followed by "member <name> <offset> <size> <used>"
+// lines, and "combined <texture> <sampler>"
+std::string serializeReflection(const ShaderReflection& reflection) {
+    std::ostringstream out;
+    for (const auto& binding : reflection.bindings) {
+        out << "binding " << binding.name << ' ' << static_cast<int>(binding.type) << ' ' << binding.bindFlags << ' '
+            << binding.stageFlags << ' ' << binding.slot << '\n';
+    }
+    for (const auto& block : reflection.uniformBlocks) {
+        out << "block " << block.name << ' ' << block.slot << ' ' << block.size << ' ' << block.stageFlags << ' '
+            << block.members.size() << '\n';
+        for (const auto& member : block.members) {
+            out << "member " << member.name << ' ' << member.offset << ' ' << member.size << ' ' << member.used
+                << '\n';
+        }
+    }
+    for (const auto& combined : reflection.combinedSamplers) {
+        out << "combined " << combined.textureName << ' ' << combined.samplerName << '\n';
+    }
+    return out.str();
+}
+
+bool parseReflection(const std::string& text, ShaderReflection& reflection) {
+    std::istringstream in(text);
+    std::string record;
+    while (in >> record) {
+        if (record == "binding") {
+            ShaderBindingReflection binding;
+            int type = 0;
+            if (!(in >> binding.name >> type >> binding.bindFlags >> binding.stageFlags >> binding.slot)) {
+                return false;
+            }
+            binding.type = static_cast<LLGL::ResourceType>(type);
+            reflection.bindings.push_back(binding);
+        } else if (record == "block") {
+            UniformBlockReflection block;
+            size_t memberCount = 0;
+            if (!(in >> block.name >> block.slot >> block.size >> block.stageFlags >> memberCount)) {
+                return false;
+            }
+            block.members.resize(memberCount);
+            for (auto& member : block.members) {
+                if (!(in >> record >> member.name >> member.offset >> member.size >> member.used) ||
+                    record != "member") {
+                    return false;
+                }
+            }
+            reflection.uniformBlocks.push_back(std::move(block));
+        } else if (record == "combined") {
+            CombinedSamplerReflection combined;
+            if (!(in >> combined.textureName >> combined.samplerName)) {
+                return false;
+            }
+            reflection.combinedSamplers.push_back(combined);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const ShaderReflection> storeReflection(uint64_t key,
+                                                        std::shared_ptr<const ShaderReflection> reflection) {
+    ReflectionState& reflectionState = state();
+    std::lock_guard<std::mutex> lock(reflectionState.mutex);
+    // Another thread may have reflected the same pair meanwhile; both results are identical
+    return reflectionState.reflections.emplace(key, std::move(reflection)).first->second;
+}
+
+std::shared_ptr<const ShaderReflection> findReflection(uint64_t key) {
+    ReflectionState& reflectionState = state();
+    std::lock_guard<std::mutex> lock(reflectionState.mutex);
+    auto it = reflectionState.reflections.find(key);
+    return it != reflectionState.reflections.end() ? it->second : nullptr;
+}
+
+} // anonymous namespace
+
+uint32_t UniformBlockReflection::usedOffset() const {
+    uint32_t offset = size;
+    for (const auto& member : members) {
+        if (member.used) {
+            offset = std::min(offset, member.offset);
+        }
+    }
+    return offset == size ? 0 : offset;
+}
+
+uint32_t UniformBlockReflection::usedSize() const {
+    uint32_t end = 0;
+    for (const auto& member : members) {
+        if (member.used) {
+            end = std::max(end, member.offset + member.size);
+        }
+    }
+    return end > 0 ? end - usedOffset() : 0;
+}
+
+const UniformBlockReflection* ShaderReflection::findUniformBlock(const std::string& name) const {
+    for (const auto& block : uniformBlocks) {
+        if (block.name == name) {
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+ShaderReflection reflect_spirv(const std::vector<uint32_t>& vertSpirv, const std::vector<uint32_t>& fragSpirv) {
+    PROFILE_SCOPE("reflect_spirv");
+    ShaderReflection reflection;
+    reflectStage(vertSpirv, LLGL::StageFlags::VertexStage, reflection);
+    reflectStage(fragSpirv, LLGL::StageFlags::FragmentStage, reflection);
+    std::sort(reflection.bindings.begin(), reflection.bindings.end(),
+              [](const ShaderBindingReflection& a, const ShaderBindingReflection& b) {
+                  return a.slot != b.slot ? a.slot < b.slot : a.type < b.type;
+              });
+    return reflection;
+}
+
+std::shared_ptr<const ShaderReflection> reflect_shader_sources(const std::string& vertShaderSource,
+                                                               const std::string& fragShaderSource) {
+    const uint64_t key = reflectionKey(vertShaderSource, fragShaderSource);
+    if (auto reflection = findReflection(key)) {
+        return reflection;
+    }
+
+    auto reflection = std::make_shared<ShaderReflection>();
+    ShaderCode text, unused;
+    if (read_cached_shaders(key, REFLECTION_CACHE_TARGET, text, unused) &&
+        std::holds_alternative<std::string>(text) && parseReflection(std::get<std::string>(text), *reflection)) {
+        return storeReflection(key, std::move(reflection));
+    }
+
+    PROFILE_SCOPE("reflect_shader_sources");
+    const auto start = std::chrono::steady_clock::now();
+    const ShaderCompiler& compiler = ShaderCompiler::instance();
+    *reflection = reflect_spirv(compiler.compileToSpirv(EShLangVertex, vertShaderSource),
+                                compiler.compileToSpirv(EShLangFragment, fragShaderSource));
+    write_cached_shaders(key, REFLECTION_CACHE_TARGET, serializeReflection(*reflection), std::string(),
+                         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return storeReflection(key, std::move(reflection));
+}
+
+std::shared_ptr<const ShaderReflection> reflect_shaders(const std::string& shaderName,
+                                                        const std::vector<std::string>& defines) {
+    std::string vertSource, fragSource;
+    load_shader_sources(shaderName, vertSource, fragSource);
+    return reflect_shader_sources(apply_shader_defines(vertSource, defines), apply_shader_defines(fragSource, defines));
+}
+
+void capture_shader_reflection(const std::string& vertShaderSource, const std::string& fragShaderSource,
+                               const std::vector<uint32_t>& vertSpirv, const std::vector<uint32_t>& fragSpirv) {
+    const uint64_t key = reflectionKey(vertShaderSource, fragShaderSource);
+    if (findReflection(key)) {
+        return;
+    }
+    auto reflection = std::make_shared<ShaderReflection>(reflect_spirv(vertSpirv, fragSpirv));
+    write_cached_shaders(key, REFLECTION_CACHE_TARGET, serializeReflection(*reflection), std::string(), 0.0);
+    storeReflection(key, std::move(reflection));
+}
+
+LLGL::PipelineLayoutDescriptor make_pipeline_layout_desc(const ShaderReflection& reflection) {
+    LLGL::PipelineLayoutDescriptor layoutDesc;
+    uint32_t nextSlot = 0;
+    for (const auto& binding : reflection.bindings) {
+        layoutDesc.bindings.push_back(LLGL::BindingDescriptor{ binding.name.c_str(), binding.type, binding.bindFlags,
+                                                               binding.stageFlags, binding.slot });
+        nextSlot = std::max(nextSlot, binding.slot + 1);
+    }
+    // Combined samplers take the slots after the last binding and the name of their texture
+    for (const auto& combined : reflection.combinedSamplers) {
+        layoutDesc.combinedTextureSamplers.push_back(LLGL::CombinedTextureSamplerDescriptor{
+            combined.textureName.c_str(), combined.textureName.c_str(), combined.samplerName.c_str(), nextSlot++ });
+    }
+    return layoutDesc;
+}
+
+void log_shader_reflection(const std::string& name, const ShaderReflection& reflection) {
+    for (const auto& block : reflection.uniformBlocks) {
+        std::string used;
+        uint32_t usedCount = 0;
+        for (const auto& member : block.members) {
+            if (member.used) {
+                used += (used.empty() ? "" : ", ") + member.name;
+                usedCount++;
+            }
+        }
+        log_info(LogCategory::Shader, "Reflection: %s reads %u of %zu %s members (%s), uploads %u of %u bytes\n",
+                 name.c_str(), usedCount, block.members.size(), block.name.c_str(), used.c_str(), block.usedSize(),
+                 block.size);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+// Resource binding of a shader pair, merged over both stages
+struct ShaderBindingReflection {
+    std::string name;
+    LLGL::ResourceType type = LLGL::ResourceType::Undefined;
+    long bindFlags = 0;
+    long stageFlags = 0;
+    uint32_t slot = 0;
+};
+
+struct UniformMemberReflection {
+    std::string name;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    bool used = false; // Read by the code of either stage
+};
+
+// std140 uniform block and the members its shaders actually read
+struct UniformBlockReflection {
+    std::string name;
+    uint32_t slot = 0;
+    uint32_t size = 0;
+    long stageFlags = 0;
+    std::vector<UniformMemberReflection> members;
+
+    // Smallest byte range covering every used member; uploads can skip the rest of the block
+    uint32_t usedOffset() const;
+    uint32_t usedSize() const;
+};
+
+// Texture and sampler pair that GLSL backends combine into one sampler2D (see cross_compile_stage)
+struct CombinedSamplerReflection {
+    std::string textureName;
+    std::string samplerName;
+};
+
+// SPIRV-Cross reflection of one vertex/fragment pair: the resources the entry points use, by binding slot
+struct ShaderReflection {
+    std::vector<ShaderBindingReflection> bindings; // Sorted by slot, the order of SetResource indices
+    std::vector<UniformBlockReflection> uniformBlocks;
+    std::vector<CombinedSamplerReflection> combinedSamplers;
+
+    const UniformBlockReflection* findUniformBlock(const std::string& name) const;
+};
+
+// Reflects unoptimized SPIR-V of both stages
+ShaderReflection reflect_spirv(const std::vector<uint32_t>& vertSpirv, const std::vector<uint32_t>& fragSpirv);
+
+// Reflection of a preprocessed source pair. Memoized per process and kept in the shader cache; compiles the
+// sources with glslang only when neither has it. Thread-safe.
+std::shared_ptr<const ShaderReflection> reflect_shader_sources(const std::string& vertShaderSource,
+                                                               const std::string& fragShaderSource);
+
+// reflect_shader_sources of shader/<name>.vert/.frag with the permutation defines applied
+std::shared_ptr<const ShaderReflection> reflect_shaders(const std::string& shaderName,
+                                                        const std::vector<std::string>& defines = {});
+
+// Records the reflection of SPIR-V generated by a translation, so reflect_shader_sources needs no extra compile
+void capture_shader_reflection(const std::string& vertShaderSource, const std::string& fragShaderSource,
+                               const std::vector<uint32_t>& vertSpirv, const std::vector<uint32_t>& fragSpirv);
+
+// Minimal pipeline layout: one binding per used resource, plus the combined samplers of GLSL backends
+LLGL::PipelineLayoutDescriptor make_pipeline_layout_desc(const ShaderReflection& reflection);
+
+// Logs the uniform members a shader reads and the bytes an upload of the used range saves
+void log_shader_reflection(const std::string& name, const ShaderReflection& reflection);
@@ -1,242 +1,71 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <future>
+#include <sstream>
+#include <stdexcept>
 #include <variant>
 
-#include <glslang/Include/ResourceLimits.h>
-#include <glslang/Public/ShaderLang.h>
-#include <glslang/SPIRV/SpvTools.h>
-
 #include <LLGL/LLGL.h>
 #include <LLGL/Utils/VertexFormat.h>
-#include "spirv_cross/spirv.hpp"
 
-#include "spirv_cross/spirv.hpp"
-#include "spirv_cross/spirv_glsl.hpp"
-#include "spirv_cross/spirv_hlsl.hpp"
-#include "spirv_cross/spirv_msl.hpp"
+#include "embedded_shaders.h"
+#include "hash.h"
+#include "logger.h"
+#include "shader_cache.h"
+#include "shader_compiler.h"
+#include "shader_reflection.h"
 #include "shader_translation.h"
-
-extern LLGL::RenderSystemPtr llgl_renderer;
-
-static TBuiltInResource InitResources() {
-    TBuiltInResource Resources;
-    auto caps = llgl_renderer->GetRenderingCaps();
-    auto limits = caps.limits;
-
-    Resources.maxLights = 32;
-    Resources.maxClipPlanes = 6;
-    Resources.maxTextureUnits = 32;
-    Resources.maxTextureCoords = 32;
-    Resources.maxVertexAttribs = 64;
-    Resources.maxVertexUniformComponents = 4096;
-    Resources.maxVaryingFloats = 64;
-    Resources.maxVertexTextureImageUnits = 32;
-    Resources.maxCombinedTextureImageUnits = 80;
-    Resources.maxTextureImageUnits = 32;
-    Resources.maxFragmentUniformComponents = 4096;
-    Resources.maxDrawBuffers = 32;
-    Resources.maxVertexUniformVectors = 128;
-    Resources.maxVaryingVectors = 8;
-    Resources.maxFragmentUniformVectors = 16;
-    Resources.maxVertexOutputVectors = 16;
-    Resources.maxFragmentInputVectors = 15;
-    Resources.minProgramTexelOffset = -8;
-    Resources.maxProgramTexelOffset = 7;
-    Resources.maxClipDistances = 8;
-    Resources.maxComputeWorkGroupCountX = limits.maxComputeShaderWorkGroups[0];
-    Resources.maxComputeWorkGroupCountY = limits.maxComputeShaderWorkGroups[1];
-    Resources.maxComputeWorkGroupCountZ = limits.maxComputeShaderWorkGroups[2];
-    Resources.maxComputeWorkGroupSizeX = limits.maxComputeShaderWorkGroupSize[0];
-    Resources.maxComputeWorkGroupSizeY = limits.maxComputeShaderWorkGroupSize[1];
-    Resources.maxComputeWorkGroupSizeZ = limits.maxComputeShaderWorkGroupSize[2];
-    Resources.maxComputeUniformComponents = 1024;
-    Resources.maxComputeTextureImageUnits = 16;
-    Resources.maxComputeImageUniforms = 8;
-    Resources.maxComputeAtomicCounters = 8;
-    Resources.maxComputeAtomicCounterBuffers = 1;
-    Resources.maxVaryingComponents = 60;
-    Resources.maxVertexOutputComponents = 64;
-    Resources.maxGeometryInputComponents = 64;
-    Resources.maxGeometryOutputComponents = 128;
-    Resources.maxFragmentInputComponents = 128;
-    Resources.maxImageUnits = 8;
-    Resources.maxCombinedImageUnitsAndFragmentOutputs = 8;
-    Resources.maxCombinedShaderOutputResources = 8;
-    Resources.maxImageSamples = 0;
-    Resources.maxVertexImageUniforms = 0;
-    Resources.maxTessControlImageUniforms = 0;
-    Resources.maxTessEvaluationImageUniforms = 0;
-    Resources.maxGeometryImageUniforms = 0;
-    Resources.maxFragmentImageUniforms = 8;
-    Resources.maxCombinedImageUniforms = 8;
-    Resources.maxGeometryTextureImageUnits = 16;
-    Resources.maxGeometryOutputVertices = 256;
-    Resources.maxGeometryTotalOutputComponents = 1024;
-    Resources.maxGeometryUniformComponents = 1024;
-    Resources.maxGeometryVaryingComponents = 64;
-    Resources.maxTessControlInputComponents = 128;
-    Resources.maxTessControlOutputComponents = 128;
-    Resources.maxTessControlTextureImageUnits = 16;
-    Resources.maxTessControlUniformComponents = 1024;
-    Resources.maxTessControlTotalOutputComponents = 4096;
-    Resources.maxTessEvaluationInputComponents = 128;
-    Resources.maxTessEvaluationOutputComponents = 128;
-    Resources.maxTessEvaluationTextureImageUnits = 16;
-    Resources.maxTessEvaluationUniformComponents = 1024;
-    Resources.maxTessPatchComponents = 120;
-    Resources.maxPatchVertices = 32;
-    Resources.maxTessGenLevel = 64;
-    Resources.maxViewports = limits.maxViewports;
-    Resources.maxVertexAtomicCounters = 0;
-    Resources.maxTessControlAtomicCounters = 0;
-    Resources.maxTessEvaluationAtomicCounters = 0;
-    Resources.maxGeometryAtomicCounters = 0;
-    Resources.maxFragmentAtomicCounters = 8;
-    Resources.maxCombinedAtomicCounters = 8;
-    Resources.maxAtomicCounterBindings = 1;
-    Resources.maxVertexAtomicCounterBuffers = 0;
-    Resources.maxTessControlAtomicCounterBuffers = 0;
-    Resources.maxTessEvaluationAtomicCounterBuffers = 0;
-    Resources.maxGeometryAtomicCounterBuffers = 0;
-    Resources.maxFragmentAtomicCounterBuffers = 1;
-    Resources.maxCombinedAtomicCounterBuffers = 1;
-    Resources.maxAtomicCounterBufferSize = 16384;
-    Resources.maxTransformFeedbackBuffers = 4;
-    Resources.maxTransformFeedbackInterleavedComponents = 64;
-    Resources.maxCullDistances = 8;
-    Resources.maxCombinedClipAndCullDistances = 8;
-    Resources.maxSamples = 4;
-    Resources.maxMeshOutputVerticesNV = 256;
-    Resources.maxMeshOutputPrimitivesNV = 512;
-    Resources.maxMeshWorkGroupSizeX_NV = 32;
-    Resources.maxMeshWorkGroupSizeY_NV = 1;
-    Resources.maxMeshWorkGroupSizeZ_NV = 1;
-    Resources.maxTaskWorkGroupSizeX_NV = 32;
-    Resources.maxTaskWorkGroupSizeY_NV = 1;
-    Resources.maxTaskWorkGroupSizeZ_NV = 1;
-    Resources.maxMeshViewCountNV = 4;
-
-    Resources.limits.nonInductiveForLoops = 1;
-    Resources.limits.whileLoops = 1;
-    Resources.limits.doWhileLoops = 1;
-    Resources.limits.generalUniformIndexing = 1;
-    Resources.limits.generalAttributeMatrixVectorIndexing = 1;
-    Resources.limits.generalVaryingIndexing = 1;
-    Resources.limits.generalSamplerIndexing = 1;
-    Resources.limits.generalVariableIndexing = 1;
-    Resources.limits.generalConstantMatrixVectorIndexing = 1;
-
-    return Resources;
-}
-
-glslang::TShader create_shader(EShLanguage type, std::filesystem::path shaderPath, char** shaderSourceC) {
-    glslang::TShader shaderGlslang(type);
-
-    shaderGlslang.setStrings(shaderSourceC, 1);
-
-    shaderGlslang.setSourceFile(shaderPath.string().c_str());
-
-    shaderGlslang.setEnvInput(glslang::EShSourceGlsl, type, glslang::EShClientVulkan, 100);
-    shaderGlslang.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_5);
-    shaderGlslang.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_2);
-    shaderGlslang.setTextureSamplerTransformMode(EShTextureSamplerTransformMode::EShTexSampTransKeep);
-
-    return shaderGlslang;
-}
-
-void parse_shader(glslang::TShader& vertShaderGlslang, glslang::TShader& fragShaderGlslang) {
-    TBuiltInResource builtInResources = InitResources();
-    vertShaderGlslang.parse(&builtInResources, 120, true, EShMsgDefault);
-    const char* vertShaderGlslangLog = vertShaderGlslang.getInfoLog();
-
-    if (vertShaderGlslangLog != nullptr && *vertShaderGlslangLog != '\0') {
-        printf(vertShaderGlslangLog);
-        throw std::runtime_error("Failed to compile vertex shader");
-    }
-
-    fragShaderGlslang.parse(&builtInResources, 120, true, EShMsgDefault);
-    const char* fragShaderGlslangLog = fragShaderGlslang.getInfoLog();
-
-    if (fragShaderGlslangLog != nullptr && *fragShaderGlslangLog != '\0') {
-        printf(fragShaderGlslangLog);
-        throw std::runtime_error("Failed to compile fragment shader");
-    }
-}
+#include "profiler.h"
+#include "thread_pool.h"
 
 void glslang_spirv_cross_test() {
-    glslang::InitializeProcess();
-
     std::filesystem::path shaderPath = "../shader";
     std::filesystem::path vertShaderPath = shaderPath / "test.vert";
     std::filesystem::path fragShaderPath = shaderPath / "test.frag";
 
-    std::string vertShaderSource;
-    std::string fragShaderSource;
-    std::ifstream shaderVertFile(shaderPath);
+    std::ifstream shaderVertFile(vertShaderPath);
     if (!shaderVertFile.is_open()) {
-        LLGL::Log::Printf("Failed to open shader file");
+        log_error(LogCategory::Shader, "Failed to open shader file\n");
         throw std::runtime_error("Failed to open shader file");
     }
-    vertShaderSource = std::string((std::istreambuf_iterator<char>(shaderVertFile)), std::istreambuf_iterator<char>());
-    char* vertShaderSourceC = vertShaderSource.data();
-    auto vertShaderGlslang = create_shader(EShLangVertex, vertShaderPath, &vertShaderSourceC);
+    std::string vertShaderSource((std::istreambuf_iterator<char>(shaderVertFile)), std::istreambuf_iterator<char>());
     std::ifstream shaderFragFile(fragShaderPath);
     if (!shaderFragFile.is_open()) {
-        LLGL::Log::Printf("Failed to open shader file");
+        log_error(LogCategory::Shader, "Failed to open shader file\n");
         throw std::runtime_error("Failed to open shader file");
     }
-    fragShaderSource = std::string((std::istreambuf_iterator<char>(shaderFragFile)), std::istreambuf_iterator<char>());
-    char* fragShaderSourceC = fragShaderSource.data();
-    auto fragShaderGlslang = create_shader(EShLangFragment, fragShaderPath, &fragShaderSourceC);
-
-    glslang::TProgram program;
-    parse_shader(vertShaderGlslang, fragShaderGlslang);
-
-    auto vertShaderGlslangIntermediate = vertShaderGlslang.getIntermediate();
-    auto fragShaderGlslangIntermediate = fragShaderGlslang.getIntermediate();
-
-    if (vertShaderGlslangIntermediate == nullptr || fragShaderGlslangIntermediate == nullptr) {
-        LLGL::Log::Printf("Failed to link shaders");
-        throw std::runtime_error("Failed to link shaders");
-    }
-
-    spv::SpvBuildLogger logger;
-    std::vector<uint32_t> spirvSourceVert;
-    std::vector<uint32_t> spirvSourceFrag;
-
-    glslang::SpvOptions spvOptions;
-    spvOptions.validate = false;
-    spvOptions.disableOptimizer = true;
-    spvOptions.optimizeSize = false;
+    std::string fragShaderSource((std::istreambuf_iterator<char>(shaderFragFile)), std::istreambuf_iterator<char>());
 
-    glslang::GlslangToSpv(*vertShaderGlslangIntermediate, spirvSourceVert, &logger, &spvOptions);
-    glslang::GlslangToSpv(*fragShaderGlslangIntermediate, spirvSourceFrag, &logger, &spvOptions);
+    const ShaderCompiler& compiler = ShaderCompiler::instance();
+    std::vector<uint32_t> spirvSourceVert =
+        compiler.compileToSpirv(EShLangVertex, vertShaderSource, vertShaderPath.string());
+    std::vector<uint32_t> spirvSourceFrag =
+        compiler.compileToSpirv(EShLangFragment, fragShaderSource, fragShaderPath.string());
 
-    glslang::FinalizeProcess();
-
-    spirv_cross::CompilerGLSL::Options scoptions;
-    scoptions.version = 120;
-    scoptions.es = false;
+    spirv_cross::CompilerGLSL::Options scoptions = compiler.getGlslOptions(120, false);
     spirv_cross::CompilerGLSL glslVert(spirvSourceVert);
     glslVert.set_common_options(scoptions);
-    LLGL::Log::Printf("GLSL:\n%s\n", glslVert.compile().c_str());
+    log_info(LogCategory::Shader, "GLSL:\n%s\n", glslVert.compile().c_str());
     spirv_cross::CompilerGLSL glslFrag(spirvSourceFrag);
     glslFrag.set_common_options(scoptions);
-    LLGL::Log::Printf("GLSL:\n%s\n", glslFrag.compile().c_str());
+    log_info(LogCategory::Shader, "GLSL:\n%s\n", glslFrag.compile().c_str());
 
-    spirv_cross::CompilerHLSL::Options hlslOptions;
-    hlslOptions.shader_model = 500;
+    spirv_cross::CompilerHLSL::Options hlslOptions = compiler.getHlslOptions(500);
     spirv_cross::CompilerHLSL hlslVert(spirvSourceVert);
     hlslVert.set_hlsl_options(hlslOptions);
-    LLGL::Log::Printf("HLSL:\n%s\n", hlslVert.compile().c_str());
+    log_info(LogCategory::Shader, "HLSL:\n%s\n", hlslVert.compile().c_str());
     spirv_cross::CompilerHLSL hlslFrag(spirvSourceFrag);
     hlslFrag.set_hlsl_options(hlslOptions);
-    LLGL::Log::Printf("HLSL:\n%s\n", hlslFrag.compile().c_str());
+    log_info(LogCategory::Shader, "HLSL:\n%s\n", hlslFrag.compile().c_str());
 
     spirv_cross::CompilerMSL mslVert(spirvSourceVert);
-    LLGL::Log::Printf("MSL:\n%s\n", mslVert.compile().c_str());
+    log_info(LogCategory::Shader, "MSL:\n%s\n", mslVert.compile().c_str());
     spirv_cross::CompilerMSL mslFrag(spirvSourceFrag);
-    LLGL::Log::Printf("MSL:\n%s\n", mslFrag.compile().c_str());
+    log_info(LogCategory::Shader, "MSL:\n%s\n", mslFrag.compile().c_str());
 }
 
 bool is_glsl(const std::vector<LLGL::ShadingLanguage>& languages, int& version) {
@@ -329,204 +158,594 @@ bool is_spirv(const std::vector<LLGL::ShadingLanguage>& languages, int& version)
     return isSPIRV;
 }
 
-void generate_shader_from_string(LLGL::ShaderDescriptor& vertShaderDesc, LLGL::ShaderDescriptor& fragShaderDesc,
-                                 const std::vector<LLGL::ShadingLanguage>& languages, LLGL::VertexFormat& vertexFormat,
-                                 std::string vertShaderSource, std::string fragShaderSource,
-                                 std::variant<std::string, std::vector<uint32_t>>& vertShader,
-                                 std::variant<std::string, std::vector<uint32_t>>& fragShader) {
-    glslang::InitializeProcess();
-    char* vertShaderSourceC = vertShaderSource.data();
-    auto vertShaderGlslang = create_shader(EShLangVertex, "", &vertShaderSourceC);
-    char* fragShaderSourceC = fragShaderSource.data();
-    auto fragShaderGlslang = create_shader(EShLangFragment, "", &fragShaderSourceC);
+namespace {
 
-    parse_shader(vertShaderGlslang, fragShaderGlslang);
+// Bump when the translation below changes its output, so stale cache entries are never used
+constexpr uint32_t TRANSLATION_VERSION = 1;
 
-    auto vertShaderGlslangIntermediate = vertShaderGlslang.getIntermediate();
-    auto fragShaderGlslangIntermediate = fragShaderGlslang.getIntermediate();
+enum class ShaderTarget : uint32_t { GLSL, ESSL, SPIRV, HLSL, MSL };
 
-    if (vertShaderGlslangIntermediate == nullptr || fragShaderGlslangIntermediate == nullptr) {
-        printf("Failed to get intermediate\n");
-        exit(1);
+bool select_shader_target(const std::vector<LLGL::ShadingLanguage>& languages, ShaderTarget& target, int& version) {
+    if (is_glsl(languages, version)) {
+        target = ShaderTarget::GLSL;
+    } else if (is_glsles(languages, version)) {
+        target = ShaderTarget::ESSL;
+    } else if (is_spirv(languages, version)) {
+        target = ShaderTarget::SPIRV;
+    } else if (is_hlsl(languages, version)) {
+        target = ShaderTarget::HLSL;
+    } else if (is_metal(languages, version)) {
+        target = ShaderTarget::MSL;
+    } else {
+        return false;
     }
+    return true;
+}
 
-    spv::SpvBuildLogger logger;
-    std::vector<uint32_t> spirvSourceVert;
-    std::vector<uint32_t> spirvSourceFrag;
+#ifndef TEST_LLGL_SPIRV_OPTIMIZATION
+#define TEST_LLGL_SPIRV_OPTIMIZATION "none"
+#endif
 
-    glslang::SpvOptions spvOptions;
-    spvOptions.validate = false;
-    spvOptions.disableOptimizer = true;
-    spvOptions.optimizeSize = false;
+// Build default (TEST_LLGL_SPIRV_OPTIMIZATION), replaced by set_spirv_optimization
+std::atomic<SpirvOptimization>& default_optimization() {
+    static std::atomic<SpirvOptimization> level = []() {
+        SpirvOptimization buildLevel = SpirvOptimization::None;
+        parse_spirv_optimization(TEST_LLGL_SPIRV_OPTIMIZATION, buildLevel);
+        return buildLevel;
+    }();
+    return level;
+}
 
-    glslang::GlslangToSpv(*vertShaderGlslangIntermediate, spirvSourceVert, &logger, &spvOptions);
-    glslang::GlslangToSpv(*fragShaderGlslangIntermediate, spirvSourceFrag, &logger, &spvOptions);
+// A "spirv-opt: <none|size|performance>" comment anywhere in a stage overrides the default for that stage
+SpirvOptimization stage_optimization(const std::string& source) {
+    constexpr const char* DIRECTIVE = "spirv-opt:";
+    const size_t position = source.find(DIRECTIVE);
+    if (position != std::string::npos) {
+        std::istringstream stream(source.substr(position + std::strlen(DIRECTIVE)));
+        std::string name;
+        SpirvOptimization level = SpirvOptimization::None;
+        if (stream >> name && parse_spirv_optimization(name, level)) {
+            return level;
+        }
+    }
+    return default_optimization().load();
+}
 
-    glslang::FinalizeProcess();
-    int version = 0;
-    if (is_glsl(languages, version)) {
-        spirv_cross::CompilerGLSL::Options scoptions;
-        scoptions.version = version;
-        scoptions.es = false;
+// HLSL matches vertex inputs by semantic: everything but the position becomes TEXCOORD<n>
+void remap_hlsl_attributes(LLGL::VertexFormat& vertexFormat) {
+    int semanticIndex = 0;
+    for (auto& attribute : vertexFormat.attributes) {
+        if (attribute.name.compare("position") != 0) {
+            attribute.name = "TEXCOORD";
+            attribute.semanticIndex = semanticIndex++;
+        }
+    }
+}
+
+// Everything that changes the output: sources, target and version, the glslang/SPIR-V setup of
+// ShaderCompiler, the optimization level of each stage, and the vertex attributes (HLSL semantic remaps)
+uint64_t translation_key(const std::string& vertShaderSource, const std::string& fragShaderSource,
+                         ShaderTarget target, int version, const LLGL::VertexFormat& vertexFormat) {
+    uint64_t hash = hash_value(TRANSLATION_VERSION);
+    hash = hash_string(vertShaderSource, hash);
+    hash = hash_string(fragShaderSource, hash);
+    hash = hash_value(target, hash);
+    // SPIR-V and MSL output doesn't depend on the reported version, so all versions share one entry
+    hash = hash_value(target == ShaderTarget::SPIRV || target == ShaderTarget::MSL ? 0 : version, hash);
+    hash = hash_string("glsl120 vulkan100 vulkan1.2 spv1.5 keep-samplers", hash);
+    hash = hash_value(stage_optimization(vertShaderSource), hash);
+    hash = hash_value(stage_optimization(fragShaderSource), hash);
 #ifdef __APPLE__
-        scoptions.enable_420pack_extension = false;
+    hash = hash_string("no-420pack", hash);
 #endif
+    if (target == ShaderTarget::HLSL) {
+        for (const auto& attribute : vertexFormat.attributes) {
+            hash = hash_string(std::string(attribute.name.c_str()), hash);
+            hash = hash_value(attribute.semanticIndex, hash);
+        }
+    }
+    return hash;
+}
 
-        spirv_cross::CompilerGLSL glslVert(spirvSourceVert);
-        glslVert.set_common_options(scoptions);
-        vertShader = glslVert.compile();
-        vertShaderDesc = { LLGL::ShaderType::Vertex, std::get<std::string>(vertShader).c_str() };
-        vertShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        printf("GLSL:\n%s\n", std::get<std::string>(vertShader).c_str());
-
-        spirv_cross::CompilerGLSL glslFrag(spirvSourceFrag);
-        glslFrag.set_common_options(scoptions);
-        glslFrag.build_combined_image_samplers();
-        auto& samplers = glslFrag.get_combined_image_samplers();
-        for (const auto& sampler : samplers) {
-            glslFrag.set_name(sampler.combined_id, glslFrag.get_name(sampler.image_id));
-
-            if (glslFrag.has_decoration(sampler.image_id, spv::DecorationDescriptorSet)) {
-                uint32_t set = glslFrag.get_decoration(sampler.image_id, spv::DecorationDescriptorSet);
-                glslFrag.set_decoration(sampler.combined_id, spv::DecorationDescriptorSet, set);
-            }
+// Translated stage as a dump file named by the translation key, e.g. 0123456789abcdef.vert.hlsl
+void dump_shader_code(ShaderTarget target, uint64_t key, const char* stage, const ShaderCode& code) {
+    constexpr const char* EXTENSIONS[] = { "glsl", "essl", "spv", "hlsl", "msl" };
+    const std::string fileName = hash_to_hex(key) + "." + stage + "." + EXTENSIONS[static_cast<uint32_t>(target)];
+    if (const auto* text = std::get_if<std::string>(&code)) {
+        log_dump(LogCategory::Shader, fileName, *text);
+        return;
+    }
+    const auto& words = std::get<std::vector<uint32_t>>(code);
+    log_dump(LogCategory::Shader, fileName,
+             std::string(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint32_t)), true);
+}
 
-            if (glslFrag.has_decoration(sampler.image_id, spv::DecorationBinding)) {
-                uint32_t binding = glslFrag.get_decoration(sampler.image_id, spv::DecorationBinding);
-                glslFrag.set_decoration(sampler.combined_id, spv::DecorationBinding, binding);
-            }
+// Points the descriptors at the translated code, which must outlive them
+void describe_shaders(ShaderTarget target, LLGL::ShaderDescriptor& vertShaderDesc,
+                      LLGL::ShaderDescriptor& fragShaderDesc, const ShaderCode& vertShader,
+                      const ShaderCode& fragShader) {
+    auto describe = [target](LLGL::ShaderDescriptor& desc, LLGL::ShaderType type, const ShaderCode& code) {
+        if (target == ShaderTarget::SPIRV) {
+            const auto& words = std::get<std::vector<uint32_t>>(code);
+            desc = { type, reinterpret_cast<const char*>(words.data()) };
+            desc.sourceType = LLGL::ShaderSourceType::BinaryBuffer;
+            desc.sourceSize = words.size() * sizeof(uint32_t);
+            return;
         }
-        fragShader = glslFrag.compile();
-        fragShaderDesc = { LLGL::ShaderType::Fragment, std::get<std::string>(fragShader).c_str() };
-        fragShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        printf("GLSL:\n%s\n", std::get<std::string>(fragShader).c_str());
-    } else if (is_glsles(languages, version)) {
-        spirv_cross::CompilerGLSL::Options scoptions;
-        scoptions.version = version;
-        scoptions.es = true;
-#ifdef __APPLE__
-        scoptions.enable_420pack_extension = false;
-#endif
+        desc = { type, std::get<std::string>(code).c_str() };
+        desc.sourceType = LLGL::ShaderSourceType::CodeString;
+        if (target == ShaderTarget::HLSL) {
+            desc.entryPoint = "main";
+            desc.profile = type == LLGL::ShaderType::Vertex ? "vs_5_0" : "ps_5_0";
+        } else if (target == ShaderTarget::MSL) {
+            // desc.flags |= LLGL::ShaderCompileFlags::DefaultLibrary;
+            desc.entryPoint = "main0";
+            desc.profile = "2.1";
+        }
+    };
+    describe(vertShaderDesc, LLGL::ShaderType::Vertex, vertShader);
+    describe(fragShaderDesc, LLGL::ShaderType::Fragment, fragShader);
+}
 
-        spirv_cross::CompilerGLSL glslVert(spirvSourceVert);
-        glslVert.set_common_options(scoptions);
-        vertShader = glslVert.compile();
-        vertShaderDesc = { LLGL::ShaderType::Vertex, std::get<std::string>(vertShader).c_str() };
-        vertShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        printf("GLSL ES:\n%s\n", std::get<std::string>(vertShader).c_str());
-
-        spirv_cross::CompilerGLSL glslFrag(spirvSourceFrag);
-        glslFrag.set_common_options(scoptions);
-        fragShader = glslFrag.compile();
-        fragShaderDesc = { LLGL::ShaderType::Fragment, std::get<std::string>(fragShader).c_str() };
-        fragShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        printf("GLSL ES:\n%s\n", std::get<std::string>(fragShader).c_str());
-    } else if (is_spirv(languages, version)) {
-        vertShader = spirvSourceVert;
-        char* vertShaderSourceC = (char*) malloc(spirvSourceVert.size() * sizeof(uint32_t));
-        memcpy(vertShaderSourceC, &(*spirvSourceVert.begin()), spirvSourceVert.size() * sizeof(uint32_t));
-        vertShaderDesc = { LLGL::ShaderType::Vertex, vertShaderSourceC };
-        vertShaderDesc.sourceType = LLGL::ShaderSourceType::BinaryBuffer;
-        vertShaderDesc.sourceSize = spirvSourceVert.size() * sizeof(uint32_t);
-
-        fragShader = spirvSourceFrag;
-        char* fragShaderSourceC = (char*) malloc(spirvSourceFrag.size() * sizeof(uint32_t));
-        memcpy(fragShaderSourceC, &(*spirvSourceFrag.begin()), spirvSourceFrag.size() * sizeof(uint32_t));
-        fragShaderDesc = { LLGL::ShaderType::Fragment, (char*) fragShaderSourceC };
-        fragShaderDesc.sourceType = LLGL::ShaderSourceType::BinaryBuffer;
-        fragShaderDesc.sourceSize = spirvSourceFrag.size() * sizeof(uint32_t);
-
-        printf("SPIRV:\n");
-    } else if (is_hlsl(languages, version)) {
-        spirv_cross::CompilerHLSL::Options hlslOptions;
-        hlslOptions.shader_model = version / 10;
-        int semanticIndex = 0;
-        for (auto& attribute : vertexFormat.attributes) {
-            if (attribute.name.compare("position") != 0) {
-                attribute.name = "TEXCOORD";
-                attribute.semanticIndex = semanticIndex++;
+// SPIRV-Cross of one stage. Every call builds its own compiler object, so both stages and any number of
+// targets can be cross-compiled concurrently from the same SPIR-V.
+// Optimized stages also lose the resources they never use.
+ShaderCode cross_compile_stage(ShaderTarget target, int version, EShLanguage stage,
+                               const LLGL::VertexFormat& vertexFormat, const std::vector<uint32_t>& spirv,
+                               SpirvOptimization optimization) {
+    PROFILE_SCOPE("SPIRV-Cross");
+    const ShaderCompiler& compiler = ShaderCompiler::instance();
+    const bool strip = optimization != SpirvOptimization::None;
+    if (target == ShaderTarget::GLSL || target == ShaderTarget::ESSL) {
+        spirv_cross::CompilerGLSL glsl(spirv);
+        glsl.set_common_options(compiler.getGlslOptions(version, target == ShaderTarget::ESSL));
+        if (strip) {
+            ShaderCompiler::stripUnusedResources(glsl);
+        }
+        // Neither GLSL nor ESSL has separate samplers: merge them into their textures, keeping the bindings
+        if (stage == EShLangFragment) {
+            glsl.build_combined_image_samplers();
+            auto& samplers = glsl.get_combined_image_samplers();
+            for (const auto& sampler : samplers) {
+                glsl.set_name(sampler.combined_id, glsl.get_name(sampler.image_id));
+
+                if (glsl.has_decoration(sampler.image_id, spv::DecorationDescriptorSet)) {
+                    uint32_t set = glsl.get_decoration(sampler.image_id, spv::DecorationDescriptorSet);
+                    glsl.set_decoration(sampler.combined_id, spv::DecorationDescriptorSet, set);
+                }
+
+                if (glsl.has_decoration(sampler.image_id, spv::DecorationBinding)) {
+                    uint32_t binding = glsl.get_decoration(sampler.image_id, spv::DecorationBinding);
+                    glsl.set_decoration(sampler.combined_id, spv::DecorationBinding, binding);
+                }
             }
         }
-
-        spirv_cross::CompilerHLSL hlslVert(spirvSourceVert);
-        hlslVert.set_hlsl_options(hlslOptions);
-        for (unsigned int i = 0; i < vertexFormat.attributes.size(); i++) {
-            std::string semanticName = vertexFormat.attributes[i].name.c_str();
-            if (semanticName != "position") {
-                semanticName += std::to_string(vertexFormat.attributes[i].semanticIndex);
+        return glsl.compile();
+    } else if (target == ShaderTarget::SPIRV) {
+        return spirv;
+    } else if (target == ShaderTarget::HLSL) {
+        spirv_cross::CompilerHLSL hlsl(spirv);
+        hlsl.set_hlsl_options(compiler.getHlslOptions(version));
+        if (strip) {
+            ShaderCompiler::stripUnusedResources(hlsl);
+        }
+        if (stage == EShLangVertex) {
+            for (unsigned int i = 0; i < vertexFormat.attributes.size(); i++) {
+                std::string semanticName = vertexFormat.attributes[i].name.c_str();
+                if (semanticName != "position") {
+                    semanticName += std::to_string(vertexFormat.attributes[i].semanticIndex);
+                }
+                hlsl.add_vertex_attribute_remap({ i, semanticName });
             }
-            hlslVert.add_vertex_attribute_remap({ i, semanticName });
         }
-        vertShader = hlslVert.compile();
-        vertShaderDesc = { LLGL::ShaderType::Vertex, std::get<std::string>(vertShader).c_str() };
-        vertShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        vertShaderDesc.entryPoint = "main";
-        vertShaderDesc.profile = "vs_5_0";
-        printf("HLSL:\n%s\n", std::get<std::string>(vertShader).c_str());
-
-        spirv_cross::CompilerHLSL hlslFrag(spirvSourceFrag);
-        hlslFrag.set_hlsl_options(hlslOptions);
-        fragShader = hlslFrag.compile();
-        fragShaderDesc = { LLGL::ShaderType::Fragment, std::get<std::string>(fragShader).c_str() };
-        fragShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        fragShaderDesc.entryPoint = "main";
-        fragShaderDesc.profile = "ps_5_0";
-        printf("HLSL:\n%s\n", std::get<std::string>(fragShader).c_str());
-    } else if (is_metal(languages, version)) {
-        spirv_cross::CompilerMSL::Options options;
-        options.enable_decoration_binding = true;
-        spirv_cross::CompilerMSL mslVert(spirvSourceVert);
-        mslVert.set_msl_options(options);
-        vertShader = mslVert.compile();
-        vertShaderDesc = { LLGL::ShaderType::Vertex, std::get<std::string>(vertShader).c_str() };
-        vertShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        // vertShaderDesc.flags |= LLGL::ShaderCompileFlags::DefaultLibrary;
-        vertShaderDesc.entryPoint = "main0";
-        vertShaderDesc.profile = "2.1";
-        printf("MSL:\n%s\n", std::get<std::string>(vertShader).c_str());
-
-        spirv_cross::CompilerMSL mslFrag(spirvSourceFrag);
-        mslFrag.set_msl_options(options);
-        fragShader = mslFrag.compile();
-        fragShaderDesc = { LLGL::ShaderType::Fragment, std::get<std::string>(fragShader).c_str() };
-        fragShaderDesc.sourceType = LLGL::ShaderSourceType::CodeString;
-        // fragShaderDesc.flags |= LLGL::ShaderCompileFlags::DefaultLibrary;
-        fragShaderDesc.entryPoint = "main0";
-        fragShaderDesc.profile = "2.1";
-        printf("MSL:\n%s\n", std::get<std::string>(fragShader).c_str());
-    } else {
-        printf("Unsupported shader language\n");
+        return hlsl.compile();
+    }
+    spirv_cross::CompilerMSL msl(spirv);
+    msl.set_msl_options(compiler.getMslOptions());
+    if (strip) {
+        ShaderCompiler::stripUnusedResources(msl);
+    }
+    return msl.compile();
+}
+
+// Stage jobs only: they never wait on other jobs, so callers on any thread (including the pipeline
+// registry workers) can block on them without deadlocking the pool
+ThreadPool& translation_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Runs second() on the translation pool while first() runs on the calling thread. Both are finished
+// before anything is returned or rethrown, since the jobs usually reference the caller's locals.
+template <typename First, typename Second> auto run_pair(First first, Second second) {
+    auto future = translation_pool().submit(std::move(second));
+    std::invoke_result_t<First> firstResult;
+    try {
+        firstResult = first();
+    } catch (...) {
+        future.wait();
+        throw;
+    }
+    return std::make_pair(std::move(firstResult), future.get());
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// glslang to SPIR-V, then SPIRV-Cross to the target, with the vertex and fragment stage in parallel
+void translate(ShaderTarget target, int version, const LLGL::VertexFormat& vertexFormat,
+               const std::string& vertShaderSource, const std::string& fragShaderSource, ShaderCode& vertShader,
+               ShaderCode& fragShader) {
+    const ShaderCompiler& compiler = ShaderCompiler::instance();
+    const SpirvOptimization vertOptimization = stage_optimization(vertShaderSource);
+    const SpirvOptimization fragOptimization = stage_optimization(fragShaderSource);
+    auto spirv = run_pair(
+        [&]() { return compiler.compileToSpirv(EShLangVertex, vertShaderSource, "", vertOptimization); },
+        [&]() { return compiler.compileToSpirv(EShLangFragment, fragShaderSource, "", fragOptimization); });
+    // Reflection is defined on unoptimized SPIR-V, optimized stages are reflected on demand instead
+    if (vertOptimization == SpirvOptimization::None && fragOptimization == SpirvOptimization::None) {
+        capture_shader_reflection(vertShaderSource, fragShaderSource, spirv.first, spirv.second);
+    }
+    if (target == ShaderTarget::SPIRV) {
+        vertShader = std::move(spirv.first);
+        fragShader = std::move(spirv.second);
+        return;
+    }
+
+    auto code = run_pair(
+        [&]() {
+            return cross_compile_stage(target, version, EShLangVertex, vertexFormat, spirv.first, vertOptimization);
+        },
+        [&]() {
+            return cross_compile_stage(target, version, EShLangFragment, vertexFormat, spirv.second,
+                                       fragOptimization);
+        });
+    vertShader = std::move(code.first);
+    fragShader = std::move(code.second);
+}
+
+} // anonymous namespace
+
+void generate_shader_from_string(LLGL::ShaderDescriptor& vertShaderDesc, LLGL::ShaderDescriptor& fragShaderDesc,
+                                 const std::vector<LLGL::ShadingLanguage>& languages, LLGL::VertexFormat& vertexFormat,
+                                 std::string vertShaderSource, std::string fragShaderSource,
+                                 std::variant<std::string, std::vector<uint32_t>>& vertShader,
+                                 std::variant<std::string, std::vector<uint32_t>>& fragShader) {
+    PROFILE_SCOPE("generate_shader_from_string");
+    ShaderTarget target = ShaderTarget::GLSL;
+    int version = 0;
+    if (!select_shader_target(languages, target, version)) {
+        log_error(LogCategory::Shader, "Unsupported shader language\n");
         exit(1);
     }
+    if (target == ShaderTarget::HLSL) {
+        remap_hlsl_attributes(vertexFormat);
+    }
+
+    // Embedded or cached translations skip glslang and SPIRV-Cross entirely
+    const uint64_t key = translation_key(vertShaderSource, fragShaderSource, target, version, vertexFormat);
+    if (!read_embedded_shaders(key, static_cast<uint32_t>(target), vertShader, fragShader) &&
+        !read_cached_shaders(key, static_cast<uint32_t>(target), vertShader, fragShader)) {
+        const auto start = std::chrono::steady_clock::now();
+        translate(target, version, vertexFormat, vertShaderSource, fragShaderSource, vertShader, fragShader);
+        write_cached_shaders(key, static_cast<uint32_t>(target), vertShader, fragShader, elapsed_ms(start));
+    }
+    describe_shaders(target, vertShaderDesc, fragShaderDesc, vertShader, fragShader);
+    if (dump_enabled(LogCategory::Shader)) {
+        dump_shader_code(target, key, "vert", vertShader);
+        dump_shader_code(target, key, "frag", fragShader);
+    }
 }
 
-void generate_shader(LLGL::ShaderDescriptor& vertShaderDesc, LLGL::ShaderDescriptor& fragShaderDesc,
-                     const std::vector<LLGL::ShadingLanguage>& languages, LLGL::VertexFormat& vertexFormat,
-                     std::string name_shader, std::variant<std::string, std::vector<uint32_t>>& vertShader,
-                     std::variant<std::string, std::vector<uint32_t>>& fragShader) {
+namespace {
+
+std::filesystem::path& shader_directory() {
 #ifdef WIN32
-    std::filesystem::path shaderPath = "../../shader";
+    static std::filesystem::path path = "../../shader";
 #else
-    std::filesystem::path shaderPath = "../shader";
+    static std::filesystem::path path = "../shader";
 #endif
-    std::filesystem::path vertShaderPath = shaderPath / (name_shader + ".vert");
-    std::filesystem::path fragShaderPath = shaderPath / (name_shader + ".frag");
+    return path;
+}
 
-    std::string vertShaderSource;
-    std::string fragShaderSource;
-    std::ifstream shaderVertFile(vertShaderPath);
-    if (!shaderVertFile.is_open()) {
-        LLGL::Log::Printf("Failed to open shader file");
-        throw std::runtime_error("Failed to open shader file");
+bool read_text_file(const std::filesystem::path& path, std::string& text) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
     }
-    vertShaderSource = std::string((std::istreambuf_iterator<char>(shaderVertFile)), std::istreambuf_iterator<char>());
-    std::ifstream shaderFragFile(fragShaderPath);
-    if (!shaderFragFile.is_open()) {
-        LLGL::Log::Printf("Failed to open shader file");
+    text = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Returns the file name of an #include "file" line, or an empty string for any other line
+std::string parse_include_line(const std::string& line) {
+    const size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+        return {};
+    }
+    const size_t open = line.find('"', start + 8);
+    const size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+    if (close == std::string::npos) {
+        throw std::runtime_error("Malformed shader include: " + line);
+    }
+    return line.substr(open + 1, close - open - 1);
+}
+
+// Replaces every #include "file" line with the file's contents, resolved relative to the including file
+// (file is relative to the shader directory). Every file is included once per source, like #pragma once,
+// which also breaks include cycles. included receives the files read.
+std::string expand_includes(const std::string& source, const std::filesystem::path& file,
+                            std::vector<std::string>& included) {
+    std::istringstream lines(source);
+    std::string expanded;
+    std::string line;
+    while (std::getline(lines, line)) {
+        const std::string includeName = parse_include_line(line);
+        if (includeName.empty()) {
+            expanded += line + "\n";
+            continue;
+        }
+        const std::filesystem::path includePath = (file.parent_path() / includeName).lexically_normal();
+        const std::string includeKey = includePath.generic_string();
+        if (std::find(included.begin(), included.end(), includeKey) != included.end()) {
+            continue;
+        }
+        included.push_back(includeKey);
+
+        std::string includeSource;
+        if (!read_text_file(shader_directory() / includePath, includeSource)) {
+            log_error(LogCategory::Shader, "%s: failed to open include \"%s\"\n", file.generic_string().c_str(),
+                      includeName.c_str());
+            throw std::runtime_error("Failed to open shader include: " + includeKey);
+        }
+        expanded += expand_includes(includeSource, includePath, included);
+    }
+    return expanded;
+}
+
+} // anonymous namespace
+
+std::string apply_shader_defines(const std::string& source, const std::vector<std::string>& defines) {
+    if (defines.empty()) {
+        return source;
+    }
+    std::string block;
+    for (const auto& define : defines) {
+        block += "#define " + define + " 1\n";
+    }
+    // GLSL requires #version to come first
+    const size_t version = source.find("#version");
+    const size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    if (lineEnd == std::string::npos) {
+        return block + source;
+    }
+    return source.substr(0, lineEnd + 1) + block + source.substr(lineEnd + 1);
+}
+
+void set_spirv_optimization(SpirvOptimization level) {
+    default_optimization() = level;
+}
+
+SpirvOptimization spirv_optimization() {
+    return default_optimization().load();
+}
+
+void set_shader_directory(const std::string& path) {
+    shader_directory() = path;
+}
+
+std::string get_shader_directory() {
+    return shader_directory().string();
+}
+
+void load_shader_sources(const std::string& name_shader, std::string& vertShaderSource,
+                         std::string& fragShaderSource, std::vector<std::string>* dependencies) {
+    const std::filesystem::path vertFile = name_shader + ".vert";
+    const std::filesystem::path fragFile = name_shader + ".frag";
+
+    // Files on disk win, so shaders can be edited without rebuilding; the embedded copy (includes already
+    // expanded) covers deployments started from another working directory
+    if (dependencies) {
+        dependencies->clear();
+    }
+    std::string vertText, fragText;
+    const bool vertRead = read_text_file(shader_directory() / vertFile, vertText);
+    const bool fragRead = read_text_file(shader_directory() / fragFile, fragText);
+    if ((!vertRead || !fragRead) && read_embedded_shader_sources(name_shader, vertShaderSource, fragShaderSource)) {
+        return;
+    }
+    if (!vertRead || !fragRead) {
+        log_error(LogCategory::Shader, "Failed to open shader file\n");
         throw std::runtime_error("Failed to open shader file");
     }
-    fragShaderSource = std::string((std::istreambuf_iterator<char>(shaderFragFile)), std::istreambuf_iterator<char>());
+
+    // Expanded here rather than by a glslang includer, so the translation key and the shader cache hash the
+    // complete text and an edited include changes the key of every shader using it
+    std::vector<std::string> vertIncludes, fragIncludes;
+    vertShaderSource = expand_includes(vertText, vertFile, vertIncludes);
+    fragShaderSource = expand_includes(fragText, fragFile, fragIncludes);
+    if (dependencies) {
+        dependencies->push_back(vertFile.generic_string());
+        dependencies->push_back(fragFile.generic_string());
+        for (const auto& include : vertIncludes) {
+            dependencies->push_back(include);
+        }
+        for (const auto& include : fragIncludes) {
+            if (std::find(vertIncludes.begin(), vertIncludes.end(), include) == vertIncludes.end()) {
+                dependencies->push_back(include);
+            }
+        }
+    }
+}
+
+void generate_shader(LLGL::ShaderDescriptor& vertShaderDesc, LLGL::ShaderDescriptor& fragShaderDesc,
+                     const std::vector<LLGL::ShadingLanguage>& languages, LLGL::VertexFormat& vertexFormat,
+                     std::string name_shader, std::variant<std::string, std::vector<uint32_t>>& vertShader,
+                     std::variant<std::string, std::vector<uint32_t>>& fragShader) {
+    PROFILE_SCOPE("generate_shader");
+    std::string vertShaderSource;
+    std::string fragShaderSource;
+    load_shader_sources(name_shader, vertShaderSource, fragShaderSource);
 
     generate_shader_from_string(vertShaderDesc, fragShaderDesc, languages, vertexFormat, vertShaderSource,
                                 fragShaderSource, vertShader, fragShader);
-}
\ No newline at end of file
+}
+
+std::shared_ptr<TranslatedShaders> translate_shaders(const std::vector<LLGL::ShadingLanguage>& languages,
+                                                     const LLGL::VertexFormat& vertexFormat,
+                                                     std::string vertShaderSource, std::string fragShaderSource) {
+    auto shaders = std::make_shared<TranslatedShaders>();
+    shaders->vertexFormat = vertexFormat;
+    generate_shader_from_string(shaders->vertShaderDesc, shaders->fragShaderDesc, languages, shaders->vertexFormat,
+                                std::move(vertShaderSource), std::move(fragShaderSource), shaders->vertShader,
+                                shaders->fragShader);
+    shaders->vertShaderDesc.vertex.inputAttribs = shaders->vertexFormat.attributes;
+    return shaders;
+}
+
+std::vector<std::string> list_shader_names() {
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(shader_directory(), ec)) {
+        std::filesystem::path path = entry.path();
+        if (path.extension() == ".vert" && std::filesystem::exists(path.replace_extension(".frag"))) {
+            names.push_back(path.stem().string());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+const std::vector<ShaderTargetDesc>& shipped_shader_targets() {
+    static const std::vector<ShaderTargetDesc> targets = {
+        { "glsl450", { LLGL::ShadingLanguage::GLSL, LLGL::ShadingLanguage::GLSL_450 } },
+        { "essl300", { LLGL::ShadingLanguage::ESSL, LLGL::ShadingLanguage::ESSL_300 } },
+        { "hlsl50", { LLGL::ShadingLanguage::HLSL, LLGL::ShadingLanguage::HLSL_5_0 } },
+        { "msl20", { LLGL::ShadingLanguage::Metal, LLGL::ShadingLanguage::Metal_2_0 } },
+        { "spirv100", { LLGL::ShadingLanguage::SPIRV, LLGL::ShadingLanguage::SPIRV_100 } },
+    };
+    return targets;
+}
+
+ShaderTranslationReport translate_shader_targets(const std::vector<ShaderTargetDesc>& targets,
+                                                 const LLGL::VertexFormat& vertexFormat,
+                                                 const std::string& vertShaderSource,
+                                                 const std::string& fragShaderSource) {
+    PROFILE_SCOPE("translate_shader_targets");
+    const auto start = std::chrono::steady_clock::now();
+    ShaderTranslationReport report;
+    report.results.resize(targets.size());
+    report.vertOptimization = stage_optimization(vertShaderSource);
+    report.fragOptimization = stage_optimization(fragShaderSource);
+
+    // Resolve every target and try the cache first
+    struct PendingTarget {
+        size_t index;
+        ShaderTarget target;
+        int version;
+        LLGL::VertexFormat vertexFormat;
+        uint64_t key;
+    };
+    std::vector<PendingTarget> pending;
+    for (size_t i = 0; i < targets.size(); i++) {
+        ShaderTargetResult& result = report.results[i];
+        result.name = targets[i].name;
+
+        PendingTarget job{ i, ShaderTarget::GLSL, 0, vertexFormat, 0 };
+        if (!select_shader_target(targets[i].languages, job.target, job.version)) {
+            result.error = "unsupported shader language";
+            continue;
+        }
+        if (job.target == ShaderTarget::HLSL) {
+            remap_hlsl_attributes(job.vertexFormat);
+        }
+        job.key = translation_key(vertShaderSource, fragShaderSource, job.target, job.version, job.vertexFormat);
+        result.key = job.key;
+        result.target = static_cast<uint32_t>(job.target);
+        result.cached = read_embedded_shaders(job.key, result.target, result.vertShader, result.fragShader) ||
+                        read_cached_shaders(job.key, result.target, result.vertShader, result.fragShader);
+        if (!result.cached) {
+            pending.push_back(std::move(job));
+        }
+    }
+
+    if (!pending.empty()) {
+        // The SPIR-V doesn't depend on the target, so each stage is compiled once for all of them
+        const ShaderCompiler& compiler = ShaderCompiler::instance();
+        const auto spirvStart = std::chrono::steady_clock::now();
+        std::pair<std::vector<uint32_t>, std::vector<uint32_t>> spirv;
+        try {
+            spirv = run_pair(
+                [&]() {
+                    return compiler.compileToSpirv(EShLangVertex, vertShaderSource, "", report.vertOptimization,
+                                                   &report.vertSpirv);
+                },
+                [&]() {
+                    return compiler.compileToSpirv(EShLangFragment, fragShaderSource, "", report.fragOptimization,
+                                                   &report.fragSpirv);
+                });
+        } catch (const std::exception& e) {
+            for (const auto& job : pending) {
+                report.results[job.index].error = e.what();
+            }
+            pending.clear();
+        }
+        report.spirvMs = elapsed_ms(spirvStart);
+        if (!pending.empty() && report.vertOptimization == SpirvOptimization::None &&
+            report.fragOptimization == SpirvOptimization::None) {
+            capture_shader_reflection(vertShaderSource, fragShaderSource, spirv.first, spirv.second);
+        }
+
+        // Two jobs per target, each timing itself
+        using StageResult = std::pair<ShaderCode, double>;
+        std::vector<std::future<StageResult>> futures;
+        for (const auto& job : pending) {
+            for (EShLanguage stage : { EShLangVertex, EShLangFragment }) {
+                futures.push_back(translation_pool().submit([&spirv, &report, &job, stage]() {
+                    const auto stageStart = std::chrono::steady_clock::now();
+                    const bool vertex = stage == EShLangVertex;
+                    ShaderCode code =
+                        cross_compile_stage(job.target, job.version, stage, job.vertexFormat,
+                                            vertex ? spirv.first : spirv.second,
+                                            vertex ? report.vertOptimization : report.fragOptimization);
+                    return StageResult(std::move(code), elapsed_ms(stageStart));
+                }));
+            }
+        }
+
+        // The jobs reference locals, so all of them must finish before the first error is rethrown
+        for (auto& future : futures) {
+            future.wait();
+        }
+        for (size_t i = 0; i < pending.size(); i++) {
+            const PendingTarget& job = pending[i];
+            ShaderTargetResult& result = report.results[job.index];
+            try {
+                StageResult vert = futures[i * 2].get();
+                StageResult frag = futures[i * 2 + 1].get();
+                result.vertShader = std::move(vert.first);
+                result.fragShader = std::move(frag.first);
+                result.translationMs = vert.second + frag.second;
+                write_cached_shaders(job.key, static_cast<uint32_t>(job.target), result.vertShader, result.fragShader,
+                                     report.spirvMs + result.translationMs);
+            } catch (const std::exception& e) {
+                result.error = e.what();
+            }
+        }
+    }
+
+    for (auto& result : report.results) {
+        if (result.error.empty()) {
+            auto hashCode = [](const ShaderCode& code, uint64_t hash) {
+                if (const auto* words = std::get_if<std::vector<uint32_t>>(&code)) {
+                    return hash_bytes(words->data(), words->size() * sizeof(uint32_t), hash);
+                }
+                return hash_string(std::get<std::string>(code), hash);
+            };
+            result.outputHash = hashCode(result.fragShader, hashCode(result.vertShader, HASH_SEED));
+        }
+    }
+    report.totalMs = elapsed_ms(start);
+    return report;
+}
@@ -3,12 +3,35 @@
 
 #include <LLGL/LLGL.h>
 #include <LLGL/Utils/VertexFormat.h>
+#include <memory>
 #include <variant>
 #include <vector>
 #include <string>
 
+#include "shader_cache.h"
+#include "shader_compiler.h"
+
 void glslang_spirv_cross_test();
 
+// SPIR-V optimization of every stage without a "spirv-opt: <none|size|performance>" comment. Defaults to the
+// TEST_LLGL_SPIRV_OPTIMIZATION build setting; part of the translation key, so changing it never hits stale code.
+void set_spirv_optimization(SpirvOptimization level);
+SpirvOptimization spirv_optimization();
+
+// Inserts "#define <name> 1" for every define after the #version line (shader permutations)
+std::string apply_shader_defines(const std::string& source, const std::vector<std::string>& defines);
+
+// Directory of the shader/ pairs, relative to the working directory by default (../shader)
+void set_shader_directory(const std::string& path);
+std::string get_shader_directory();
+
+// Reads shader/<name>.vert and shader/<name>.frag, or their embedded copy when the files are missing.
+// #include "file" lines are replaced by the file, relative to the including one; each file is included once.
+// dependencies receives the files read, relative to the shader directory (empty for embedded copies).
+// Throws when neither exists or an include is missing.
+void load_shader_sources(const std::string& name_shader, std::string& vertShaderSource,
+                         std::string& fragShaderSource, std::vector<std::string>* dependencies = nullptr);
+
 void generate_shader(LLGL::ShaderDescriptor& vertShaderDesc, LLGL::ShaderDescriptor& fragShaderDesc,
                      const std::vector<LLGL::ShadingLanguage>& languages, LLGL::VertexFormat& vertexFormat,
                      std::string name_shader, std::variant<std::string, std::vector<uint32_t>>& vertShader,
@@ -20,4 +43,66 @@ void generate_shader_from_string(LLGL::ShaderDescriptor& vertShaderDesc, LLGL::S
                                  std::variant<std::string, std::vector<uint32_t>>& vertShader,
                                  std::variant<std::string, std::vector<uint32_t>>& fragShader);
 
+// Backend shaders of one vertex/fragment pair. The descriptors point into the translated sources, so the
+// object is shared by pointer and never copied.
+struct TranslatedShaders {
+    LLGL::ShaderDescriptor vertShaderDesc;
+    LLGL::ShaderDescriptor fragShaderDesc;
+    std::variant<std::string, std::vector<uint32_t>> vertShader;
+    std::variant<std::string, std::vector<uint32_t>> fragShader;
+    LLGL::VertexFormat vertexFormat; // Vertex shader inputs, renamed to TEXCOORD<n> semantics for HLSL
+
+    TranslatedShaders() = default;
+    TranslatedShaders(const TranslatedShaders&) = delete;
+    TranslatedShaders& operator=(const TranslatedShaders&) = delete;
+};
+
+// generate_shader_from_string into a self-contained object; may run on a worker thread
+std::shared_ptr<TranslatedShaders> translate_shaders(const std::vector<LLGL::ShadingLanguage>& languages,
+                                                     const LLGL::VertexFormat& vertexFormat,
+                                                     std::string vertShaderSource, std::string fragShaderSource);
+
+// Names of the vertex/fragment pairs in shader/ (files <name>.vert with a matching <name>.frag), sorted
+std::vector<std::string> list_shader_names();
+
+// One backend to translate for, e.g. { "hlsl50", { HLSL, HLSL_5_0 } }
+struct ShaderTargetDesc {
+    std::string name;
+    std::vector<LLGL::ShadingLanguage> languages;
+};
+
+// GLSL 4.50, ESSL 3.00, HLSL 5.0, MSL 2.0 and SPIR-V 1.0: the backends the viewer ships shaders for
+const std::vector<ShaderTargetDesc>& shipped_shader_targets();
+
+struct ShaderTargetResult {
+    std::string name;
+    ShaderCode vertShader;
+    ShaderCode fragShader;
+    double translationMs = 0.0; // SPIRV-Cross of both stages (serial sum), 0 for cache hits
+    bool cached = false;     // Embedded or from the shader cache
+    uint64_t key = 0;        // Shader cache key and target id of the translation
+    uint32_t target = 0;
+    uint64_t outputHash = 0; // Of both stages, to compare outputs between runs
+    std::string error;       // Empty on success
+};
+
+struct ShaderTranslationReport {
+    std::vector<ShaderTargetResult> results; // Same order as the requested targets
+    double spirvMs = 0.0;                    // glslang of both stages, shared by all targets
+    SpirvOptimization vertOptimization = SpirvOptimization::None;
+    SpirvOptimization fragOptimization = SpirvOptimization::None;
+    SpirvStats vertSpirv; // Empty when every target came from the cache
+    SpirvStats fragSpirv;
+    double totalMs = 0.0;                    // End to end, including cache lookups
+};
+
+// Translates one shader pair for every target at once: glslang runs once per stage, then SPIRV-Cross runs
+// for every stage and target on the translation pool. Reads and fills the shader cache like
+// generate_shader_from_string, so a later run for any of these backends starts warm. The output does not
+// depend on scheduling.
+ShaderTranslationReport translate_shader_targets(const std::vector<ShaderTargetDesc>& targets,
+                                                 const LLGL::VertexFormat& vertexFormat,
+                                                 const std::string& vertShaderSource,
+                                                 const std::string& fragShaderSource);
+
 #endif
\ No newline at end of file
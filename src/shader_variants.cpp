@@ -0,0 +1,49 @@
+#include "shader_variants.h"
+
+namespace {
+
+constexpr const char* MODEL_SHADER_DEFINES[MODEL_SHADER_FEATURE_COUNT] = {
+    "HAS_TEXTURE",
+};
+
+} // anonymous namespace
+
+uint32_t model_shader_features(const Mesh& mesh, const std::vector<Material>& materials) {
+    uint32_t features = 0;
+    if (mesh.materialIndex < materials.size()) {
+        const Material& material = materials[mesh.materialIndex];
+        if (material.hasTexture && material.diffuseTexture) {
+            features |= MODEL_SHADER_TEXTURE;
+        }
+    }
+    return features;
+}
+
+std::vector<std::string> model_shader_defines(uint32_t features) {
+    std::vector<std::string> defines;
+    for (uint32_t i = 0; i < MODEL_SHADER_FEATURE_COUNT; i++) {
+        if (features & (1u << i)) {
+            defines.push_back(MODEL_SHADER_DEFINES[i]);
+        }
+    }
+    return defines;
+}
+
+std::string shader_variant_name(const std::string& shaderName, const std::vector<std::string>& defines) {
+    std::string name = shaderName;
+    for (const auto& define : defines) {
+        name += "+" + define;
+    }
+    return name;
+}
+
+std::vector<std::vector<std::string>> shader_permutations(const std::string& shaderName) {
+    if (shaderName != "model") {
+        return { {} };
+    }
+    std::vector<std::vector<std::string>> permutations;
+    for (uint32_t features = 0; features < (1u << MODEL_SHADER_FEATURE_COUNT); features++) {
+        permutations.push_back(model_shader_defines(features));
+    }
+    return permutations;
+}
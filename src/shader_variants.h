@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model_loader.h"
+
+// Feature bits of the "model" shader permutations. Each bit maps to a #define of shader/model.vert/.frag;
+// a mesh's features select the permutation it is drawn with.
+enum ModelShaderFeature : uint32_t {
+    MODEL_SHADER_TEXTURE = 1u << 0, // HAS_TEXTURE: diffuse texture at bindings 1 and 2
+};
+constexpr uint32_t MODEL_SHADER_FEATURE_COUNT = 1;
+
+// Features needed to draw a mesh with its material
+uint32_t model_shader_features(const Mesh& mesh, const std::vector<Material>& materials);
+
+// #defines enabling the features, in feature bit order
+std::vector<std::string> model_shader_defines(uint32_t features);
+
+// Display name of a permutation, e.g. "model+HAS_TEXTURE"
+std::string shader_variant_name(const std::string& shaderName, const std::vector<std::string>& defines);
+
+// Every permutation of a shader (a single empty define list for shaders without features), for build-time
+// and ahead-of-time translation
+std::vector<std::vector<std::string>> shader_permutations(const std::string& shaderName);
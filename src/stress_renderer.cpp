@@ -0,0 +1,158 @@
+#include "stress_renderer.h"
+
+#include <algorithm>
+
+#include <LLGL/Utils/VertexFormat.h>
+
+#include "logger.h"
+#include "pipeline_registry.h"
+#include "profiler.h"
+#include "shader_reflection.h"
+
+bool parse_stress_submit_mode(const std::string& name, StressSubmitMode& mode) {
+    if (name == "draws") {
+        mode = StressSubmitMode::Draws;
+    } else if (name == "instanced") {
+        mode = StressSubmitMode::Instanced;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* stress_submit_mode_name(StressSubmitMode mode) {
+    return mode == StressSubmitMode::Draws ? "draws" : "instanced";
+}
+
+bool StressRenderer::init(LLGL::RenderSystemPtr& renderer, const LLGL::RenderPass* renderPass) {
+    const auto& caps = renderer->GetRenderingCaps();
+    if (!caps.features.hasInstancing || !caps.features.hasOffsetInstancing) {
+        log_error(LogCategory::Render,
+                  "Stress scene needs instancing with a first-instance offset, not supported by %s\n",
+                  renderer->GetRendererInfo().rendererName.c_str());
+        return false;
+    }
+
+    LLGL::BufferDescriptor uniformBufferDesc;
+    uniformBufferDesc.size = sizeof(Matrices);
+    uniformBufferDesc.bindFlags = LLGL::BindFlags::ConstantBuffer;
+    uniformBufferDesc.cpuAccessFlags = LLGL::CPUAccessFlags::Write;
+    uniformBufferDesc.miscFlags = LLGL::MiscFlags::DynamicUsage;
+    uniformBufferDesc.debugName = "StressMatricesBuffer";
+    uniformBuffer_ = renderer->CreateBuffer(uniformBufferDesc);
+
+    // Layout and upload range from the shader's reflection: the instances carry the model matrix, so only
+    // view and projection of the Matrices block are read
+    const std::shared_ptr<const ShaderReflection> reflection = reflect_shaders("stress");
+    log_shader_reflection("stress", *reflection);
+    pipelineLayout_ = acquire_pipeline_layout(renderer, make_pipeline_layout_desc(*reflection));
+    uploadOffset_ = 0;
+    uploadSize_ = 0;
+    if (const UniformBlockReflection* block = reflection->findUniformBlock("Matrices")) {
+        uploadOffset_ = block->usedOffset();
+        uploadSize_ = block->usedSize();
+    }
+
+    // Mesh vertices in slot 0, per-object instance data in slot 1
+    PipelineRequest request;
+    request.shaderName = "stress";
+    request.vertexFormat = createModelVertexFormat();
+    for (const auto& attribute : StressScene::createInstanceFormat().attributes) {
+        request.vertexFormat.attributes.push_back(attribute);
+    }
+    request.pipelineLayout = pipelineLayout_;
+    request.renderPass = renderPass;
+    request.depthMode = DepthMode::TestAndWrite;
+    request.cullMode = LLGL::CullMode::Back;
+    pipeline_ = acquire_pipeline(renderer, request);
+
+    LLGL::SamplerDescriptor samplerDesc;
+    samplerDesc.minFilter = LLGL::SamplerFilter::Nearest;
+    samplerDesc.magFilter = LLGL::SamplerFilter::Nearest;
+    samplerDesc.mipMapFilter = LLGL::SamplerFilter::Nearest;
+    sampler_ = renderer->CreateSampler(samplerDesc);
+
+    return true;
+}
+
+void StressRenderer::release(LLGL::RenderSystemPtr& renderer) {
+    release_pipeline(renderer, pipeline_);
+    pipeline_ = nullptr;
+    release_pipeline_layout(renderer, pipelineLayout_);
+    pipelineLayout_ = nullptr;
+    if (uniformBuffer_) {
+        renderer->Release(*uniformBuffer_);
+        uniformBuffer_ = nullptr;
+    }
+    if (sampler_) {
+        renderer->Release(*sampler_);
+        sampler_ = nullptr;
+    }
+}
+
+void StressRenderer::updateCamera(LLGL::RenderSystemPtr& renderer, const OrbitCamera& camera, float aspect,
+                                  const StressScene& scene) {
+    const float farPlane = std::max(1000.0f, camera.getDistance() + 2.0f * scene.getBounds().radius());
+
+    matrices_.view = camera.getViewMatrix();
+    matrices_.projection = Math::Mat4::perspective(3.14159f / 4.0f, aspect, 0.1f, farPlane);
+    if (uploadSize_ > 0) {
+        renderer->WriteBuffer(*uniformBuffer_, uploadOffset_, reinterpret_cast<const char*>(&matrices_) + uploadOffset_,
+                              uploadSize_);
+    }
+}
+
+DrawStats StressRenderer::render(LLGL::CommandBuffer& cmdBuffer, const StressScene& scene, StressSubmitMode mode,
+                                 const std::vector<uint32_t>* visibleObjects) {
+    PROFILE_SCOPE("StressRenderer::render");
+    DrawStats stats;
+
+    const auto& objects = scene.getObjects();
+    const auto& meshes = scene.getMeshes();
+    const uint32_t count = visibleObjects ? static_cast<uint32_t>(visibleObjects->size())
+                                          : static_cast<uint32_t>(objects.size());
+    auto objectAt = [visibleObjects](uint32_t i) { return visibleObjects ? (*visibleObjects)[i] : i; };
+
+    cmdBuffer.SetPipelineState(*pipeline_);
+    cmdBuffer.SetResource(0, *uniformBuffer_);
+    cmdBuffer.SetResource(2, *sampler_);
+    stats.pipelineBinds++;
+    stats.resourceBinds += 2;
+
+    uint32_t boundMesh = UINT32_MAX;
+    uint32_t boundMaterial = UINT32_MAX;
+
+    for (uint32_t i = 0; i < count;) {
+        const uint32_t objectIndex = objectAt(i);
+        const StressObject& object = objects[objectIndex];
+
+        if (object.meshIndex != boundMesh) {
+            boundMesh = object.meshIndex;
+            cmdBuffer.SetVertexBufferArray(*scene.getVertexBufferArray(boundMesh));
+            cmdBuffer.SetIndexBuffer(*meshes[boundMesh].indexBuffer);
+            stats.resourceBinds += 2;
+        }
+        if (object.materialIndex != boundMaterial) {
+            boundMaterial = object.materialIndex;
+            cmdBuffer.SetResource(1, *scene.getMaterialTexture(boundMaterial));
+            stats.resourceBinds++;
+        }
+
+        // Instanced mode extends the draw over the following objects with consecutive indices and the same state
+        uint32_t instanceCount = 1;
+        if (mode == StressSubmitMode::Instanced) {
+            while (i + instanceCount < count && objectAt(i + instanceCount) == objectIndex + instanceCount &&
+                   objects[objectIndex + instanceCount].meshIndex == object.meshIndex &&
+                   objects[objectIndex + instanceCount].materialIndex == object.materialIndex) {
+                instanceCount++;
+            }
+        }
+
+        const uint32_t indexCount = meshes[object.meshIndex].indexCount();
+        cmdBuffer.DrawIndexedInstanced(indexCount, instanceCount, 0, 0, objectIndex);
+        stats.drawCalls++;
+        stats.triangles += static_cast<uint64_t>(indexCount / 3) * instanceCount;
+        i += instanceCount;
+    }
+    return stats;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+#include "camera.h"
+#include "model_renderer.h"
+#include "stress_scene.h"
+
+enum class StressSubmitMode {
+    Draws,     // One draw per object (firstInstance = object index), measures per-draw submission cost
+    Instanced, // One instanced draw per run of objects sharing mesh and material
+};
+
+bool parse_stress_submit_mode(const std::string& name, StressSubmitMode& mode);
+const char* stress_submit_mode_name(StressSubmitMode mode);
+
+// Pipeline and draw recording for a StressScene
+class StressRenderer {
+  public:
+    // Returns false if the device can't draw with an instance offset
+    bool init(LLGL::RenderSystemPtr& renderer, const LLGL::RenderPass* renderPass);
+    void release(LLGL::RenderSystemPtr& renderer);
+
+    // View/projection for the camera, with the far plane pushed out to contain the whole scene
+    void updateCamera(LLGL::RenderSystemPtr& renderer, const OrbitCamera& camera, float aspect,
+                      const StressScene& scene);
+
+    // Projection * view from the last updateCamera call, for CPU culling
+    Math::Mat4 getViewProjection() const {
+        return matrices_.projection * matrices_.view;
+    }
+
+    // Records the objects listed in visibleObjects (ascending object indices), or all objects if null.
+    // Must be called inside a render pass.
+    DrawStats render(LLGL::CommandBuffer& cmdBuffer, const StressScene& scene, StressSubmitMode mode,
+                     const std::vector<uint32_t>* visibleObjects = nullptr);
+
+  private:
+    LLGL::Buffer* uniformBuffer_ = nullptr;
+    uint32_t uploadOffset_ = 0; // Byte range of Matrices read by the stress shader
+    uint32_t uploadSize_ = 0;
+    LLGL::PipelineLayout* pipelineLayout_ = nullptr;
+    LLGL::PipelineState* pipeline_ = nullptr;
+    LLGL::Sampler* sampler_ = nullptr;
+    Matrices matrices_;
+};
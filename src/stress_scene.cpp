@@ -0,0 +1,368 @@
+#include "stress_scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "primitives.h"
+#include "profiler.h"
+
+namespace {
+
+constexpr float GRID_SPACING = 2.5f;
+constexpr float CITY_SPACING = 3.0f;
+constexpr uint32_t MATERIAL_TEXTURE_SIZE = 4;
+
+// Small xorshift generator: unlike the <random> distributions it yields the same sequence on every standard library
+class Random {
+  public:
+    explicit Random(uint32_t seed)
+        : state_(0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(seed) * 0xBF58476D1CE4E5B9ull)) {
+        next();
+    }
+
+    uint32_t next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 7;
+        state_ ^= state_ << 17;
+        return static_cast<uint32_t>(state_ >> 32);
+    }
+    float uniform(float lo, float hi) {
+        return lo + (hi - lo) * (static_cast<float>(next() >> 8) / static_cast<float>(1u << 24));
+    }
+    uint32_t below(uint32_t bound) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 32);
+    }
+
+  private:
+    uint64_t state_;
+};
+
+Mesh createVarietyMesh(uint32_t index) {
+    // Every full cycle through the four generators doubles the tessellation
+    const int segments = 8 << std::min(index / 4, 6u);
+    switch (index % 4) {
+        case 0:
+            return Primitives::createCube(1.0f);
+        case 1:
+            return Primitives::createSphere(0.5f, segments, std::max(segments / 2, 4));
+        case 2:
+            return Primitives::createCylinder(0.5f, 1.0f, segments);
+        default:
+            return Primitives::createCone(0.5f, 1.0f, segments);
+    }
+}
+
+// Box inside the mesh generated by createVarietyMesh, used as its occluder LOD. The corners of the round
+// shapes are pulled in to 80% of the radius, inside the faces of the coarsest tessellation (8 segments).
+Math::AABB createOccluderBox(uint32_t index) {
+    constexpr float margin = 0.8f;
+    Math::AABB box;
+    switch (index % 4) {
+        case 0: // Unit cube
+            box.minPoint = Math::Vec3(-0.5f);
+            box.maxPoint = Math::Vec3(0.5f);
+            break;
+        case 1: { // Sphere of radius 0.5: inscribed cube
+            const float half = margin * 0.5f / std::sqrt(3.0f);
+            box.minPoint = Math::Vec3(-half);
+            box.maxPoint = Math::Vec3(half);
+            break;
+        }
+        case 2: { // Cylinder of radius 0.5: inscribed square prism
+            const float half = margin * 0.5f / std::sqrt(2.0f);
+            box.minPoint = { -half, -0.5f, -half };
+            box.maxPoint = { half, 0.5f, half };
+            break;
+        }
+        default: { // Cone with base radius 0.5 at y = -0.5: the largest inscribed prism is a third of the height
+            const float half = margin * 0.5f * (2.0f / 3.0f) / std::sqrt(2.0f);
+            box.minPoint = { -half, -0.5f, -half };
+            box.maxPoint = { half, -0.5f + 1.0f / 3.0f, half };
+            break;
+        }
+    }
+    return box;
+}
+
+Math::AABB computeMeshBounds(const Mesh& mesh) {
+    Math::AABB bounds;
+    for (const auto& vertex : mesh.vertices) {
+        bounds.expand(vertex.position);
+    }
+    return bounds;
+}
+
+// Bounds of a transformed box (center/extent form, exact for affine transforms)
+Math::AABB transformBounds(const Math::AABB& local, const Math::Mat4& matrix) {
+    const Math::Vec3 center = local.center();
+    const Math::Vec3 extent = local.size() * 0.5f;
+
+    Math::Vec3 worldCenter, worldExtent;
+    for (int row = 0; row < 3; row++) {
+        worldCenter[row] = matrix(row, 0) * center.x + matrix(row, 1) * center.y + matrix(row, 2) * center.z +
+                           matrix(row, 3);
+        worldExtent[row] = std::abs(matrix(row, 0)) * extent.x + std::abs(matrix(row, 1)) * extent.y +
+                           std::abs(matrix(row, 2)) * extent.z;
+    }
+
+    Math::AABB bounds;
+    bounds.minPoint = worldCenter - worldExtent;
+    bounds.maxPoint = worldCenter + worldExtent;
+    return bounds;
+}
+
+Math::Vec3 materialColor(uint32_t materialIndex, uint32_t materialCount) {
+    // Hues spread evenly around the color wheel
+    const float hue = 6.0f * static_cast<float>(materialIndex) / static_cast<float>(std::max(materialCount, 1u));
+    const float x = 1.0f - std::abs(std::fmod(hue, 2.0f) - 1.0f);
+    switch (static_cast<int>(hue)) {
+        case 0:
+            return { 1.0f, x, 0.0f };
+        case 1:
+            return { x, 1.0f, 0.0f };
+        case 2:
+            return { 0.0f, 1.0f, x };
+        case 3:
+            return { 0.0f, x, 1.0f };
+        case 4:
+            return { x, 0.0f, 1.0f };
+        default:
+            return { 1.0f, 0.0f, x };
+    }
+}
+
+LLGL::Texture* createMaterialTexture(LLGL::RenderSystemPtr& renderer, const Math::Vec3& color) {
+    uint8_t pixels[MATERIAL_TEXTURE_SIZE * MATERIAL_TEXTURE_SIZE * 4];
+    for (uint32_t y = 0; y < MATERIAL_TEXTURE_SIZE; y++) {
+        for (uint32_t x = 0; x < MATERIAL_TEXTURE_SIZE; x++) {
+            const float shade = ((x + y) % 2 == 0) ? 1.0f : 0.75f;
+            uint8_t* pixel = &pixels[(y * MATERIAL_TEXTURE_SIZE + x) * 4];
+            pixel[0] = static_cast<uint8_t>(255.0f * color.x * shade);
+            pixel[1] = static_cast<uint8_t>(255.0f * color.y * shade);
+            pixel[2] = static_cast<uint8_t>(255.0f * color.z * shade);
+            pixel[3] = 255;
+        }
+    }
+
+    LLGL::ImageView imageView(LLGL::ImageFormat::RGBA, LLGL::DataType::UInt8, pixels, sizeof(pixels));
+    LLGL::TextureDescriptor texDesc;
+    texDesc.type = LLGL::TextureType::Texture2D;
+    texDesc.format = LLGL::Format::RGBA8UNorm;
+    texDesc.extent = { MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, 1 };
+    texDesc.mipLevels = 1;
+    texDesc.debugName = "StressMaterialTexture";
+    return renderer->CreateTexture(texDesc, &imageView);
+}
+
+} // anonymous namespace
+
+bool parse_stress_layout(const std::string& name, StressLayout& layout) {
+    if (name == "grid") {
+        layout = StressLayout::Grid;
+    } else if (name == "random") {
+        layout = StressLayout::Random;
+    } else if (name == "city") {
+        layout = StressLayout::City;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* stress_layout_name(StressLayout layout) {
+    switch (layout) {
+        case StressLayout::Grid:
+            return "grid";
+        case StressLayout::Random:
+            return "random";
+        case StressLayout::City:
+            return "city";
+    }
+    return "unknown";
+}
+
+void StressScene::generate(const StressSceneDesc& desc) {
+    PROFILE_SCOPE("StressScene::generate");
+    desc_ = desc;
+    desc_.meshVariety = std::max(desc_.meshVariety, 1u);
+    desc_.materialCount = std::max(desc_.materialCount, 1u);
+
+    meshes_.clear();
+    meshBounds_.clear();
+    occluderBoxes_.clear();
+    for (uint32_t i = 0; i < desc_.meshVariety; i++) {
+        meshes_.push_back(createVarietyMesh(i));
+        meshBounds_.push_back(computeMeshBounds(meshes_.back()));
+        occluderBoxes_.push_back(createOccluderBox(i));
+    }
+
+    Random random(desc_.seed);
+    const uint32_t count = desc_.objectCount;
+    const uint32_t side3D = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+    const uint32_t side2D = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+
+    std::vector<StressObject> objects(count);
+    std::vector<StressInstance> instances(count);
+    for (uint32_t i = 0; i < count; i++) {
+        StressObject& object = objects[i];
+        object.meshIndex = random.below(desc_.meshVariety);
+        object.materialIndex = random.below(desc_.materialCount);
+
+        Math::Mat4 model;
+        switch (desc_.layout) {
+            case StressLayout::Grid: {
+                const float x = static_cast<float>(i % side3D);
+                const float y = static_cast<float>((i / side3D) % side3D);
+                const float z = static_cast<float>(i / (side3D * side3D));
+                model = Math::Mat4::translate(Math::Vec3(x, y, z) * GRID_SPACING) *
+                        Math::Mat4::rotateY(random.uniform(0.0f, 2.0f * Math::PI));
+                break;
+            }
+            case StressLayout::Random: {
+                const float extent = static_cast<float>(side3D) * GRID_SPACING;
+                const Math::Vec3 position(random.uniform(0.0f, extent), random.uniform(0.0f, extent),
+                                          random.uniform(0.0f, extent));
+                model = Math::Mat4::translate(position) * Math::Mat4::rotateY(random.uniform(0.0f, 2.0f * Math::PI)) *
+                        Math::Mat4::rotateX(random.uniform(0.0f, 2.0f * Math::PI)) *
+                        Math::Mat4::scale(Math::Vec3(random.uniform(0.5f, 1.5f)));
+                break;
+            }
+            case StressLayout::City: {
+                const float x = static_cast<float>(i % side2D);
+                const float z = static_cast<float>(i / side2D);
+                const Math::Vec3 size(random.uniform(1.0f, 2.5f), random.uniform(1.0f, 10.0f),
+                                      random.uniform(1.0f, 2.5f));
+                model = Math::Mat4::translate({ x * CITY_SPACING, size.y * 0.5f, z * CITY_SPACING }) *
+                        Math::Mat4::scale(size);
+                break;
+            }
+        }
+
+        object.bounds = transformBounds(meshBounds_[object.meshIndex], model);
+
+        const Math::Vec3 color = materialColor(object.materialIndex, desc_.materialCount);
+        const float tint = random.uniform(0.8f, 1.0f);
+        instances[i].model = model;
+        instances[i].color[0] = color.x * tint;
+        instances[i].color[1] = color.y * tint;
+        instances[i].color[2] = color.z * tint;
+        instances[i].color[3] = 1.0f;
+    }
+
+    // Sort by mesh, then material, so consecutive draws share as much state as possible
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&objects](uint32_t a, uint32_t b) {
+        if (objects[a].meshIndex != objects[b].meshIndex) {
+            return objects[a].meshIndex < objects[b].meshIndex;
+        }
+        return objects[a].materialIndex < objects[b].materialIndex;
+    });
+
+    objects_.resize(count);
+    instances_.resize(count);
+    bounds_ = Math::AABB();
+    for (uint32_t i = 0; i < count; i++) {
+        objects_[i] = objects[order[i]];
+        instances_[i] = instances[order[i]];
+        bounds_.expand(objects_[i].bounds.minPoint);
+        bounds_.expand(objects_[i].bounds.maxPoint);
+    }
+}
+
+void StressScene::createBuffers(LLGL::RenderSystemPtr& renderer) {
+    PROFILE_SCOPE("StressScene::createBuffers");
+    gpuMemoryBytes_ = 0;
+
+    LLGL::VertexFormat vertexFormat = createModelVertexFormat();
+    for (auto& mesh : meshes_) {
+        LLGL::BufferDescriptor vbDesc;
+        vbDesc.size = mesh.vertices.size() * sizeof(ModelVertex);
+        vbDesc.bindFlags = LLGL::BindFlags::VertexBuffer;
+        vbDesc.vertexAttribs = vertexFormat.attributes;
+        vbDesc.debugName = "StressVertexBuffer";
+        mesh.vertexBuffer = renderer->CreateBuffer(vbDesc, mesh.vertices.data());
+
+        LLGL::BufferDescriptor ibDesc;
+        ibDesc.size = mesh.indices.size() * sizeof(uint32_t);
+        ibDesc.bindFlags = LLGL::BindFlags::IndexBuffer;
+        ibDesc.format = LLGL::Format::R32UInt;
+        ibDesc.debugName = "StressIndexBuffer";
+        mesh.indexBuffer = renderer->CreateBuffer(ibDesc, mesh.indices.data());
+
+        gpuMemoryBytes_ += vbDesc.size + ibDesc.size;
+    }
+
+    LLGL::BufferDescriptor instanceDesc;
+    instanceDesc.size = std::max<size_t>(instances_.size(), 1) * sizeof(StressInstance);
+    instanceDesc.bindFlags = LLGL::BindFlags::VertexBuffer;
+    instanceDesc.vertexAttribs = createInstanceFormat().attributes;
+    instanceDesc.debugName = "StressInstanceBuffer";
+    instanceBuffer_ = renderer->CreateBuffer(instanceDesc, instances_.empty() ? nullptr : instances_.data());
+    gpuMemoryBytes_ += instanceDesc.size;
+
+    for (auto& mesh : meshes_) {
+        LLGL::Buffer* buffers[] = { mesh.vertexBuffer, instanceBuffer_ };
+        vertexBufferArrays_.push_back(renderer->CreateBufferArray(2, buffers));
+    }
+
+    for (uint32_t i = 0; i < desc_.materialCount; i++) {
+        materialTextures_.push_back(createMaterialTexture(renderer, materialColor(i, desc_.materialCount)));
+        gpuMemoryBytes_ += MATERIAL_TEXTURE_SIZE * MATERIAL_TEXTURE_SIZE * 4;
+    }
+}
+
+void StressScene::release(LLGL::RenderSystemPtr& renderer) {
+    for (auto* bufferArray : vertexBufferArrays_) {
+        renderer->Release(*bufferArray);
+    }
+    vertexBufferArrays_.clear();
+
+    for (auto& mesh : meshes_) {
+        if (mesh.vertexBuffer) {
+            renderer->Release(*mesh.vertexBuffer);
+            mesh.vertexBuffer = nullptr;
+        }
+        if (mesh.indexBuffer) {
+            renderer->Release(*mesh.indexBuffer);
+            mesh.indexBuffer = nullptr;
+        }
+    }
+    if (instanceBuffer_) {
+        renderer->Release(*instanceBuffer_);
+        instanceBuffer_ = nullptr;
+    }
+
+    for (auto* texture : materialTextures_) {
+        renderer->Release(*texture);
+    }
+    materialTextures_.clear();
+    gpuMemoryBytes_ = 0;
+}
+
+LLGL::VertexFormat StressScene::createInstanceFormat() {
+    // Model matrix columns and color, advanced once per instance
+    constexpr uint32_t stride = sizeof(StressInstance);
+    LLGL::VertexFormat format;
+    format.attributes = {
+        LLGL::VertexAttribute{ "instanceModel0", LLGL::Format::RGBA32Float, 3, 0, stride, 1, 1 },
+        LLGL::VertexAttribute{ "instanceModel1", LLGL::Format::RGBA32Float, 4, 16, stride, 1, 1 },
+        LLGL::VertexAttribute{ "instanceModel2", LLGL::Format::RGBA32Float, 5, 32, stride, 1, 1 },
+        LLGL::VertexAttribute{ "instanceModel3", LLGL::Format::RGBA32Float, 6, 48, stride, 1, 1 },
+        LLGL::VertexAttribute{ "instanceColor", LLGL::Format::RGBA32Float, 7, 64, stride, 1, 1 },
+    };
+    return format;
+}
+
+size_t StressScene::getCpuMemoryBytes() const {
+    size_t bytes = objects_.capacity() * sizeof(StressObject) + instances_.capacity() * sizeof(StressInstance);
+    for (const auto& mesh : meshes_) {
+        bytes += mesh.vertices.capacity() * sizeof(ModelVertex) + mesh.indices.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+size_t StressScene::getGpuMemoryBytes() const {
+    return gpuMemoryBytes_;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+#include <LLGL/Utils/VertexFormat.h>
+
+#include "math_types.h"
+#include "model_loader.h"
+
+enum class StressLayout {
+    Grid,   // Regular 3D lattice
+    Random, // Uniformly scattered inside a cube, random rotation and scale
+    City,   // Ground-plane grid of box-like "buildings" with random heights
+};
+
+bool parse_stress_layout(const std::string& name, StressLayout& layout);
+const char* stress_layout_name(StressLayout layout);
+
+struct StressSceneDesc {
+    uint32_t objectCount = 1000;
+    uint32_t meshVariety = 4;   // Distinct meshes, cycling through cube/sphere/cylinder/cone with rising tessellation
+    uint32_t materialCount = 8; // Distinct textures
+    StressLayout layout = StressLayout::Grid;
+    uint32_t seed = 1;
+};
+
+// Per-object data in the instance vertex stream (slot 1)
+struct StressInstance {
+    Math::Mat4 model;
+    float color[4];
+};
+
+struct StressObject {
+    uint32_t meshIndex = 0;
+    uint32_t materialIndex = 0;
+    Math::AABB bounds; // World space
+};
+
+// Reproducible scene of many primitive objects for submission-scaling tests.
+// Objects are sorted by mesh and material, and object i uses instance i of the instance buffer,
+// so each one can be drawn on its own with firstInstance = i.
+class StressScene {
+  public:
+    // CPU-only: meshes, objects and instance data. Same desc and seed give the same scene on every platform.
+    void generate(const StressSceneDesc& desc);
+    void createBuffers(LLGL::RenderSystemPtr& renderer);
+    void release(LLGL::RenderSystemPtr& renderer);
+
+    static LLGL::VertexFormat createInstanceFormat();
+
+    const StressSceneDesc& getDesc() const {
+        return desc_;
+    }
+    const std::vector<Mesh>& getMeshes() const {
+        return meshes_;
+    }
+    const std::vector<Math::AABB>& getMeshBounds() const {
+        return meshBounds_;
+    }
+    // Object-space box contained in each mesh, a conservative stand-in for occlusion culling
+    const std::vector<Math::AABB>& getOccluderBoxes() const {
+        return occluderBoxes_;
+    }
+    const std::vector<StressObject>& getObjects() const {
+        return objects_;
+    }
+    const std::vector<StressInstance>& getInstances() const {
+        return instances_;
+    }
+    const Math::AABB& getBounds() const {
+        return bounds_;
+    }
+
+    LLGL::BufferArray* getVertexBufferArray(uint32_t meshIndex) const {
+        return vertexBufferArrays_[meshIndex];
+    }
+    LLGL::Texture* getMaterialTexture(uint32_t materialIndex) const {
+        return materialTextures_[materialIndex];
+    }
+
+    size_t getCpuMemoryBytes() const;
+    size_t getGpuMemoryBytes() const;
+
+  private:
+    StressSceneDesc desc_;
+    std::vector<Mesh> meshes_;
+    std::vector<Math::AABB> meshBounds_; // Object space
+    std::vector<Math::AABB> occluderBoxes_;
+    std::vector<StressObject> objects_;
+    std::vector<StressInstance> instances_;
+    Math::AABB bounds_;
+
+    LLGL::Buffer* instanceBuffer_ = nullptr;
+    std::vector<LLGL::BufferArray*> vertexBufferArrays_;
+    std::vector<LLGL::Texture*> materialTextures_;
+    size_t gpuMemoryBytes_ = 0;
+};
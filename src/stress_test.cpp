@@ -0,0 +1,272 @@
+#include "stress_test.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+
+#include "headless.h"
+#include "json_writer.h"
+#include "logger.h"
+#include "occlusion_culler.h"
+#include "offscreen_target.h"
+#include "pipeline_cache.h"
+#include "profiler.h"
+#include "sample_stats.h"
+#include "shader_cache.h"
+
+extern LLGL::RenderSystemPtr llgl_renderer;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t DEFAULT_STRESS_FRAMES = 10;
+
+double millisecondsBetween(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct StressResult {
+    uint32_t objectCount = 0;
+    double generateMs = 0.0;
+    double uploadMs = 0.0;
+    double cpuBytesPerObject = 0.0;
+    double gpuBytesPerObject = 0.0;
+    DrawStats stats; // Last frame
+    CullStats cullStats; // Last frame
+    SampleSummary cullMs;
+    SampleSummary recordMs;
+    SampleSummary waitMs;
+    SampleSummary frameMs;
+    double nsPerDraw = 0.0; // Median record time divided by draws
+};
+
+} // anonymous namespace
+
+bool stress_options_to_desc(const AppOptions& options, uint32_t objectCount, StressSceneDesc& desc,
+                            StressSubmitMode& mode) {
+    if (!parse_stress_layout(options.stressLayout, desc.layout)) {
+        log_error(LogCategory::App, "Unknown stress layout: %s\n", options.stressLayout.c_str());
+        return false;
+    }
+    if (!parse_stress_submit_mode(options.stressSubmit, mode)) {
+        log_error(LogCategory::App, "Unknown stress submit mode: %s\n", options.stressSubmit.c_str());
+        return false;
+    }
+    desc.objectCount = objectCount;
+    desc.meshVariety = options.stressVariety;
+    desc.materialCount = options.stressMaterials;
+    desc.seed = options.stressSeed;
+    return true;
+}
+
+void frame_stress_scene(OrbitCamera& camera, const StressScene& scene) {
+    camera.setTarget(scene.getBounds().center(), scene.getBounds().radius() * 1.2f);
+    camera.setYaw(0.6f);
+    camera.setPitch(0.5f);
+}
+
+int run_stress(const AppOptions& options) {
+    StressSceneDesc desc;
+    StressSubmitMode mode = StressSubmitMode::Draws;
+    if (!stress_options_to_desc(options, 0, desc, mode)) {
+        return 1;
+    }
+
+    llgl_renderer = load_headless_renderer(options.rendererModule);
+    if (!llgl_renderer) {
+        return 1;
+    }
+    if (options.pipelineCache) {
+        load_pipeline_cache(llgl_renderer, options.cacheDir);
+    }
+    if (options.shaderCache) {
+        init_shader_cache(options.cacheDir);
+    }
+
+    OffscreenTarget target;
+    if (!target.create(llgl_renderer, { options.width, options.height })) {
+        // Whatever create() got to before failing
+        target.release(llgl_renderer);
+        LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+        return 1;
+    }
+
+    StressRenderer stressRenderer;
+    if (!stressRenderer.init(llgl_renderer, target.getRenderPass())) {
+        stressRenderer.release(llgl_renderer);
+        target.release(llgl_renderer);
+        LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+        return 1;
+    }
+
+    OcclusionCuller culler;
+    if (options.stressCulling) {
+        culler.init();
+    }
+    std::vector<uint32_t> visibleObjects;
+
+    const float aspect = static_cast<float>(options.width) / static_cast<float>(options.height);
+    const uint32_t frameCount = options.frameCount > 0 ? options.frameCount : DEFAULT_STRESS_FRAMES;
+    auto cmdBuffer = llgl_renderer->CreateCommandBuffer(LLGL::CommandBufferFlags::ImmediateSubmit);
+    LLGL::CommandQueue* queue = llgl_renderer->GetCommandQueue();
+
+    log_info(LogCategory::App, "Stress: %zu scene sizes, %s layout, %s submission%s, %u frames (+%u warm-up) each\n",
+             options.stressCounts.size(), stress_layout_name(desc.layout), stress_submit_mode_name(mode),
+             options.stressCulling ? " with occlusion culling" : "", frameCount, options.warmupFrames);
+
+    std::vector<StressResult> results;
+    for (uint32_t objectCount : options.stressCounts) {
+        PROFILE_SCOPE("StressScene");
+        StressResult result;
+        result.objectCount = objectCount;
+        desc.objectCount = objectCount;
+
+        StressScene scene;
+        const auto generateStart = Clock::now();
+        scene.generate(desc);
+        const auto uploadStart = Clock::now();
+        scene.createBuffers(llgl_renderer);
+        const auto uploadEnd = Clock::now();
+        result.generateMs = millisecondsBetween(generateStart, uploadStart);
+        result.uploadMs = millisecondsBetween(uploadStart, uploadEnd);
+        result.cpuBytesPerObject = static_cast<double>(scene.getCpuMemoryBytes()) / objectCount;
+        result.gpuBytesPerObject = static_cast<double>(scene.getGpuMemoryBytes()) / objectCount;
+
+        OrbitCamera camera;
+        frame_stress_scene(camera, scene);
+        stressRenderer.updateCamera(llgl_renderer, camera, aspect, scene);
+
+        std::vector<double> cullMs, recordMs, waitMs, frameMs;
+        cullMs.reserve(frameCount);
+        recordMs.reserve(frameCount);
+        waitMs.reserve(frameCount);
+        frameMs.reserve(frameCount);
+
+        for (uint32_t i = 0; i < options.warmupFrames + frameCount; i++) {
+            PROFILE_FRAME_MARK();
+            PROFILE_SCOPE("Frame");
+            const auto frameStart = Clock::now();
+            if (options.stressCulling) {
+                result.cullStats = culler.cull(scene, stressRenderer.getViewProjection(), camera.getPosition(),
+                                               visibleObjects);
+            }
+            const auto cullEnd = Clock::now();
+
+            cmdBuffer->Begin();
+            {
+                cmdBuffer->SetViewport(target.getResolution());
+                cmdBuffer->BeginRenderPass(*target.getRenderTarget());
+                {
+                    cmdBuffer->Clear(LLGL::ClearFlags::ColorDepth, LLGL::ClearValue{ 0.1f, 0.1f, 0.15f, 1.0f });
+                    result.stats = stressRenderer.render(*cmdBuffer, scene, mode,
+                                                         options.stressCulling ? &visibleObjects : nullptr);
+                }
+                cmdBuffer->EndRenderPass();
+            }
+            cmdBuffer->End();
+            const auto recordEnd = Clock::now();
+
+            queue->WaitIdle();
+            const auto frameEnd = Clock::now();
+
+            if (i >= options.warmupFrames) {
+                cullMs.push_back(millisecondsBetween(frameStart, cullEnd));
+                recordMs.push_back(millisecondsBetween(cullEnd, recordEnd));
+                waitMs.push_back(millisecondsBetween(recordEnd, frameEnd));
+                frameMs.push_back(millisecondsBetween(frameStart, frameEnd));
+            }
+        }
+
+        result.cullMs = summarize_samples(cullMs);
+        result.recordMs = summarize_samples(recordMs);
+        result.waitMs = summarize_samples(waitMs);
+        result.frameMs = summarize_samples(frameMs);
+        result.nsPerDraw = result.recordMs.p50 * 1.0e6 / std::max(result.stats.drawCalls, 1u);
+        results.push_back(result);
+
+        scene.release(llgl_renderer);
+    }
+
+    // Table
+    log_info(LogCategory::App, "%10s %10s %10s %10s %10s %10s %10s %10s %10s\n", "objects", "draws", "gen ms",
+             "upload ms", "B/object", "cull ms", "record ms", "ns/draw", "frame ms");
+    for (const StressResult& result : results) {
+        log_info(LogCategory::App, "%10u %10u %10.2f %10.2f %10.0f %10.3f %10.3f %10.1f %10.3f\n", result.objectCount,
+                 result.stats.drawCalls, result.generateMs, result.uploadMs,
+                 result.cpuBytesPerObject + result.gpuBytesPerObject, result.cullMs.p50, result.recordMs.p50,
+                 result.nsPerDraw, result.frameMs.p50);
+    }
+
+    // Report
+    const auto& info = llgl_renderer->GetRendererInfo();
+    JsonWriter json;
+    json.beginObject();
+    json.field("renderer", info.rendererName);
+    json.field("device", info.deviceName);
+    json.field("layout", stress_layout_name(desc.layout));
+    json.field("submitMode", stress_submit_mode_name(mode));
+    json.field("meshVariety", desc.meshVariety);
+    json.field("materialCount", desc.materialCount);
+    json.field("seed", desc.seed);
+    json.field("width", options.width);
+    json.field("height", options.height);
+    json.field("frames", frameCount);
+    json.field("warmupFrames", options.warmupFrames);
+    json.field("occlusionCulling", options.stressCulling);
+
+    json.key("scenes").beginArray();
+    for (const StressResult& result : results) {
+        json.beginObject();
+        json.field("objects", result.objectCount);
+        json.field("drawCalls", result.stats.drawCalls);
+        json.field("triangles", result.stats.triangles);
+        json.field("resourceBinds", result.stats.resourceBinds);
+        json.field("generateMs", result.generateMs);
+        json.field("uploadMs", result.uploadMs);
+        json.field("cpuBytesPerObject", result.cpuBytesPerObject);
+        json.field("gpuBytesPerObject", result.gpuBytesPerObject);
+        json.field("nsPerDraw", result.nsPerDraw);
+        if (options.stressCulling) {
+            const CullStats& cull = result.cullStats;
+            json.key("culling").beginObject();
+            json.field("occluders", cull.occluders);
+            json.field("occluderTriangles", cull.occluderTriangles);
+            json.field("frustumCulled", cull.frustumCulled);
+            json.field("occluded", cull.occluded);
+            json.field("visible", cull.visible());
+            json.field("selectMs", cull.selectMs);
+            json.field("rasterMs", cull.rasterMs);
+            json.field("testMs", cull.testMs);
+            json.endObject();
+            write_summary(json, "cullMs", result.cullMs);
+        }
+        write_summary(json, "recordMs", result.recordMs);
+        write_summary(json, "waitMs", result.waitMs);
+        write_summary(json, "frameMs", result.frameMs);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+
+    const std::string reportPath = options.reportPath.empty() ? "stress.json" : options.reportPath;
+    int exitCode = 0;
+    if (json.writeToFile(reportPath)) {
+        log_info(LogCategory::App, "Wrote %s\n", reportPath.c_str());
+    } else {
+        log_error(LogCategory::App, "Failed to write stress report: %s\n", reportPath.c_str());
+        exitCode = 1;
+    }
+
+    // Cleanup
+    llgl_renderer->Release(*cmdBuffer);
+    stressRenderer.release(llgl_renderer);
+    target.release(llgl_renderer);
+    log_shader_cache_stats();
+    save_pipeline_cache(llgl_renderer);
+    LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+
+    return exitCode;
+}
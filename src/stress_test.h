@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+#include "app_options.h"
+#include "camera.h"
+#include "stress_renderer.h"
+#include "stress_scene.h"
+
+// Fills the scene description and submit mode from the --stress-* options; logs and returns false on bad names
+bool stress_options_to_desc(const AppOptions& options, uint32_t objectCount, StressSceneDesc& desc,
+                            StressSubmitMode& mode);
+
+// Points the camera at the scene center from slightly outside its bounding sphere
+void frame_stress_scene(OrbitCamera& camera, const StressScene& scene);
+
+// Generates a stress scene for every count in options.stressCounts, renders it offscreen and writes
+// load time, memory per object and per-draw CPU cost to options.reportPath (default stress.json)
+int run_stress(const AppOptions& options);
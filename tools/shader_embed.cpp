@@ -0,0 +1,208 @@
+// Build-time shader translation for TEST_LLGL_EMBED_SHADERS.
+// Translates every permutation of the shader/ pairs and the ImGui backend shaders for all embedded targets and
+// writes them, with the shader/ sources, as constexpr arrays behind the lookup API of src/embedded_shaders.h.
+//
+// Usage: Test-LLGL-ShaderEmbed <shader dir> <output.cpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <LLGL/LLGL.h>
+#include <LLGL/Utils/VertexFormat.h>
+
+#include "imgui_impl_llgl.h"
+#include "model_loader.h"
+#include "shader_translation.h"
+#include "shader_variants.h"
+#include "stress_scene.h"
+
+// Used by shader_translation.cpp
+LLGL::RenderSystemPtr llgl_renderer;
+
+namespace {
+
+// The shipped backends plus the other versions renderers commonly report as their highest one, since the
+// translation is keyed by the version the renderer picks
+std::vector<ShaderTargetDesc> embeddedTargets() {
+    std::vector<ShaderTargetDesc> targets = shipped_shader_targets();
+    targets.push_back({ "glsl330", { LLGL::ShadingLanguage::GLSL, LLGL::ShadingLanguage::GLSL_330 } });
+    targets.push_back({ "glsl410", { LLGL::ShadingLanguage::GLSL, LLGL::ShadingLanguage::GLSL_410 } });
+    targets.push_back({ "glsl460", { LLGL::ShadingLanguage::GLSL, LLGL::ShadingLanguage::GLSL_460 } });
+    targets.push_back({ "essl310", { LLGL::ShadingLanguage::ESSL, LLGL::ShadingLanguage::ESSL_310 } });
+    targets.push_back({ "essl320", { LLGL::ShadingLanguage::ESSL, LLGL::ShadingLanguage::ESSL_320 } });
+    targets.push_back({ "hlsl51", { LLGL::ShadingLanguage::HLSL, LLGL::ShadingLanguage::HLSL_5_1 } });
+    return targets;
+}
+
+// Only HLSL keys depend on the vertex format (attribute semantics), the other targets collapse into one
+// entry. These are the formats the renderers request: model, depth pre-pass and instanced stress meshes.
+std::vector<LLGL::VertexFormat> shaderVertexFormats() {
+    LLGL::VertexFormat stressFormat = createModelVertexFormat();
+    for (const auto& attribute : StressScene::createInstanceFormat().attributes) {
+        stressFormat.attributes.push_back(attribute);
+    }
+    return { createModelVertexFormat(), createPositionVertexFormat(), stressFormat };
+}
+
+// An array in the generated file
+struct ByteArray {
+    std::string name;
+    size_t size;
+};
+
+struct Blob {
+    uint64_t key;
+    uint32_t target;
+    bool spirv;
+    ByteArray vert;
+    ByteArray frag;
+};
+
+class EmbedWriter {
+  public:
+    ByteArray bytes(const void* data, size_t size) {
+        const std::string name = "DATA_" + std::to_string(arrayCount_++);
+        arrays_ << "constexpr unsigned char " << name << "[] = {";
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        char hex[8];
+        for (size_t i = 0; i < size; i++) {
+            std::snprintf(hex, sizeof(hex), "0x%02x,", bytes[i]);
+            arrays_ << (i % 16 == 0 ? "\n    " : " ") << hex;
+        }
+        // Zero-sized arrays aren't allowed; the size is stored next to the pointer anyway
+        arrays_ << (size == 0 ? " 0 };\n" : "\n};\n");
+        return { name, size };
+    }
+
+    ByteArray code(const ShaderCode& code) {
+        if (const auto* words = std::get_if<std::vector<uint32_t>>(&code)) {
+            return bytes(words->data(), words->size() * sizeof(uint32_t));
+        }
+        const std::string& text = std::get<std::string>(code);
+        return bytes(text.data(), text.size());
+    }
+
+    void source(const std::string& name, const std::string& vert, const std::string& frag) {
+        const ByteArray vertArray = bytes(vert.data(), vert.size());
+        const ByteArray fragArray = bytes(frag.data(), frag.size());
+        sources_ << "    { \"" << name << "\", " << vertArray.name << ", " << vertArray.size << ", " << fragArray.name
+                 << ", " << fragArray.size << " },\n";
+    }
+
+    std::string finish(std::vector<Blob> blobs) {
+        std::sort(blobs.begin(), blobs.end(),
+                  [](const Blob& a, const Blob& b) { return std::tie(a.key, a.target) < std::tie(b.key, b.target); });
+
+        std::ostringstream out;
+        out << "// Generated by Test-LLGL-ShaderEmbed from shader/ and the ImGui backend shaders. Do not edit.\n\n"
+            << "#include \"embedded_shaders.h\"\n\nnamespace {\n\n"
+            << arrays_.str() << "\nconstexpr EmbeddedShaderSource SOURCES[] = {\n"
+            << sources_.str() << "};\n\n// Sorted by key for the binary search in read_embedded_shaders\n"
+            << "constexpr EmbeddedShaderBlob BLOBS[] = {\n";
+        char key[24];
+        for (const auto& blob : blobs) {
+            std::snprintf(key, sizeof(key), "0x%016llxull", static_cast<unsigned long long>(blob.key));
+            out << "    { " << key << ", " << blob.target << ", " << (blob.spirv ? "true" : "false") << ", "
+                << blob.vert.name << ", " << blob.vert.size << ", " << blob.frag.name << ", " << blob.frag.size
+                << " },\n";
+        }
+        out << "};\n\n} // anonymous namespace\n\n"
+            << "std::span<const EmbeddedShaderSource> embedded_shader_sources() {\n    return SOURCES;\n}\n\n"
+            << "std::span<const EmbeddedShaderBlob> embedded_shader_blobs() {\n    return BLOBS;\n}\n";
+        return out.str();
+    }
+
+  private:
+    std::ostringstream arrays_;
+    std::ostringstream sources_;
+    size_t arrayCount_ = 0;
+};
+
+// Translates one pair for every target and format; reports every failed translation and returns false if
+// there was any
+bool embedPair(EmbedWriter& writer, std::vector<Blob>& blobs, const std::string& name,
+               const std::vector<LLGL::VertexFormat>& formats, const std::string& vert, const std::string& frag) {
+    const std::vector<ShaderTargetDesc> targets = embeddedTargets();
+    bool success = true;
+    for (const auto& format : formats) {
+        const ShaderTranslationReport report = translate_shader_targets(targets, format, vert, frag);
+        for (const auto& result : report.results) {
+            if (!result.error.empty()) {
+                std::fprintf(stderr, "%s (%s): %s\n", name.c_str(), result.name.c_str(), result.error.c_str());
+                success = false;
+                continue;
+            }
+            const bool known = std::any_of(blobs.begin(), blobs.end(), [&](const Blob& blob) {
+                return blob.key == result.key && blob.target == result.target;
+            });
+            if (!known) {
+                const bool spirv = std::holds_alternative<std::vector<uint32_t>>(result.vertShader);
+                const ByteArray vertArray = writer.code(result.vertShader);
+                blobs.push_back({ result.key, result.target, spirv, vertArray, writer.code(result.fragShader) });
+            }
+        }
+        std::printf("%-20s %zu attributes: %.2f ms\n", name.c_str(), format.attributes.size(), report.totalMs);
+    }
+    return success;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s <shader dir> <output.cpp>\n", argv[0]);
+        return 1;
+    }
+
+    // The translator only needs the rendering caps (resource limits), so the Null device is enough
+    llgl_renderer = LLGL::RenderSystem::Load("Null");
+    if (!llgl_renderer) {
+        std::fprintf(stderr, "Failed to load the Null renderer\n");
+        return 1;
+    }
+    set_shader_directory(argv[1]);
+
+    EmbedWriter writer;
+    std::vector<Blob> blobs;
+    bool success = true;
+    const std::vector<LLGL::VertexFormat> formats = shaderVertexFormats();
+    for (const auto& name : list_shader_names()) {
+        std::string vert, frag;
+        load_shader_sources(name, vert, frag);
+        writer.source(name, vert, frag);
+        for (const auto& defines : shader_permutations(name)) {
+            // Every pair is translated even after a failure, so that one run reports all errors
+            success = embedPair(writer, blobs, shader_variant_name(name, defines), formats,
+                                apply_shader_defines(vert, defines), apply_shader_defines(frag, defines)) &&
+                      success;
+        }
+    }
+
+    // The ImGui sources are compiled into the backend already, only their translations are needed
+    const char* imguiVert = nullptr;
+    const char* imguiFrag = nullptr;
+    ImGui_ImplLLGL_GetShaderSources(&imguiVert, &imguiFrag);
+    success = embedPair(writer, blobs, "imgui", { ImGui_ImplLLGL_GetVertexFormat() }, imguiVert, imguiFrag) && success;
+
+    const size_t blobCount = blobs.size();
+    const std::string generated = success ? writer.finish(std::move(blobs)) : std::string();
+    LLGL::RenderSystem::Unload(std::move(llgl_renderer));
+    if (!success) {
+        return 1;
+    }
+
+    // Always written: the build copies it over the compiled file only if it changed (copy_if_different)
+    std::ofstream file(argv[2], std::ios::binary | std::ios::trunc);
+    file << generated;
+    if (!file) {
+        std::fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return 1;
+    }
+    std::printf("Embedded %zu translations in %s\n", blobCount, argv[2]);
+    return 0;
+}